@@ -3,6 +3,7 @@
 #include <gloo/transform.h>
 #include <gloo/mouse_event.h>
 #include <gloo/group.h>
+#include <gloo/tangent_space.h>
 
 #include <cstdio>
 #include <iostream>
@@ -23,10 +24,7 @@ GLfloat squareUV[] = { 0.0f, 0.0f,
                        0.0f, 1.0f,
                        1.0f, 1.0f };
 
-GLfloat squareTangents[] = { -1.0f, 0.0f, 0.0f,
-                             -1.0f, 0.0f, 0.0f,
-                             1.0f, 0.0f, 0.0f,
-                             1.0f, 0.0f, 0.0f };
+GLuint squareStrip[] = {0, 1, 2, 3};
 
 GLfloat squareNormals[] = {0.0f, 1.0f, 0.0f, 
                            0.0f, 1.0f, 0.0f,
@@ -44,7 +42,6 @@ MyModel::MyModel()
 MyModel::~MyModel()
 {
   delete mCamera;
-  delete mMeshGroup;
 
   delete mDebugRenderer;
   delete mPhongRenderer;
@@ -54,9 +51,7 @@ MyModel::~MyModel()
   delete mPolygon;
   delete mBoundingBox;
   delete mWireframeSphere;
-  delete mTexture;
   delete mDome;
-  delete mNormalMap;
 
   delete mLightSource;
 }
@@ -109,21 +104,27 @@ bool MyModel::Init()
   mDome = new TexturedSphere(posAttribLocPhong, normalAttribLocPhong, textureAttribLocPhong, tangentAttribLocPhong,
                              {glm::vec3(0, 0, 0), glm::vec3(0), glm::vec3(0.07, 0.07, 0.07)});
 
-  mMeshGroup = new MeshGroup<Batch>(4, 4);
-  mMeshGroup->SetVertexAttribList({3, 3, 2, 3});
-  mMeshGroup->AddRenderingPass({{posAttribLoc, true}, {colAttribLoc, true}, gloo::kNoAttrib, gloo::kNoAttrib});
-  mMeshGroup->AddRenderingPass({{posAttribLocPhong, true}, 
-                                {normalAttribLocPhong, true}, 
-                                {textureAttribLocPhong, true},
-                                {tangentAttribLocPhong, true}});
+  mMeshGroup = mMeshes.Create(4, 4);
+  MeshGroup<Batch>* square = mMeshes.Get(mMeshGroup);
+  square->SetVertexAttribList({3, 3, 2, 3});
+  square->AddRenderingPass({{posAttribLoc, true}, {colAttribLoc, true}, gloo::kNoAttrib, gloo::kNoAttrib});
+  square->AddRenderingPass({{posAttribLocPhong, true}, 
+                            {normalAttribLocPhong, true}, 
+                            {textureAttribLocPhong, true},
+                            {tangentAttribLocPhong, true}});
 
-  mMeshGroup->Load({squareVertices, squareNormals, squareUV, squareTangents}, nullptr);
+  // Tangents follow the uvs (for the normal map).
+  GLfloat squareTangents[4 * 3];
+  ComputeTangents(squareVertices, squareNormals, squareUV, 4, squareStrip, 4, GL_TRIANGLE_STRIP,
+                  squareTangents);
 
-  mTexture = new Texture2d();
-  mTexture->Load("textures/154.jpg");
+  square->Load({squareVertices, squareNormals, squareUV, squareTangents}, nullptr);
 
-  mNormalMap = new Texture2d();
-  mNormalMap->Load("textures/154_norm.jpg");
+  mTexture = mTextures.Create();
+  mTextures.Get(mTexture)->Load("textures/154.jpg");
+
+  mNormalMap = mTextures.Create();
+  mTextures.Get(mNormalMap)->Load("textures/154_norm.jpg");
 
   mPhongRenderer->SetTextureUnit("color_map",  0);
   mPhongRenderer->SetTextureUnit("normal_map", 1);
@@ -173,11 +174,11 @@ void MyModel::Display()
                                 glm::vec3(.9, .9, .9),
                                 glm::vec3(.05, .05, .05)});
 
-  mTexture->Bind(GL_TEXTURE0);
-  mNormalMap->Bind(GL_TEXTURE1);
+  mTextures.Get(mTexture)->Bind(GL_TEXTURE0);
+  mTextures.Get(mNormalMap)->Bind(GL_TEXTURE1);
   M.LoadIdentity();
   // M.Rotate(-0.79*cos(blah_angle), 1, 0, 1);
-  mPhongRenderer->Render(mMeshGroup, M, 1);
+  mPhongRenderer->Render(mMeshes.Get(mMeshGroup), M, mCamera, 1);
   M.LoadIdentity();
 
   M.Scale(0.7f, 0.7f, 0.7f);
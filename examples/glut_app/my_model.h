@@ -37,9 +37,14 @@ private:
   int mRendererNum { 0 };
 
   Camera* mCamera { nullptr };
-  MeshGroup<Batch>* mMeshGroup { nullptr };
-  Texture2d* mTexture   { nullptr };
-  Texture2d* mNormalMap { nullptr };
+
+  // GL resources owned by the model (released with the pools).
+  ResourcePool<MeshGroup<Batch>> mMeshes;
+  ResourcePool<Texture2d> mTextures;
+
+  MeshHandle<Batch> mMeshGroup;
+  TextureHandle mTexture;
+  TextureHandle mNormalMap;
 
   Polygon* mPolygon;
   AxisMesh* mAxis;
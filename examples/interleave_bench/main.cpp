@@ -0,0 +1,139 @@
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <functional>
+
+#include <gloo/interleave.h>
+#include <gloo/vertex_format.h>
+
+using namespace gloo;
+
+// Measures how fast float attribute arrays are interleaved into a vertex buffer (and split
+// back), for the {3, 3, 2} and {3, 3, 2, 3} layouts:
+//   -> push_back: the original MeshGroup<Interleave>::Load() loop.
+//   -> PackAttrib: one strided pass per attribute (vertex_format.h).
+//   -> InterleaveFloats: SIMD kernels, split across threads (interleave.h).
+//
+// Usage: interleave_bench [numVertices]
+
+namespace
+{
+  const int kNumRuns = 5;
+
+  // Best time of kNumRuns runs, in milliseconds.
+  double Measure(const std::function<void()> & run)
+  {
+    double best = 0.0;
+    for (int r = 0; r < kNumRuns; r++)
+    {
+      const auto start = std::chrono::steady_clock::now();
+      run();
+      const std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+      best = (r == 0) ? elapsed.count() : std::min(best, elapsed.count());
+    }
+
+    return best;
+  }
+
+  void Report(const char* name, double ms, GLuint numBytes)
+  {
+    std::cout << "  " << std::left << std::setw(20) << name << std::right << std::fixed
+              << std::setprecision(2) << std::setw(9) << ms << " ms" << std::setw(9)
+              << numBytes / (ms * 1.0e6) << " GB/s" << std::endl;
+  }
+
+  const char* GetKernelName(InterleaveKernel kernel)
+  {
+    switch (kernel)
+    {
+      case kInterleaveAvx2:   return "AVX2";
+      case kInterleaveSse2:   return "SSE2";
+      case kInterleaveScalar: return "scalar";
+      default:                return "generic";
+    }
+  }
+
+  void RunLayout(const std::vector<GLuint> & sizes, GLuint numVertices)
+  {
+    const GLuint numAttribs = sizes.size();
+
+    GLuint vertexSize = 0;
+    std::vector<std::vector<GLfloat>> attribs(numAttribs);
+    for (GLuint j = 0; j < numAttribs; j++)
+    {
+      attribs[j].resize(sizes[j] * numVertices);
+      for (GLfloat & value : attribs[j])
+        value = std::rand() / static_cast<GLfloat>(RAND_MAX);
+
+      vertexSize += sizes[j];
+    }
+
+    std::vector<const GLfloat*> srcList;
+    std::vector<GLfloat*> dstList;
+    for (std::vector<GLfloat> & attrib : attribs)
+    {
+      srcList.push_back(attrib.data());
+      dstList.push_back(attrib.data());
+    }
+
+    const GLuint numBytes = vertexSize * numVertices * sizeof(GLfloat);
+    std::vector<GLfloat> vertices(vertexSize * numVertices);
+
+    std::cout << "{";
+    for (GLuint j = 0; j < numAttribs; j++)
+      std::cout << sizes[j] << (j + 1 < numAttribs ? ", " : "");
+    std::cout << "} layout, " << numVertices << " vertices ("
+              << GetKernelName(GetInterleaveKernel(sizes.data(), numAttribs)) << " kernel):"
+              << std::endl;
+
+    Report("push_back", Measure([&] {
+      std::vector<GLfloat> buffer;
+      for (GLuint i = 0; i < numVertices; i++)
+        for (GLuint j = 0; j < numAttribs; j++)
+          for (GLuint k = 0; k < sizes[j]; k++)
+            buffer.push_back(attribs[j][sizes[j]*i + k]);
+      vertices.swap(buffer);
+    }), numBytes);
+
+    Report("PackAttrib", Measure([&] {
+      GLubyte* dst = reinterpret_cast<GLubyte*>(vertices.data());
+      for (GLuint j = 0, offset = 0; j < numAttribs; j++)
+      {
+        PackAttrib(VertexAttrib(sizes[j]), srcList[j], sizes[j], numVertices,
+                   dst + offset * sizeof(GLfloat), vertexSize * sizeof(GLfloat));
+        offset += sizes[j];
+      }
+    }), numBytes);
+
+    const std::vector<GLfloat> expected = vertices;
+
+    Report("InterleaveFloats", Measure([&] {
+      InterleaveFloats(srcList.data(), sizes.data(), numAttribs, numVertices, vertices.data());
+    }), numBytes);
+
+    if (vertices != expected)
+      std::cerr << "  ERROR: InterleaveFloats() output differs." << std::endl;
+
+    Report("DeinterleaveFloats", Measure([&] {
+      DeinterleaveFloats(vertices.data(), sizes.data(), numAttribs, numVertices, dstList.data());
+    }), numBytes);
+
+    std::cout << std::endl;
+  }
+}  // namespace.
+
+int main(int argc, char* argv[])
+{
+  const GLuint numVertices = (argc > 1) ? std::atoi(argv[1]) : 4000000;
+
+  RunLayout({3, 3, 2}, numVertices);
+  RunLayout({3, 3, 2, 3}, numVertices);
+  RunLayout({4, 1}, numVertices);
+
+  return 0;
+}
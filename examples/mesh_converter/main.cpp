@@ -0,0 +1,181 @@
+#include <map>
+#include <tuple>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+#include <gloo/mesh_cache.h>
+
+using namespace gloo;
+
+// Converts a Wavefront .obj model into a mesh cache (see gloo/mesh_cache.h), so that it can be
+// loaded with MeshGroup::LoadFromCache() at startup with no parsing or optimization.
+//
+// Usage: mesh_converter input.obj output.gloomesh [lodError ...]
+//
+// Faces are triangulated as fans. Each distinct (position, texture coordinate, normal) triple
+// becomes one vertex. Vertices are stored as {position (float), normal (2_10_10_10), texture
+// coordinates (half float)}, without the attributes the model doesn't have.
+
+namespace
+{
+  typedef std::tuple<int, int, int> ObjVertex;  // Position, texture coordinate and normal.
+
+  // Resolves a 1-based (or negative, relative) .obj index. Returns -1 if it's missing.
+  int ResolveIndex(const std::string & token, int count)
+  {
+    if (token.empty())
+      return -1;
+
+    const int index = std::atoi(token.c_str());
+    return (index < 0) ? count + index : index - 1;
+  }
+
+  bool ParseFaceVertex(const std::string & token, int numPositions, int numUvs, int numNormals,
+                       ObjVertex & vertex)
+  {
+    std::string fields[3];
+    std::istringstream stream(token);
+    for (int k = 0; k < 3 && std::getline(stream, fields[k], '/'); k++) { }
+
+    vertex = ObjVertex(ResolveIndex(fields[0], numPositions), ResolveIndex(fields[1], numUvs),
+                       ResolveIndex(fields[2], numNormals));
+
+    return std::get<0>(vertex) >= 0 && std::get<0>(vertex) < numPositions
+        && std::get<1>(vertex) < numUvs && std::get<2>(vertex) < numNormals;
+  }
+}  // namespace.
+
+int main(int argc, char* argv[])
+{
+  if (argc < 3)
+  {
+    std::cerr << "Usage: " << argv[0] << " input.obj output.gloomesh [lodError ...]" << std::endl;
+    return 1;
+  }
+
+  std::ifstream input(argv[1]);
+  if (!input)
+  {
+    std::cerr << "Could not open " << argv[1] << "." << std::endl;
+    return 1;
+  }
+
+  std::vector<GLfloat> positions, uvs, normals;
+  std::vector<ObjVertex> corners;
+  std::string line;
+
+  while (std::getline(input, line))
+  {
+    std::istringstream stream(line);
+    std::string type;
+    stream >> type;
+
+    GLfloat x = 0.0f, y = 0.0f, z = 0.0f;
+    if (type == "v" && stream >> x >> y >> z)
+    {
+      positions.insert(positions.end(), {x, y, z});
+    }
+    else if (type == "vt" && stream >> x >> y)
+    {
+      uvs.insert(uvs.end(), {x, y});
+    }
+    else if (type == "vn" && stream >> x >> y >> z)
+    {
+      normals.insert(normals.end(), {x, y, z});
+    }
+    else if (type == "f")
+    {
+      std::vector<ObjVertex> face;
+      std::string token;
+      while (stream >> token)
+      {
+        ObjVertex vertex;
+        if (!ParseFaceVertex(token, positions.size()/3, uvs.size()/2, normals.size()/3, vertex))
+        {
+          std::cerr << "Invalid face: " << line << std::endl;
+          return 1;
+        }
+
+        face.push_back(vertex);
+      }
+
+      for (GLuint i = 2; i < face.size(); i++)
+        corners.insert(corners.end(), {face[0], face[i-1], face[i]});
+    }
+  }
+
+  if (corners.empty())
+  {
+    std::cerr << "No faces found in " << argv[1] << "." << std::endl;
+    return 1;
+  }
+
+  // Attributes present in every corner.
+  bool hasUvs = !uvs.empty();
+  bool hasNormals = !normals.empty();
+  for (const ObjVertex & corner : corners)
+  {
+    hasUvs = hasUvs && std::get<1>(corner) >= 0;
+    hasNormals = hasNormals && std::get<2>(corner) >= 0;
+  }
+
+  std::vector<VertexAttrib> attribList = {{3}};
+  if (hasNormals)
+    attribList.emplace_back(3, kSnorm2_10_10_10);
+  if (hasUvs)
+    attribList.emplace_back(2, kHalfFloat16);
+
+  // Build interleaved vertices, one per distinct corner.
+  std::map<ObjVertex, GLuint> vertexIndices;
+  std::vector<GLfloat> vertices;
+  std::vector<GLuint> indices;
+  indices.reserve(corners.size());
+
+  for (const ObjVertex & corner : corners)
+  {
+    const ObjVertex key(std::get<0>(corner), hasUvs ? std::get<1>(corner) : -1,
+                        hasNormals ? std::get<2>(corner) : -1);
+
+    auto it = vertexIndices.find(key);
+    if (it == vertexIndices.end())
+    {
+      it = vertexIndices.insert({key, vertexIndices.size()}).first;
+
+      const GLfloat* position = &positions[3 * std::get<0>(key)];
+      vertices.insert(vertices.end(), position, position + 3);
+
+      if (hasNormals)
+      {
+        const GLfloat* normal = &normals[3 * std::get<2>(key)];
+        vertices.insert(vertices.end(), normal, normal + 3);
+      }
+
+      if (hasUvs)
+      {
+        const GLfloat* uv = &uvs[2 * std::get<1>(key)];
+        vertices.insert(vertices.end(), uv, uv + 2);
+      }
+    }
+
+    indices.push_back(it->second);
+  }
+
+  MeshCacheOptions options;
+  for (int i = 3; i < argc; i++)
+    options.mLodTargetErrors.push_back(std::atof(argv[i]));
+
+  if (!BuildMeshCache(argv[2], attribList, vertices.data(), vertexIndices.size(), indices.data(),
+                      indices.size(), GL_TRIANGLES, options))
+  {
+    return 1;
+  }
+
+  std::cout << argv[2] << ": " << vertexIndices.size() << " vertices, " << indices.size()/3
+            << " triangles." << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,13 @@
+#include <iostream>
+#include <gloo/glut_application.h>
+
+#include "overdraw_model.h"
+
+using namespace gloo;
+
+// Renders a dense, self-occluding mesh from several directions, before and after the
+// overdraw optimization, and prints the number of fragment shader invocations.
+int main(int argc, char* argv[]  )
+{
+  return GlutApplication::Run(argc, argv, new OverdrawModel(), "Overdraw benchmark");
+}
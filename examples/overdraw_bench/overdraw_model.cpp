@@ -0,0 +1,227 @@
+#include "overdraw_model.h"
+
+#include <gloo/transform.h>
+#include <gloo/mouse_event.h>
+#include <gloo/gl_capabilities.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+  const int kNumViews   = 8;    // Directions around the mesh.
+  const int kNumSpheres = 24;   // Overlapping spheres in the mesh.
+  const int kSlices     = 48;   // Sphere tessellation (longitude).
+  const int kStacks     = 24;   // Sphere tessellation (latitude).
+}
+
+OverdrawModel::OverdrawModel()
+{
+
+}
+
+OverdrawModel::~OverdrawModel()
+{
+  delete mCamera;
+  delete mPhongRenderer;
+  delete mCacheOptimized;
+  delete mOverdrawOptimized;
+}
+
+bool OverdrawModel::Init()
+{
+  glEnable(GL_DEPTH_TEST);
+  glDepthFunc(GL_LESS);
+  glClearColor(0.2f, 0.2f, 0.2f, 1.0f);
+
+  mPhongRenderer = new PhongRenderer();
+  if (!mPhongRenderer->Load())
+  {
+    std::cout << "Couldn't initialize 'OverdrawModel::PhongRenderer*' ..." << std::endl;
+    return false;
+  }
+
+  // Use every light slot: the fragment shader cost is what we want to save.
+  mPhongRenderer->SetNumLightSources(kMaxNumberLights);
+  for (int i = 0; i < kMaxNumberLights; i++)
+    mPhongRenderer->EnableLightSource(i);
+  mPhongRenderer->EnableLighting();
+
+  mCamera = new Camera();
+  mCamera->SetPosition(0, 0, 4.0f);
+
+  mCacheOptimized    = OverdrawModel::BuildMesh(false);
+  mOverdrawOptimized = OverdrawModel::BuildMesh(true);
+
+  // Count fragment shader invocations if pipeline statistics are available.
+  // Otherwise, count samples that passed the depth test (still includes overdraw).
+#if defined(GL_FRAGMENT_SHADER_INVOCATIONS_ARB)
+  if (IsGLVersionSupported(4, 6) || IsGLExtensionSupported("GL_ARB_pipeline_statistics_query"))
+  {
+    mQueryTarget = GL_FRAGMENT_SHADER_INVOCATIONS_ARB;
+  }
+#endif
+
+  return true;
+}
+
+MeshGroup<Batch>* OverdrawModel::BuildMesh(bool optimizeOverdraw) const
+{
+  std::vector<GLfloat> positions;
+  std::vector<GLfloat> normals;
+  std::vector<GLuint> indices;
+
+  // Deterministic pseudo-random sphere centers and radii inside [-1, 1]^3.
+  srand(42);
+  for (int s = 0; s < kNumSpheres; s++)
+  {
+    const float cx = 1.6f * (rand() / static_cast<float>(RAND_MAX)) - 0.8f;
+    const float cy = 1.6f * (rand() / static_cast<float>(RAND_MAX)) - 0.8f;
+    const float cz = 1.6f * (rand() / static_cast<float>(RAND_MAX)) - 0.8f;
+    const float r  = 0.2f + 0.3f * (rand() / static_cast<float>(RAND_MAX));
+
+    const GLuint base = positions.size() / 3;
+    for (int i = 0; i <= kStacks; i++)
+    {
+      const float theta = M_PI * i / kStacks;
+      for (int j = 0; j <= kSlices; j++)
+      {
+        const float phi = 2.0f * M_PI * j / kSlices;
+        const float n[3] = { std::sin(theta) * std::cos(phi), 
+                             std::cos(theta),
+                             std::sin(theta) * std::sin(phi) };
+
+        positions.push_back(cx + r * n[0]);
+        positions.push_back(cy + r * n[1]);
+        positions.push_back(cz + r * n[2]);
+        normals.insert(normals.end(), n, n + 3);
+      }
+    }
+
+    for (int i = 0; i < kStacks; i++)
+    {
+      for (int j = 0; j < kSlices; j++)
+      {
+        const GLuint a = base + i * (kSlices + 1) + j;
+        const GLuint b = a + kSlices + 1;
+        const GLuint quad[] = { a, b, a + 1,  a + 1, b, b + 1 };
+        indices.insert(indices.end(), quad, quad + 6);
+      }
+    }
+  }
+
+  MeshGroup<Batch>* mesh = new MeshGroup<Batch>(positions.size() / 3, indices.size(), GL_TRIANGLES);
+  mesh->SetVertexAttribList({3, 3});
+  mesh->AddRenderingPass({{mPhongRenderer->GetPositionAttribLoc(), true},
+                          {mPhongRenderer->GetNormalAttribLoc(), true}});
+
+  mesh->EnableVertexCacheOptimization();
+  if (optimizeOverdraw)
+    mesh->EnableOverdrawOptimization(0);
+
+  mesh->Load({positions.data(), normals.data()}, indices.data());
+
+  std::cout << (optimizeOverdraw ? "Overdraw optimized: " : "Cache optimized:    ")
+            << "ACMR " << mesh->GetCacheStatsBefore().mAcmr 
+            << " -> "  << mesh->GetCacheStatsAfter().mAcmr
+            << ", ATVR " << mesh->GetCacheStatsBefore().mAtvr 
+            << " -> "    << mesh->GetCacheStatsAfter().mAtvr << std::endl;
+
+  return mesh;
+}
+
+GLuint64 OverdrawModel::Measure(const MeshGroup<Batch>* mesh)
+{
+  GLuint query = 0;
+  glGenQueries(1, &query);
+
+  GLuint64 total = 0;
+  for (int view = 0; view < kNumViews; view++)
+  {
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    Transform M;
+    M.LoadIdentity();
+    M.Rotate(2.0f * M_PI * view / kNumViews, 0, 1, 0);
+    M.Rotate(0.3f * view, 1, 0, 0);
+
+    glBeginQuery(mQueryTarget, query);
+    mPhongRenderer->Render(mesh, M);
+    glEndQuery(mQueryTarget);
+
+    GLuint64 count = 0;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &count);
+    total += count;
+  }
+
+  glDeleteQueries(1, &query);
+  return total;
+}
+
+void OverdrawModel::Idle()
+{
+  glutPostRedisplay();
+}
+
+void OverdrawModel::Display()
+{
+  mCamera->SetOnRendering();
+
+  mPhongRenderer->Bind();
+  mPhongRenderer->SetCamera(mCamera);
+  mPhongRenderer->SetMaterial({ glm::vec3(0.1, 0.1, 0.1), 
+                                glm::vec3(0.7, 0.7, 0.7),
+                                glm::vec3(0.3, 0.3, 0.3)});
+
+  for (int i = 0; i < kMaxNumberLights; i++)
+  {
+    const float angle = 2.0f * M_PI * i / kMaxNumberLights;
+    LightSource light = { glm::vec3(3.0f * std::cos(angle), 2.0f, 3.0f * std::sin(angle)),  // Pos.
+                          glm::vec3(0, -1, 0),        // Dir.
+                          glm::vec3(0.3, 0.3, 0.3),   // Ld.
+                          glm::vec3(0.2, 0.2, 0.2),   // Ls.
+                          8.0f};                      // Alpha.
+
+    mPhongRenderer->SetLightSourceInCameraCoordinates(light, mCamera, i);
+  }
+
+  if (!mDone)
+  {
+    const GLuint64 before = OverdrawModel::Measure(mCacheOptimized);
+    const GLuint64 after  = OverdrawModel::Measure(mOverdrawOptimized);
+
+    std::cout << (mQueryTarget == GL_SAMPLES_PASSED ? "Samples passed" 
+                                                    : "Fragment shader invocations")
+              << " (" << kNumViews << " views): " << before << " -> " << after;
+    if (before > 0)
+      std::cout << " (" << 100.0 * (1.0 - static_cast<double>(after) / before) << "% less)";
+    std::cout << std::endl;
+
+    mDone = true;
+  }
+
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+  Transform M;
+  M.LoadIdentity();
+  mPhongRenderer->Render(mOverdrawOptimized, M);
+
+  glutSwapBuffers();
+}
+
+void OverdrawModel::Reshape(int w, int h)
+{
+  glViewport(0, 0, w, h);
+  mCamera->SetOnReshape(0, 0, w, h);
+}
+
+void OverdrawModel::KeyboardChange(unsigned char key, int x, int y)
+{
+  switch (key)
+  {
+    case 27: // ESC key
+      exit(0);
+    break;
+  }
+}
@@ -0,0 +1,47 @@
+#include <gloo/light.h>
+#include <gloo/group.h>
+#include <gloo/camera.h>
+#include <gloo/material.h>
+#include <gloo/model_base.h>
+#include <gloo/phong_renderer.h>
+
+using namespace gloo;
+
+class OverdrawModel : public ModelBase
+{
+public:
+  OverdrawModel();
+  virtual ~OverdrawModel();
+
+  virtual bool Init();
+
+  // -- Essential Callbacks --
+  virtual void Idle();
+  virtual void Display();
+  virtual void Reshape(int w, int h);
+
+  // -- Mouse Callbacks --
+  virtual void  ActiveMouseMotion(const MouseEvent & mouseEvent) { }
+  virtual void PassiveMouseMotion(const MouseEvent & mouseEvent) { }
+  virtual void  MouseButtonChange(const MouseEvent & mouseEvent) { }
+
+  // -- Keyboard Callbacks --
+  virtual void KeyboardChange(unsigned char key, int x, int y);
+  virtual void SpecialKeyboardChange(unsigned char key, int x, int y) { }
+
+private:
+  // Builds a cluster of overlapping spheres (indexed GL_TRIANGLES).
+  MeshGroup<Batch>* BuildMesh(bool optimizeOverdraw) const;
+
+  // Renders 'mesh' from kNumViews directions and returns the counted fragments.
+  GLuint64 Measure(const MeshGroup<Batch>* mesh);
+
+  Camera* mCamera { nullptr };
+  PhongRenderer* mPhongRenderer { nullptr };
+
+  MeshGroup<Batch>* mCacheOptimized    { nullptr };  // Vertex cache optimization only.
+  MeshGroup<Batch>* mOverdrawOptimized { nullptr };  // Vertex cache + overdraw optimization.
+
+  GLenum mQueryTarget { GL_SAMPLES_PASSED };
+  bool mDone { false };
+};
@@ -0,0 +1,33 @@
+#include "gl_capabilities.h"
+
+namespace gloo
+{
+
+bool IsGLVersionSupported(int major, int minor)
+{
+  GLint contextMajor = 0;
+  GLint contextMinor = 0;
+  glGetIntegerv(GL_MAJOR_VERSION, &contextMajor);
+  glGetIntegerv(GL_MINOR_VERSION, &contextMinor);
+
+  return (contextMajor > major) || (contextMajor == major && contextMinor >= minor);
+}
+
+bool IsGLExtensionSupported(const char* name)
+{
+  GLint numExtensions = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
+
+  for (GLint i = 0; i < numExtensions; i++)
+  {
+    const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+    if (extension && strcmp(extension, name) == 0)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+}  // namespace gloo.
@@ -0,0 +1,25 @@
+// + ======================================== +
+// |         gl-oo-interface library          |
+// |            Module: GLOO Core.            |
+// |        Author: Rodrigo Castiel, 2016.    |
+// + ======================================== +
+//
+// Runtime queries about the current OpenGL context. Some features (persistent buffer
+// mapping, multi-draw indirect, ...) are only available on newer contexts or through
+// extensions, so the classes that use them check here and fall back otherwise.
+// A context must be current when calling these functions.
+
+#pragma once
+
+#include "gloo/gl_header.h"
+
+namespace gloo
+{
+
+// Returns true if the current context version is at least major.minor.
+bool IsGLVersionSupported(int major, int minor);
+
+// Returns true if the current context exposes the extension 'name' (e.g. "GL_ARB_buffer_storage").
+bool IsGLExtensionSupported(const char* name);
+
+}  // namespace gloo.
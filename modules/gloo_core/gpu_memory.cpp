@@ -0,0 +1,163 @@
+#include "gpu_memory.h"
+
+#include <vector>
+#include <iomanip>
+#include <algorithm>
+
+#define LOG_OUTPUT_ON 1
+
+namespace gloo
+{
+
+std::map<GpuMemory::ResourceKey, GpuMemory::Resource> GpuMemory::sResources;
+size_t GpuMemory::sCategoryBytes[kNumGpuMemoryCategories] = { 0 };
+size_t GpuMemory::sCategoryPeakBytes[kNumGpuMemoryCategories] = { 0 };
+size_t GpuMemory::sTotalBytes = 0;
+size_t GpuMemory::sPeakBytes = 0;
+size_t GpuMemory::sBudget = 0;
+
+namespace
+{
+  // Bytes in MB, for reports.
+  double ToMegabytes(size_t bytes)
+  {
+    return bytes / (1024.0 * 1024.0);
+  }
+}  // namespace.
+
+void GpuMemory::Track(GpuObjectType type, GLuint handle, size_t bytes,
+                      GpuMemoryCategory category, const std::string & name)
+{
+  if (handle == 0)
+    return;
+
+  GpuMemory::Release(type, handle);
+
+  sResources[ResourceKey(type, handle)] = { bytes, category, name };
+  GpuMemory::AddBytes(category, bytes, name);
+}
+
+void GpuMemory::Release(GpuObjectType type, GLuint handle)
+{
+  auto it = sResources.find(ResourceKey(type, handle));
+  if (it == sResources.end())
+    return;
+
+  sCategoryBytes[it->second.mCategory] -= it->second.mBytes;
+  sTotalBytes -= it->second.mBytes;
+  sResources.erase(it);
+}
+
+void GpuMemory::Rename(GpuObjectType type, GLuint handle, const std::string & name)
+{
+  auto it = sResources.find(ResourceKey(type, handle));
+  if (it != sResources.end())
+    it->second.mName = name;
+}
+
+size_t GpuMemory::GetTotalBytes()
+{
+  return sTotalBytes;
+}
+
+size_t GpuMemory::GetTotalBytes(GpuMemoryCategory category)
+{
+  return sCategoryBytes[category];
+}
+
+size_t GpuMemory::GetPeakBytes()
+{
+  return sPeakBytes;
+}
+
+size_t GpuMemory::GetPeakBytes(GpuMemoryCategory category)
+{
+  return sCategoryPeakBytes[category];
+}
+
+void GpuMemory::ResetPeaks()
+{
+  sPeakBytes = sTotalBytes;
+  std::copy(sCategoryBytes, sCategoryBytes + kNumGpuMemoryCategories, sCategoryPeakBytes);
+}
+
+void GpuMemory::Report(std::ostream & out)
+{
+  // Restored before returning.
+  const std::ios_base::fmtflags flags = out.flags();
+  const std::streamsize precision = out.precision();
+
+  out << std::fixed << std::setprecision(2);
+  out << "------------------------- GPU memory -------------------------" << std::endl;
+  out << "Total: " << ToMegabytes(sTotalBytes) << " MB (peak " << ToMegabytes(sPeakBytes)
+      << " MB";
+  if (sBudget > 0)
+    out << ", budget " << ToMegabytes(sBudget) << " MB";
+  out << ") in " << sResources.size() << " resources." << std::endl;
+
+  for (int c = 0; c < kNumGpuMemoryCategories; c++)
+  {
+    out << "  " << std::left << std::setw(16) << GetCategoryName(static_cast<GpuMemoryCategory>(c))
+        << std::right << std::setw(10) << ToMegabytes(sCategoryBytes[c]) << " MB (peak "
+        << ToMegabytes(sCategoryPeakBytes[c]) << " MB)" << std::endl;
+  }
+
+  // Largest resources first.
+  std::vector<const Resource*> resources;
+  for (const auto & entry : sResources)
+    resources.push_back(&entry.second);
+
+  std::stable_sort(resources.begin(), resources.end(), [](const Resource* a, const Resource* b) {
+    return a->mBytes > b->mBytes;
+  });
+
+  out << "--------------------------------------------------------------" << std::endl;
+  for (const Resource* resource : resources)
+  {
+    out << std::setw(10) << ToMegabytes(resource->mBytes) << " MB  " << std::left << std::setw(16)
+        << GetCategoryName(resource->mCategory) << std::right << resource->mName << std::endl;
+  }
+  out << "--------------------------------------------------------------" << std::endl;
+
+  out.flags(flags);
+  out.precision(precision);
+}
+
+const char* GpuMemory::GetCategoryName(GpuMemoryCategory category)
+{
+  switch (category)
+  {
+    case kGpuVertexBuffer:   return "Vertex buffer";
+    case kGpuIndexBuffer:    return "Index buffer";
+    case kGpuInstanceBuffer: return "Instance buffer";
+    case kGpuArenaBuffer:    return "Arena buffer";
+    case kGpuDrawBuffer:     return "Draw buffer";
+    case kGpuUniformBuffer:  return "Uniform buffer";
+    case kGpuTextureBuffer:  return "Texture buffer";
+    case kGpuTexture:        return "Texture";
+    case kGpuRenderTarget:   return "Render target";
+    case kGpuShaderProgram:  return "Shader program";
+    default:                 return "Unknown";
+  }
+}
+
+void GpuMemory::AddBytes(GpuMemoryCategory category, size_t bytes, const std::string & name)
+{
+  const bool wasOverBudget = GpuMemory::IsOverBudget();
+
+  sCategoryBytes[category] += bytes;
+  sCategoryPeakBytes[category] = std::max(sCategoryPeakBytes[category], sCategoryBytes[category]);
+  sTotalBytes += bytes;
+  sPeakBytes = std::max(sPeakBytes, sTotalBytes);
+
+  if (!wasOverBudget && GpuMemory::IsOverBudget())
+  {
+#if LOG_OUTPUT_ON == 1
+    std::cerr << "WARNING GPU memory budget exceeded (" << ToMegabytes(sTotalBytes) << " of "
+              << ToMegabytes(sBudget) << " MB) by " << name << " ("
+              << GetCategoryName(category) << ")." << std::endl;
+#endif
+  }
+}
+
+}  // namespace gloo.
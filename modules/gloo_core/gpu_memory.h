@@ -0,0 +1,135 @@
+// + ======================================== +
+// |         gl-oo-interface library          |
+// |            Module: GLOO Core.            |
+// |        Author: Rodrigo Castiel, 2016.    |
+// + ======================================== +
+//
+// GpuMemory keeps track of the memory taken by the OpenGL objects of the library.
+//
+// OpenGL doesn't tell how much video memory a buffer or texture takes, so every object that
+// allocates storage reports its size here (MeshGroup, MeshArena, DrawBatch, BonePalette,
+// MorphTargetSet, Texture2d and ShaderProgram do). Each resource has a category and a debug name (see
+// MeshGroup::SetDebugName()), and the registry keeps the total and high-water mark (peak) of
+// each category. Sizes are the requested storage: drivers may pad or duplicate it.
+//
+// A budget can be set with SetBudget(): a warning is logged whenever an allocation takes the
+// total over it (allocations still succeed). Report() prints every resource, largest first.
+//
+// The registry is not synchronized: like any OpenGL call, use it from the GL thread.
+//
+// [USAGE]
+/*
+    GpuMemory::SetBudget(512 << 20);  // Warn above 512 MB.
+    ...
+    std::cout << GpuMemory::GetTotalBytes(kGpuTexture) << " bytes in textures." << std::endl;
+    GpuMemory::Report();
+*/
+
+#pragma once
+
+#include "gloo/gl_header.h"
+
+#include <map>
+#include <string>
+#include <utility>
+#include <cstddef>
+#include <iostream>
+
+namespace gloo
+{
+
+enum GpuMemoryCategory
+{
+  kGpuVertexBuffer,    // Mesh vertices (including streaming frames).
+  kGpuIndexBuffer,     // Element arrays.
+  kGpuInstanceBuffer,  // Per-instance attributes.
+  kGpuArenaBuffer,     // Vertices and indices shared by many meshes (MeshArena).
+  kGpuDrawBuffer,      // Indirect commands and shader storage (DrawBatch).
+  kGpuUniformBuffer,   // Uniform blocks (BonePalette).
+  kGpuTextureBuffer,   // Buffers read through buffer textures (MorphTargetSet).
+  kGpuTexture,         // Textures loaded from images.
+  kGpuRenderTarget,    // Textures allocated without data (to be rendered to).
+  kGpuShaderProgram,   // Linked program binaries.
+  kNumGpuMemoryCategories
+};
+
+// OpenGL object namespaces (the same handle can name a buffer and a texture).
+enum GpuObjectType
+{
+  kGpuBufferObject,
+  kGpuTextureObject,
+  kGpuProgramObject
+};
+
+class GpuMemory
+{
+public:
+  // Records that 'handle' now takes 'bytes' (its storage was (re)allocated).
+  static void Track(GpuObjectType type, GLuint handle, size_t bytes, GpuMemoryCategory category,
+                    const std::string & name);
+
+  // Removes 'handle' (its storage was deleted). Unknown handles are ignored.
+  static void Release(GpuObjectType type, GLuint handle);
+
+  // Shorthands for buffers.
+  static void TrackBuffer(GLuint buffer, size_t bytes, GpuMemoryCategory category,
+                          const std::string & name);
+  static void ReleaseBuffer(GLuint buffer);
+
+  // Changes the debug name of a tracked resource.
+  static void Rename(GpuObjectType type, GLuint handle, const std::string & name);
+
+  // Totals (current and high-water mark, in bytes).
+  static size_t GetTotalBytes();
+  static size_t GetTotalBytes(GpuMemoryCategory category);
+  static size_t GetPeakBytes();
+  static size_t GetPeakBytes(GpuMemoryCategory category);
+  static GLuint GetNumResources() { return sResources.size(); }
+
+  // Peaks restart from the current totals.
+  static void ResetPeaks();
+
+  // Logs a warning when the total goes over 'bytes' (0 = no budget).
+  static void SetBudget(size_t bytes) { sBudget = bytes; }
+  static size_t GetBudget() { return sBudget; }
+  static bool IsOverBudget() { return sBudget > 0 && sTotalBytes > sBudget; }
+
+  // Prints totals per category and every resource, sorted by size.
+  static void Report(std::ostream & out = std::cout);
+
+  static const char* GetCategoryName(GpuMemoryCategory category);
+
+private:
+  struct Resource
+  {
+    size_t mBytes;
+    GpuMemoryCategory mCategory;
+    std::string mName;
+  };
+
+  typedef std::pair<GpuObjectType, GLuint> ResourceKey;
+
+  static void AddBytes(GpuMemoryCategory category, size_t bytes, const std::string & name);
+
+  static std::map<ResourceKey, Resource> sResources;
+  static size_t sCategoryBytes[kNumGpuMemoryCategories];
+  static size_t sCategoryPeakBytes[kNumGpuMemoryCategories];
+  static size_t sTotalBytes;
+  static size_t sPeakBytes;
+  static size_t sBudget;
+};
+
+inline
+void GpuMemory::TrackBuffer(GLuint buffer, size_t bytes, GpuMemoryCategory category,
+                            const std::string & name)
+{
+  GpuMemory::Track(kGpuBufferObject, buffer, bytes, category, name);
+}
+
+inline
+void GpuMemory::ReleaseBuffer(GLuint buffer)
+{
+  GpuMemory::Release(kGpuBufferObject, buffer);
+}
+
+}  // namespace gloo.
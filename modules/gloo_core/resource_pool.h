@@ -0,0 +1,244 @@
+// + ======================================== +
+// |         gl-oo-interface library          |
+// |            Module: GLOO Core.            |
+// |        Author: Rodrigo Castiel, 2016.    |
+// + ======================================== +
+//
+// ResourcePool<T> owns objects of type T (MeshGroup, Texture2d, ShaderProgram, ...) in a single
+// contiguous array and hands out Handle<T>s to them.
+//
+// A handle is 32 bits: the index of a slot (20 bits) and the generation of that slot (12 bits).
+// Destroying an object bumps the generation of its slot, so handles to it become stale: Get()
+// returns nullptr for them instead of a dangling pointer (O(1) check). Objects are kept packed
+// (destroying one moves the last object into its place), so iterating over a pool touches only
+// live objects, in order. T must be movable; the library resources are move-only, since they
+// own OpenGL objects.
+//
+// Pointers returned by Get() (and iterators) are invalidated by Create() and Destroy(): store
+// handles, and look them up when needed. Objects that keep pointers to a group (MeshLoader, for
+// instance) must not see pooled groups move, so finish those before destroying other objects
+// of the pool, and Reserve() enough room up front.
+//
+// The generation wraps after 4095 reuses of a slot, after which a very old handle may alias a
+// new object. Handle 0 is never valid (null handle).
+//
+// [USAGE]
+/*
+    ResourcePool<Texture2d> textures;
+    TextureHandle diffuse = textures.Create();
+    textures.Get(diffuse)->Load("textures/154.jpg");
+    ...
+    textures.Get(diffuse)->Bind(GL_TEXTURE0);
+    textures.Destroy(diffuse);  // textures.Get(diffuse) == nullptr from now on.
+*/
+
+#pragma once
+
+#include "gloo/gl_header.h"
+
+#include <vector>
+#include <cassert>
+#include <utility>
+
+namespace gloo
+{
+
+const GLuint kHandleIndexBits = 20;
+const GLuint kHandleGenerationBits = 32 - kHandleIndexBits;
+const GLuint kMaxPoolSize = 1u << kHandleIndexBits;
+const GLuint kInvalidPoolIndex = ~0u;
+
+template <class T>
+class Handle
+{
+public:
+  Handle() { }
+  Handle(GLuint index, GLuint generation)
+  : mValue(index | (generation << kHandleIndexBits))
+  {
+    assert(index < kMaxPoolSize);
+    assert(generation > 0 && generation < (1u << kHandleGenerationBits));
+  }
+
+  // Raw 32-bit value (e.g. for draw lists) and back.
+  GLuint GetValue() const { return mValue; }
+  static Handle<T> FromValue(GLuint value)
+  {
+    Handle<T> handle;
+    handle.mValue = value;
+    return handle;
+  }
+
+  GLuint GetIndex() const { return mValue & (kMaxPoolSize - 1); }
+  GLuint GetGeneration() const { return mValue >> kHandleIndexBits; }
+  bool IsNull() const { return mValue == 0; }
+
+  bool operator==(const Handle<T> & other) const { return mValue == other.mValue; }
+  bool operator!=(const Handle<T> & other) const { return mValue != other.mValue; }
+  bool operator<(const Handle<T> & other)  const { return mValue < other.mValue; }
+
+private:
+  GLuint mValue { 0 };
+};
+
+template <class T>
+class ResourcePool
+{
+public:
+  typedef typename std::vector<T>::iterator Iterator;
+  typedef typename std::vector<T>::const_iterator ConstIterator;
+
+  // Constructs a new object (passing 'args' to its constructor) and returns its handle.
+  template <class... Args>
+  Handle<T> Create(Args&&... args);
+
+  // Destroys the object of 'handle'. Returns false if the handle is stale.
+  bool Destroy(Handle<T> handle);
+
+  // Returns the object of 'handle', or nullptr if the handle is stale (or null).
+  T* Get(Handle<T> handle);
+  const T* Get(Handle<T> handle) const;
+  bool IsValid(Handle<T> handle) const;
+
+  // Destroys every object (all handles become stale).
+  void Clear();
+
+  // Avoids reallocations (which move every object) up to 'size' objects.
+  void Reserve(GLuint size);
+
+  GLuint GetSize() const { return mObjects.size(); }
+  bool IsEmpty() const { return mObjects.empty(); }
+
+  // Live objects, packed. The handle of the i-th object is GetHandle(i).
+  Iterator begin() { return mObjects.begin(); }
+  Iterator end()   { return mObjects.end();   }
+  ConstIterator begin() const { return mObjects.begin(); }
+  ConstIterator end()   const { return mObjects.end();   }
+  Handle<T> GetHandle(GLuint i) const;
+
+private:
+  struct Slot
+  {
+    GLuint mDense;       // Index in mObjects (kInvalidPoolIndex if free).
+    GLuint mGeneration;  // Generation of the current (or next) object.
+  };
+
+  GLuint GetDenseIndex(Handle<T> handle) const;
+
+  std::vector<T> mObjects;
+  std::vector<GLuint> mObjectSlots;  // Slot of each object.
+  std::vector<Slot> mSlots;
+  std::vector<GLuint> mFreeSlots;
+};
+
+// ============================================================================================ //
+// Implementation of template functions.
+
+template <class T>
+template <class... Args>
+Handle<T> ResourcePool<T>::Create(Args&&... args)
+{
+  GLuint slot = 0;
+  if (!mFreeSlots.empty())
+  {
+    slot = mFreeSlots.back();
+    mFreeSlots.pop_back();
+  }
+  else
+  {
+    assert(mSlots.size() < kMaxPoolSize);
+    slot = mSlots.size();
+    mSlots.push_back({ kInvalidPoolIndex, 1 });
+  }
+
+  mSlots[slot].mDense = mObjects.size();
+  mObjects.emplace_back(std::forward<Args>(args)...);
+  mObjectSlots.push_back(slot);
+
+  return Handle<T>(slot, mSlots[slot].mGeneration);
+}
+
+template <class T>
+bool ResourcePool<T>::Destroy(Handle<T> handle)
+{
+  const GLuint dense = ResourcePool<T>::GetDenseIndex(handle);
+  if (dense == kInvalidPoolIndex)
+    return false;
+
+  // The last object takes the place of the destroyed one.
+  const GLuint last = mObjects.size() - 1;
+  if (dense != last)
+  {
+    mObjects[dense] = std::move(mObjects[last]);
+    mObjectSlots[dense] = mObjectSlots[last];
+    mSlots[mObjectSlots[dense]].mDense = dense;
+  }
+
+  mObjects.pop_back();
+  mObjectSlots.pop_back();
+
+  // Generation 0 is reserved for the null handle.
+  Slot & slot = mSlots[handle.GetIndex()];
+  slot.mDense = kInvalidPoolIndex;
+  slot.mGeneration = (slot.mGeneration + 1) % (1u << kHandleGenerationBits);
+  if (slot.mGeneration == 0)
+    slot.mGeneration = 1;
+
+  mFreeSlots.push_back(handle.GetIndex());
+  return true;
+}
+
+template <class T>
+T* ResourcePool<T>::Get(Handle<T> handle)
+{
+  const GLuint dense = ResourcePool<T>::GetDenseIndex(handle);
+  return (dense != kInvalidPoolIndex) ? &mObjects[dense] : nullptr;
+}
+
+template <class T>
+const T* ResourcePool<T>::Get(Handle<T> handle) const
+{
+  const GLuint dense = ResourcePool<T>::GetDenseIndex(handle);
+  return (dense != kInvalidPoolIndex) ? &mObjects[dense] : nullptr;
+}
+
+template <class T>
+bool ResourcePool<T>::IsValid(Handle<T> handle) const
+{
+  return ResourcePool<T>::GetDenseIndex(handle) != kInvalidPoolIndex;
+}
+
+template <class T>
+void ResourcePool<T>::Clear()
+{
+  while (!mObjects.empty())
+    ResourcePool<T>::Destroy(ResourcePool<T>::GetHandle(mObjects.size() - 1));
+}
+
+template <class T>
+void ResourcePool<T>::Reserve(GLuint size)
+{
+  mObjects.reserve(size);
+  mObjectSlots.reserve(size);
+}
+
+template <class T>
+Handle<T> ResourcePool<T>::GetHandle(GLuint i) const
+{
+  assert(i < mObjects.size());
+  const GLuint slot = mObjectSlots[i];
+  return Handle<T>(slot, mSlots[slot].mGeneration);
+}
+
+template <class T>
+GLuint ResourcePool<T>::GetDenseIndex(Handle<T> handle) const
+{
+  const GLuint index = handle.GetIndex();
+  if (handle.IsNull() || index >= mSlots.size())
+    return kInvalidPoolIndex;
+
+  const Slot & slot = mSlots[index];
+  return (slot.mGeneration == handle.GetGeneration()) ? slot.mDense : kInvalidPoolIndex;
+}
+
+}  // namespace gloo.
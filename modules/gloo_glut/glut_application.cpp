@@ -1,5 +1,7 @@
 #include "glut_application.h"
 
+#include "gloo/mesh_loader.h"
+
 #include <iostream>
 
 #define LOG_OUTPUT_ON 1
@@ -8,10 +10,24 @@ namespace gloo
 {
 
 GlutViewController* GlutApplication::sViewController = nullptr;
+MeshLoader* GlutApplication::sMeshLoader = nullptr;
+double GlutApplication::sUploadBudget = kDefaultUploadBudget;
+
+MeshLoader* GlutApplication::GetMeshLoader()
+{
+  if (sMeshLoader == nullptr)
+    sMeshLoader = new MeshLoader();
+
+  return sMeshLoader;
+}
 
 // ===================== Static functions for OpenGL callbacks ==========================  
 void GlutApplication::Idle()
 {
+  // Upload meshes built in the background (within the budget of this cycle).
+  if (sMeshLoader)
+    sMeshLoader->ProcessUploads(sUploadBudget);
+
   sViewController->Idle();
 }
 
@@ -139,6 +155,8 @@ int GlutApplication::Run(int argc, char* argv[], ModelBase* model,
   glutMainLoop();
 
   delete sViewController;
+  delete sMeshLoader;
+  sMeshLoader = nullptr;
 
   return 0;
 }
@@ -14,6 +14,11 @@
 // Run() returns similar int codes to main() in any application. 
 // See the glut_app example in the folder "../../examples/glut_app".
 //
+// Meshes can be built asynchronously with the MeshLoader returned
+// by GetMeshLoader(). Finished meshes are uploaded at the begin-
+// ning of each Idle() call, within a time budget (see SetUpload-
+// Budget()), so loading a heavy scene doesn't freeze the window.
+//
 
 #pragma once
 
@@ -25,6 +30,8 @@
 namespace gloo
 {
 
+class MeshLoader;  // gloo::MeshLoader
+
 const unsigned int _kDefaultDisplayMode = (GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH | GLUT_STENCIL | GLUT_MULTISAMPLE);
 
 class GlutApplication
@@ -41,8 +48,17 @@ public:
                  int windowWidth = 800, int windowHeight = 600,
                  unsigned int displayMode = _kDefaultDisplayMode);
 
+  // Returns the mesh loader of the application (its threads are started on the first call).
+  static MeshLoader* GetMeshLoader();
+
+  // Sets the time spent uploading meshes in each cycle (milliseconds, see MeshLoader).
+  static void SetUploadBudget(double budgetMs) { sUploadBudget = budgetMs; }
+  static double GetUploadBudget() { return sUploadBudget; }
+
 private:
   static GlutViewController* sViewController;
+  static MeshLoader* sMeshLoader;
+  static double sUploadBudget;
 
   // GLUT Callbacks.
   static void Idle();     // Default callback in each cycle of GLUT. 
@@ -1,150 +1,510 @@
 #include "group.h"
+#include "interleave.h"
 #include <cassert>
+#include <algorithm>
 
 namespace gloo
 {
 
-template <>
-bool MeshGroup<Interleave>::Load(const std::vector<GLfloat*> & bufferList, const GLuint* indices)
+namespace
 {
-  assert(bufferList.size() == mNumAttributes);
+  // Dirty ranges closer than this (in vertices) are merged into a single transfer:
+  // re-uploading a few clean vertices is cheaper than issuing another driver call.
+  const GLuint kDirtyRangeMergeGap = 64;
+
+  // Returns 'count' tightly packed attributes ready to be uploaded. Float attributes are
+  // uploaded straight from 'src'; the other formats are converted into 'scratch'.
+  const void* PackForUpload(const VertexAttrib & attrib, const GLfloat* src, GLuint count,
+                            std::vector<GLubyte> & scratch)
+  {
+    if (attrib.mFormat == kFloat32)
+      return src;
 
-  // Create temporary buffers to transfer geometry and elements to GPU.
-  std::vector<GLfloat> vertexBuffer;
-  vertexBuffer.reserve(mNumVertices * mVertexSize);
+    const GLuint bytes = GetAttribBytes(attrib);
+    scratch.resize(count * bytes);
+    PackAttrib(attrib, src, attrib.mSize, count, scratch.data(), bytes);
+
+    return scratch.data();
+  }
 
-  // Copy geometry to temporary buffers in memory.
-  for (int i = 0; i < mNumVertices; i++)
+  // Interleaves all attributes at once with the SIMD kernels (see interleave.h). Returns false
+  // if an attribute isn't stored as floats or isn't provided (it's packed one by one then).
+  bool InterleaveFloatAttribs(const std::vector<VertexAttrib> & vertexAttribList,
+                              const std::vector<GLfloat*> & bufferList, GLuint count,
+                              GLubyte* dst)
   {
-    // For each attribute,
-    for (int j = 0; j < mNumAttributes; j++)
+    std::vector<GLuint> sizes;
+    for (GLuint j = 0; j < vertexAttribList.size(); j++)
     {
-      const GLuint size   = mVertexAttributeList[j];
-      const float* buffer = bufferList[j];
+      if (vertexAttribList[j].mFormat != kFloat32 || bufferList[j] == nullptr)
+        return false;
+
+      sizes.push_back(vertexAttribList[j].mSize);
+    }
 
-      if ((size > 0) && (buffer != nullptr))
+    InterleaveFloats(bufferList.data(), sizes.data(), sizes.size(), count,
+                     reinterpret_cast<GLfloat*>(dst));
+    return true;
+  }
+
+  // Sorts dirty ranges and merges the ones that overlap or are close enough.
+  std::vector<std::pair<GLuint, GLuint>>
+  MergeDirtyRanges(std::vector<std::pair<GLuint, GLuint>> ranges)
+  {
+    std::sort(ranges.begin(), ranges.end());
+
+    std::vector<std::pair<GLuint, GLuint>> merged;
+    merged.push_back(ranges[0]);
+    for (size_t i = 1; i < ranges.size(); i++)
+    {
+      std::pair<GLuint, GLuint> & last = merged.back();
+      if (ranges[i].first <= last.second + kDirtyRangeMergeGap)
+      {
+        last.second = std::max(last.second, ranges[i].second);
+      }
+      else
       {
-        // Add elements (coordinate, normals, ...).
-        for (int k = 0; k < size; k++) 
-        {
-          vertexBuffer.push_back(buffer[size*i + k]);
-        }
+        merged.push_back(ranges[i]);
       }
     }
+
+    return merged;
   }
 
-  // Reserve vertex buffer and initialize element array (indices array).
-  if (indices)  // Element array provided.
+  // Streams of position-split groups (see PackSplitStreams()).
+  const GLuint kPositionStream = 1 << 0;
+  const GLuint kOtherStream    = 1 << 1;
+
+  // Packs the provided attributes into a position-split vertex buffer (positions first, then the
+  // other attributes interleaved, with the SIMD kernels if they are all floats). Returns the
+  // streams that were written.
+  GLuint PackSplitStreams(const std::vector<VertexAttrib> & vertexAttribList,
+                          const std::vector<GLfloat*> & bufferList, GLuint count,
+                          const std::vector<GLuint> & offsets, const std::vector<GLuint> & strides,
+                          GLubyte* dst)
   {
-    MeshGroup<Interleave>::AllocateBuffers(vertexBuffer.data(), indices);
+    const std::vector<VertexAttrib> otherAttribs(vertexAttribList.begin() + 1,
+                                                 vertexAttribList.end());
+    const std::vector<GLfloat*> otherBuffers(bufferList.begin() + 1, bufferList.end());
+    const bool interleaved = !otherAttribs.empty()
+                          && InterleaveFloatAttribs(otherAttribs, otherBuffers, count,
+                                                    dst + offsets[1]);
+
+    GLuint streams = interleaved ? kOtherStream : 0;
+    const GLuint numPacked = interleaved ? 1 : vertexAttribList.size();
+    for (GLuint j = 0; j < numPacked; j++)
+    {
+      const VertexAttrib & attrib = vertexAttribList[j];
+      if ((attrib.mSize > 0) && (bufferList[j] != nullptr))
+      {
+        PackAttrib(attrib, bufferList[j], attrib.mSize, count, dst + offsets[j], strides[j]);
+        streams |= (j == 0) ? kPositionStream : kOtherStream;
+      }
+    }
+
+    return streams;
   }
-  else  // Element array wasn't provided -- build it up.
+}  // namespace.
+
+template <>
+void MeshGroup<Interleave>::ComputeLayout()
+{
+  // (A0 B0 C0) (A1 B1 C1) ... -> attributes are offset within a vertex.
+  mAttribOffsets.resize(mNumAttributes);
+  mAttribStrides.assign(mNumAttributes, mVertexStride);
+
+  GLuint offset = 0;
+  for (GLuint j = 0; j < mNumAttributes; j++)
   {
-    std::vector<GLuint> elementsBuffer(mNumElements);
+    mAttribOffsets[j] = offset;
+    offset += GetAttribBytes(mVertexAttributeList[j]);
+  }
+}
 
-    for (int i = 0; i < mNumElements; i++)
-      elementsBuffer[i] = i;
+template <>
+bool MeshGroup<Interleave>::Load(const std::vector<GLfloat*> & sourceList, const GLuint* indices)
+{
+  assert(sourceList.size() == mNumAttributes);
+
+  // Merge duplicate vertices (and index the unique ones), if enabled.
+  std::vector<std::vector<GLfloat>> welded;
+  std::vector<GLuint> weldedIndices;
+  const std::vector<GLfloat*> inputList =
+    MeshGroup<Interleave>::WeldBufferList(sourceList, indices, welded, weldedIndices);
+
+  // Reorder indices (and vertices) for the vertex cache, if enabled.
+  std::vector<GLuint> optimized;
+  std::vector<std::vector<GLfloat>> remapped;
+  const GLfloat* positions = inputList[mPositionAttrib];
+  const GLuint positionStride = mVertexAttributeList[mPositionAttrib].mSize;
+  MeshGroup<Interleave>::ComputeBoundingSphere(positions, positionStride);
+  indices = MeshGroup<Interleave>::OptimizeIndices(indices, optimized, positions, positionStride);
+  const std::vector<GLfloat*> bufferList = MeshGroup<Interleave>::RemapBufferList(inputList, remapped);
+
+  // The staging copy is the interleaved buffer transferred to the GPU.
+  mStagingBuffer.assign(mNumVertices * mVertexStride, 0);
+  mDirtyRanges.clear();
+
+  // Convert geometry into the staging buffer, one attribute at a time (unless all are floats).
+  const bool interleaved = InterleaveFloatAttribs(mVertexAttributeList, bufferList, mNumVertices,
+                                                  mStagingBuffer.data());
+  for (int j = 0; j < mNumAttributes && !interleaved; j++)
+  {
+    const VertexAttrib & attrib = mVertexAttributeList[j];
+    const float* buffer = bufferList[j];
 
-    MeshGroup<Interleave>::AllocateBuffers(vertexBuffer.data(), elementsBuffer.data());
+    if ((attrib.mSize > 0) && (buffer != nullptr))
+    {
+      PackAttrib(attrib, buffer, attrib.mSize, mNumVertices, 
+                 &mStagingBuffer[mAttribOffsets[j]], mAttribStrides[j]);
+    }
   }
+
+  // Reserve vertex buffer and initialize element array (if indices were provided).
+  MeshGroup<Interleave>::AllocateBuffers(mStagingBuffer.data(), indices);
+
+  MeshGroup<Interleave>::ReleaseStagingCopy();
+  return true;
 }
 
 template <>
 void MeshGroup<Interleave>::BuildVAO(const std::vector<std::pair<GLint, bool>> & attribList)
 {
   // Specify VAO.
-  int offset = 0;
-  GLfloat stride = sizeof(GLfloat) * mVertexSize;
   for (int j = 0; j < mNumAttributes; j++)
   {
-    const int size    = mVertexAttributeList[j];
+    const VertexAttrib & attrib = mVertexAttributeList[j];
     const GLint loc   = attribList[j].first;
     const bool active = attribList[j].second;
 
-    if ((size > 0) && active)
+    if ((attrib.mSize > 0) && active)
     {
       // Specify internal storage architecture of Vertex Buffer.
-      glVertexAttribPointer(loc, size, GL_FLOAT, GL_FALSE, stride, 
-        (void*)(sizeof(GLfloat) * offset));
+      glVertexAttribPointer(loc, GetAttribComponents(attrib), GetAttribType(attrib.mFormat),
+        IsAttribNormalized(attrib.mFormat), mAttribStrides[j], (void*)(GLintptr)mAttribOffsets[j]);
     }
+  }
+}
 
-    offset += size;
+template <>
+bool MeshGroup<Interleave>::Update(const std::vector<GLfloat*> & inputList)
+{
+  assert(inputList.size() == mNumAttributes);
+
+  std::vector<std::vector<GLfloat>> remapped;
+  const std::vector<GLfloat*> bufferList = MeshGroup<Interleave>::RemapBufferList(inputList, remapped);
+
+  // Convert the new attribute data into the staging copy (attributes that aren't provided keep
+  // their contents).
+  const bool complete =
+    std::find(bufferList.begin(), bufferList.end(), nullptr) == bufferList.end();
+  MeshGroup<Interleave>::RestoreStagingCopy(!complete);
+  const bool interleaved = InterleaveFloatAttribs(mVertexAttributeList, bufferList, mNumVertices,
+                                                  mStagingBuffer.data());
+  if (interleaved)
+    MeshGroup<Interleave>::MarkDirty(0, mNumVertices);
+
+  for (int j = 0; j < mNumAttributes && !interleaved; j++)
+  {
+    const VertexAttrib & attrib = mVertexAttributeList[j];
+    const float* buffer = bufferList[j];
+
+    if ((attrib.mSize > 0) && (buffer != nullptr))
+    {
+      PackAttrib(attrib, buffer, attrib.mSize, mNumVertices, 
+                 &mStagingBuffer[mAttribOffsets[j]], mAttribStrides[j]);
+      MeshGroup<Interleave>::MarkDirty(0, mNumVertices);
+    }
   }
+
+  MeshGroup<Interleave>::FlushUpdates();
+  return true;
 }
 
 template <>
-bool MeshGroup<Interleave>::Update(const std::vector<GLfloat*> & bufferList)
+bool MeshGroup<Interleave>::Update(GLuint attrib, GLuint firstVertex, GLuint count, 
+                                   const GLfloat* data)
 {
-  assert(bufferList.size() == mNumAttributes);
+  assert(attrib < mNumAttributes);
+  assert(firstVertex + count <= mNumVertices);
+  assert(mVertexRemap.empty());  // Vertices were reordered: ranges aren't contiguous anymore.
 
+  MeshGroup<Interleave>::RestoreStagingCopy(true);
+  assert(mStagingBuffer.size() == mNumVertices * mVertexStride);
+
+  const VertexAttrib & attribDesc = mVertexAttributeList[attrib];
+  GLubyte* dst = &mStagingBuffer[mAttribOffsets[attrib] + mVertexStride*firstVertex];
+
+  PackAttrib(attribDesc, data, attribDesc.mSize, count, dst, mVertexStride);
+  MeshGroup<Interleave>::MarkDirty(firstVertex, count);
+
+  return true;
+}
+
+template <>
+void MeshGroup<Interleave>::FlushUpdates()
+{
+  if (mDirtyRanges.empty())
+    return;
+
+  if (mNumFrames > 1)  // Streaming: the next frame region receives the whole staging copy.
+  {
+    MeshGroup<Interleave>::PublishStagingCopy();
+    return;
+  }
+
+  const std::vector<std::pair<GLuint, GLuint>> merged = MergeDirtyRanges(mDirtyRanges);
+  mDirtyRanges.clear();
+
+  if (mArena)  // Shared buffer: write the ranges inside this group's block.
+  {
+    for (const std::pair<GLuint, GLuint> & range : merged)
+    {
+      const GLuint last = std::min(range.second, mNumVertices);
+      mArena->UploadVertices(mVertexBlock, range.first, last - range.first, 
+                             &mStagingBuffer[range.first * mVertexStride]);
+    }
+    return;
+  }
+
+  const GLsizeiptr vertexBytes = mVertexStride;
   glBindBuffer(GL_ARRAY_BUFFER, mVbo);
 
-  // Upload subdata of geometry to GPU.
-  int attrib_offset = 0;
-  for (int j = 0; j < mNumAttributes; j++)
+  if (merged.size() == 1 && merged[0].first == 0 && merged[0].second >= mNumVertices)
   {
-    const unsigned size = mVertexAttributeList[j];
-    const float* buffer = bufferList[j];
+    // The whole buffer changes: orphan it so that we don't wait for the GPU to release it.
+    glBufferData(GL_ARRAY_BUFFER, mNumVertices * vertexBytes, mStagingBuffer.data(), mDataUsage);
+  }
+  else
+  {
+    for (const std::pair<GLuint, GLuint> & range : merged)
+    {
+      const GLuint last = std::min(range.second, mNumVertices);
+      glBufferSubData(GL_ARRAY_BUFFER, range.first * vertexBytes,            // Offset.
+                      (last - range.first) * vertexBytes,                    // Size.
+                      &mStagingBuffer[range.first * mVertexStride]);         // Data.
+    }
+  }
+}
 
-    if ((size > 0) && (buffer != nullptr))
+template <>
+void MeshGroup<Interleave>::StoreStagingCopy(const GLfloat* vertices)
+{
+  mStagingBuffer.assign(mNumVertices * mVertexStride, 0);
+
+  if (vertices)
+  {
+    // Raw buffer: interleaved floats, mVertexSize per vertex.
+    GLuint offset = 0;
+    for (GLuint j = 0; j < mNumAttributes; j++)
     {
-      for (int i = 0; i < mNumVertices; i++)
-      {
-        glBufferSubData(GL_ARRAY_BUFFER,
-                        (mVertexSize*i + attrib_offset)*sizeof(GLfloat), // Offset.
-                        size*sizeof(GLfloat), &buffer[size*i]);          // Size.
-      }
+      const VertexAttrib & attrib = mVertexAttributeList[j];
+      PackAttrib(attrib, vertices + offset, mVertexSize, mNumVertices, 
+                 &mStagingBuffer[mAttribOffsets[j]], mAttribStrides[j]);
+      offset += attrib.mSize;
     }
+  }
 
-    attrib_offset += size;
+  // Pending ranges are superseded by the new contents.
+  mDirtyRanges.clear();
+}
+
+template <>
+void MeshGroup<Interleave>::ReleaseStagingCopy()
+{
+  // Interleaved groups keep it to apply partial updates, unless they are static.
+  if (mNumFrames == 1 && mDataUsage == GL_STATIC_DRAW)
+  {
+    std::vector<GLubyte>().swap(mStagingBuffer);
   }
 }
 
+template <>
+void MeshGroup<Interleave>::CopyStagingToFrame(GLuint frame)
+{
+  // Frame regions are consecutive copies of the interleaved buffer.
+  const GLsizeiptr frameBytes = mNumVertices * mVertexStride;
+  MeshGroup<Interleave>::WriteStreamingRange(frame * frameBytes, frameBytes, mStagingBuffer.data());
+}
+
 // ============================================================================================= //
 
 template <>
-bool MeshGroup<Batch>::Load(const std::vector<GLfloat*> & bufferList, const GLuint* indices)
+void MeshGroup<Batch>::ComputeLayout()
 {
-  assert(bufferList.size() == mNumAttributes);
+  // (A0 A1 A2 ...) (B0 B1 B2 ...) ... -> each attribute is a tightly packed sub-buffer.
+  mAttribOffsets.resize(mNumAttributes);
+  mAttribStrides.resize(mNumAttributes);
 
-  // Reserve vertex buffer and initialize element array (indices array).
-  if (indices)  // Element array provided.
+  GLuint offset = 0;
+  for (GLuint j = 0; j < mNumAttributes; j++)
   {
-    MeshGroup<Batch>::AllocateBuffers(nullptr, indices);
+    mAttribOffsets[j] = offset;
+    mAttribStrides[j] = GetAttribBytes(mVertexAttributeList[j]);
+    offset += mAttribStrides[j] * mNumVertices;
   }
-  else  // Element array wasn't provided -- build it up.
-  {
-    std::vector<GLuint> elementsBuffer(mNumElements);
+}
 
-    for (int i = 0; i < mNumElements; i++)
-      elementsBuffer[i] = i;
+template <>
+bool MeshGroup<Batch>::Load(const std::vector<GLfloat*> & sourceList, const GLuint* indices)
+{
+  assert(sourceList.size() == mNumAttributes);
 
-    MeshGroup<Batch>::AllocateBuffers(nullptr, elementsBuffer.data());
-  }
+  // Merge duplicate vertices (and index the unique ones), if enabled.
+  std::vector<std::vector<GLfloat>> welded;
+  std::vector<GLuint> weldedIndices;
+  const std::vector<GLfloat*> bufferList =
+    MeshGroup<Batch>::WeldBufferList(sourceList, indices, welded, weldedIndices);
+
+  // Reorder indices for the vertex cache, if enabled (Update() remaps the vertices).
+  std::vector<GLuint> optimized;
+  const GLfloat* positions = bufferList[mPositionAttrib];
+  const GLuint positionStride = mVertexAttributeList[mPositionAttrib].mSize;
+  MeshGroup<Batch>::ComputeBoundingSphere(positions, positionStride);
+  indices = MeshGroup<Batch>::OptimizeIndices(indices, optimized, positions, positionStride);
+
+  // Streaming groups fill their frame regions from the staging copy.
+  if (mNumFrames > 1)
+    MeshGroup<Batch>::StoreStagingCopy(nullptr);
+
+  // Reserve vertex buffer and initialize element array (if indices were provided).
+  MeshGroup<Batch>::AllocateBuffers(nullptr, indices);
 
   MeshGroup<Batch>::Update(bufferList);
+
+  return true;
 }
 
 template <>
-bool MeshGroup<Batch>::Update(const std::vector<GLfloat*> & bufferList)
+bool MeshGroup<Batch>::Update(const std::vector<GLfloat*> & inputList)
 {
-  assert(bufferList.size() == mNumAttributes);
+  assert(inputList.size() == mNumAttributes);
+
+  std::vector<std::vector<GLfloat>> remapped;
+  const std::vector<GLfloat*> bufferList = MeshGroup<Batch>::RemapBufferList(inputList, remapped);
+
+  if (mNumFrames > 1)  // Streaming: refresh the staging copy and write it into the next region.
+  {
+    for (int j = 0; j < mNumAttributes; j++)
+    {
+      const VertexAttrib & attrib = mVertexAttributeList[j];
+      const float* buffer = bufferList[j];
+
+      if ((attrib.mSize > 0) && (buffer != nullptr))
+      {
+        PackAttrib(attrib, buffer, attrib.mSize, mNumVertices, 
+                   &mStagingBuffer[mAttribOffsets[j]], mAttribStrides[j]);
+      }
+    }
+
+    MeshGroup<Batch>::PublishStagingCopy();
+    return true;
+  }
 
   glBindBuffer(GL_ARRAY_BUFFER, mVbo);
 
-  // Upload subdata of geometry to GPU.
-  int offset = 0;
+  // If all attributes change, orphan the buffer so that we don't wait for the GPU to release it.
+  if (std::find(bufferList.begin(), bufferList.end(), nullptr) == bufferList.end())
+  {
+    glBufferData(GL_ARRAY_BUFFER, mVertexStride * mNumVertices, nullptr, mDataUsage);
+  }
+
+  // Upload subdata of geometry to GPU (converted to the attribute format if needed).
+  std::vector<GLubyte> scratch;
   for (int j = 0; j < mNumAttributes; j++)
   {
-    const unsigned size = mVertexAttributeList[j];
+    const VertexAttrib & attrib = mVertexAttributeList[j];
     const float* buffer = bufferList[j];
 
-    if ((size > 0) && (buffer != nullptr))
+    if ((attrib.mSize > 0) && (buffer != nullptr))
     {
-      glBufferSubData(GL_ARRAY_BUFFER, offset, size*mNumVertices*sizeof(GLfloat), buffer);
+      glBufferSubData(GL_ARRAY_BUFFER, mAttribOffsets[j], mAttribStrides[j]*mNumVertices,
+                      PackForUpload(attrib, buffer, mNumVertices, scratch));
     }
+  }
+
+  return true;
+}
+
+template <>
+bool MeshGroup<Batch>::Update(GLuint attrib, GLuint firstVertex, GLuint count, const GLfloat* data)
+{
+  assert(attrib < mNumAttributes);
+  assert(firstVertex + count <= mNumVertices);
+  assert(mVertexRemap.empty());  // Vertices were reordered: ranges aren't contiguous anymore.
+
+  const VertexAttrib & attribDesc = mVertexAttributeList[attrib];
+  const GLuint offset = mAttribOffsets[attrib] + mAttribStrides[attrib]*firstVertex;
 
-    offset += size*mNumVertices * sizeof(GLfloat);
+  if (mNumFrames > 1)  // Streaming: keep it in the staging copy until FlushUpdates().
+  {
+    PackAttrib(attribDesc, data, attribDesc.mSize, count, &mStagingBuffer[offset], 
+               mAttribStrides[attrib]);
+    MeshGroup<Batch>::MarkDirty(firstVertex, count);
+    return true;
+  }
+
+  // Vertices of the same attribute are contiguous, so the range is a single transfer.
+  std::vector<GLubyte> scratch;
+  glBindBuffer(GL_ARRAY_BUFFER, mVbo);
+  glBufferSubData(GL_ARRAY_BUFFER, offset, mAttribStrides[attrib] * count, 
+                  PackForUpload(attribDesc, data, count, scratch));
+
+  return true;
+}
+
+template <>
+void MeshGroup<Batch>::FlushUpdates()
+{
+  // Batched updates are uploaded right away, unless we are streaming.
+  if (mNumFrames > 1 && !mDirtyRanges.empty())
+  {
+    MeshGroup<Batch>::PublishStagingCopy();
+  }
+}
+
+template <>
+void MeshGroup<Batch>::StoreStagingCopy(const GLfloat* vertices)
+{
+  mStagingBuffer.assign(mNumVertices * mVertexStride, 0);
+
+  if (vertices)
+  {
+    // Raw buffer: one tightly packed float sub-buffer per attribute.
+    GLuint offset = 0;
+    for (GLuint j = 0; j < mNumAttributes; j++)
+    {
+      const VertexAttrib & attrib = mVertexAttributeList[j];
+      PackAttrib(attrib, vertices + offset*mNumVertices, attrib.mSize, mNumVertices, 
+                 &mStagingBuffer[mAttribOffsets[j]], mAttribStrides[j]);
+      offset += attrib.mSize;
+    }
+  }
+
+  mDirtyRanges.clear();
+}
+
+template <>
+void MeshGroup<Batch>::ReleaseStagingCopy()
+{
+  // Only streaming groups need a staging copy after uploading.
+  if (mNumFrames == 1)
+  {
+    std::vector<GLubyte>().swap(mStagingBuffer);
+  }
+}
+
+template <>
+void MeshGroup<Batch>::CopyStagingToFrame(GLuint frame)
+{
+  // Each attribute sub-buffer holds its data for all frames: (P0 P1 P2) (N0 N1 N2) ...
+  // so that a frame is selected just by offsetting the base vertex.
+  for (GLuint j = 0; j < mNumAttributes; j++)
+  {
+    const GLsizeiptr size = mAttribStrides[j] * mNumVertices;
+    const GLintptr dst = mAttribOffsets[j]*mNumFrames + size*frame;
+
+    MeshGroup<Batch>::WriteStreamingRange(dst, size, &mStagingBuffer[mAttribOffsets[j]]);
   }
 }
 
@@ -152,25 +512,263 @@ template <>
 void MeshGroup<Batch>::BuildVAO(const std::vector<std::pair<GLint, bool>> & attribList)
 {
   // Specify VAO.
-  int offset = 0;
   for (int j = 0; j < mNumAttributes; j++)
   {
-    const int size    = mVertexAttributeList[j];
+    const VertexAttrib & attrib = mVertexAttributeList[j];
     const GLint loc   = attribList[j].first;
     const bool active = attribList[j].second;
 
-    if ((size > 0) && active)
+    if ((attrib.mSize > 0) && active)
     {
       // Specify internal storage architecture of Vertex Buffer.
-      glVertexAttribPointer(loc, size, GL_FLOAT, GL_FALSE, 0, 
-        (void*)(sizeof(GLfloat) * offset*mNumVertices));
+      // Streaming groups store all frames of an attribute contiguously.
+      glVertexAttribPointer(loc, GetAttribComponents(attrib), GetAttribType(attrib.mFormat),
+        IsAttribNormalized(attrib.mFormat), mAttribStrides[j], 
+        (void*)(GLintptr)(mAttribOffsets[j]*mNumFrames));
+    }
+  }
+}
+
+// ============================================================================================= //
+
+template <>
+void MeshGroup<PositionSplit>::ComputeLayout()
+{
+  // (P0 P1 P2 ...) (A0 B0) (A1 B1) ... -> positions are a tightly packed stream, followed by a
+  // stream with the other attributes interleaved.
+  mAttribOffsets.resize(mNumAttributes);
+  mAttribStrides.resize(mNumAttributes);
+  if (mNumAttributes == 0)
+    return;
+
+  const GLuint positionBytes = GetAttribBytes(mVertexAttributeList[0]);
+  mAttribOffsets[0] = 0;
+  mAttribStrides[0] = positionBytes;
+
+  GLuint offset = positionBytes * mNumVertices;
+  for (GLuint j = 1; j < mNumAttributes; j++)
+  {
+    mAttribOffsets[j] = offset;
+    mAttribStrides[j] = mVertexStride - positionBytes;
+    offset += GetAttribBytes(mVertexAttributeList[j]);
+  }
+}
+
+template <>
+bool MeshGroup<PositionSplit>::Load(const std::vector<GLfloat*> & sourceList,
+                                    const GLuint* indices)
+{
+  assert(sourceList.size() == mNumAttributes && mNumAttributes > 0);
+
+  // Merge duplicate vertices (and index the unique ones), if enabled.
+  std::vector<std::vector<GLfloat>> welded;
+  std::vector<GLuint> weldedIndices;
+  const std::vector<GLfloat*> inputList =
+    MeshGroup<PositionSplit>::WeldBufferList(sourceList, indices, welded, weldedIndices);
+
+  // Reorder indices (and vertices) for the vertex cache, if enabled.
+  std::vector<GLuint> optimized;
+  std::vector<std::vector<GLfloat>> remapped;
+  const GLfloat* positions = inputList[mPositionAttrib];
+  const GLuint positionStride = mVertexAttributeList[mPositionAttrib].mSize;
+  MeshGroup<PositionSplit>::ComputeBoundingSphere(positions, positionStride);
+  indices = MeshGroup<PositionSplit>::OptimizeIndices(indices, optimized, positions,
+                                                      positionStride);
+  const std::vector<GLfloat*> bufferList =
+    MeshGroup<PositionSplit>::RemapBufferList(inputList, remapped);
+
+  // The staging copy holds both streams, as transferred to the GPU.
+  mStagingBuffer.assign(mNumVertices * mVertexStride, 0);
+  mDirtyRanges.clear();
+
+  PackSplitStreams(mVertexAttributeList, bufferList, mNumVertices, mAttribOffsets, mAttribStrides,
+                   mStagingBuffer.data());
+
+  // Reserve vertex buffer and initialize element array (if indices were provided).
+  MeshGroup<PositionSplit>::AllocateBuffers(mStagingBuffer.data(), indices);
+
+  MeshGroup<PositionSplit>::ReleaseStagingCopy();
+  return true;
+}
+
+template <>
+bool MeshGroup<PositionSplit>::Update(const std::vector<GLfloat*> & inputList)
+{
+  assert(inputList.size() == mNumAttributes);
+
+  std::vector<std::vector<GLfloat>> remapped;
+  const std::vector<GLfloat*> bufferList =
+    MeshGroup<PositionSplit>::RemapBufferList(inputList, remapped);
+
+  const bool complete =
+    std::find(bufferList.begin(), bufferList.end(), nullptr) == bufferList.end();
+  MeshGroup<PositionSplit>::RestoreStagingCopy(!complete);
+
+  // Only the streams of the provided attributes are uploaded.
+  const GLuint streams = PackSplitStreams(mVertexAttributeList, bufferList, mNumVertices,
+                                          mAttribOffsets, mAttribStrides, mStagingBuffer.data());
+  if (streams & kPositionStream)
+    MeshGroup<PositionSplit>::MarkDirty(0, mNumVertices);
+  if (streams & kOtherStream)
+    MeshGroup<PositionSplit>::MarkDirty(mNumVertices, mNumVertices);
+
+  MeshGroup<PositionSplit>::FlushUpdates();
+  return true;
+}
+
+template <>
+bool MeshGroup<PositionSplit>::Update(GLuint attrib, GLuint firstVertex, GLuint count,
+                                      const GLfloat* data)
+{
+  assert(attrib < mNumAttributes);
+  assert(firstVertex + count <= mNumVertices);
+  assert(mVertexRemap.empty());  // Vertices were reordered: ranges aren't contiguous anymore.
+
+  MeshGroup<PositionSplit>::RestoreStagingCopy(true);
+  assert(mStagingBuffer.size() == mNumVertices * mVertexStride);
+
+  const VertexAttrib & attribDesc = mVertexAttributeList[attrib];
+  GLubyte* dst = &mStagingBuffer[mAttribOffsets[attrib] + mAttribStrides[attrib]*firstVertex];
+  PackAttrib(attribDesc, data, attribDesc.mSize, count, dst, mAttribStrides[attrib]);
+
+  // Dirty ranges cover the streams one after the other: [0, N) positions, [N, 2N) the others.
+  MeshGroup<PositionSplit>::MarkDirty(firstVertex + (attrib == 0 ? 0 : mNumVertices), count);
+
+  return true;
+}
+
+template <>
+void MeshGroup<PositionSplit>::FlushUpdates()
+{
+  if (mDirtyRanges.empty())
+    return;
+
+  if (mNumFrames > 1)  // Streaming: the next frame region receives the whole staging copy.
+  {
+    MeshGroup<PositionSplit>::PublishStagingCopy();
+    return;
+  }
+
+  const std::vector<std::pair<GLuint, GLuint>> merged = MergeDirtyRanges(mDirtyRanges);
+  mDirtyRanges.clear();
+
+  glBindBuffer(GL_ARRAY_BUFFER, mVbo);
+
+  if (merged.size() == 1 && merged[0].first == 0 && merged[0].second >= 2 * mNumVertices)
+  {
+    // Both streams change: orphan the buffer so that we don't wait for the GPU to release it.
+    glBufferData(GL_ARRAY_BUFFER, mNumVertices * mVertexStride, mStagingBuffer.data(), mDataUsage);
+    return;
+  }
+
+  // Merged ranges may cross from the position stream into the other one.
+  const GLuint positionBytes = mAttribStrides[0];
+  const GLuint otherBytes = mVertexStride - positionBytes;
+  const GLuint otherOffset = positionBytes * mNumVertices;
+  for (const std::pair<GLuint, GLuint> & range : merged)
+  {
+    const GLuint positionLast = std::min(range.second, mNumVertices);
+    if (range.first < positionLast)
+    {
+      glBufferSubData(GL_ARRAY_BUFFER, range.first * positionBytes,
+                      (positionLast - range.first) * positionBytes,
+                      &mStagingBuffer[range.first * positionBytes]);
+    }
+
+    if (range.second > mNumVertices)
+    {
+      const GLuint otherFirst = std::max(range.first, mNumVertices) - mNumVertices;
+      const GLuint otherLast = std::min(range.second, 2 * mNumVertices) - mNumVertices;
+      glBufferSubData(GL_ARRAY_BUFFER, otherOffset + otherFirst * otherBytes,
+                      (otherLast - otherFirst) * otherBytes,
+                      &mStagingBuffer[otherOffset + otherFirst * otherBytes]);
+    }
+  }
+}
+
+template <>
+void MeshGroup<PositionSplit>::StoreStagingCopy(const GLfloat* vertices)
+{
+  mStagingBuffer.assign(mNumVertices * mVertexStride, 0);
+
+  if (vertices)
+  {
+    // Raw buffer: the positions of all vertices, then the other floats interleaved.
+    const GLuint positionSize = mVertexAttributeList[0].mSize;
+    const GLuint otherSize = mVertexSize - positionSize;
+    const GLfloat* others = vertices + positionSize * mNumVertices;
+
+    GLuint offset = 0;
+    for (GLuint j = 0; j < mNumAttributes; j++)
+    {
+      const VertexAttrib & attrib = mVertexAttributeList[j];
+      if (j == 0)
+      {
+        PackAttrib(attrib, vertices, positionSize, mNumVertices, &mStagingBuffer[0],
+                   mAttribStrides[0]);
+        continue;
+      }
+
+      PackAttrib(attrib, others + offset, otherSize, mNumVertices,
+                 &mStagingBuffer[mAttribOffsets[j]], mAttribStrides[j]);
+      offset += attrib.mSize;
     }
+  }
+
+  mDirtyRanges.clear();
+}
 
-    offset += size;
+template <>
+void MeshGroup<PositionSplit>::ReleaseStagingCopy()
+{
+  // Position-split groups keep it to apply partial updates, unless they are static (like
+  // interleaved groups).
+  if (mNumFrames == 1 && mDataUsage == GL_STATIC_DRAW)
+  {
+    std::vector<GLubyte>().swap(mStagingBuffer);
+  }
+}
+
+template <>
+void MeshGroup<PositionSplit>::CopyStagingToFrame(GLuint frame)
+{
+  // Each stream holds its data for all frames: (P0 P1 P2) (O0 O1 O2), so that a frame is
+  // selected just by offsetting the base vertex.
+  const GLsizeiptr positionBytes = mAttribStrides[0] * mNumVertices;
+  const GLsizeiptr otherBytes = (mVertexStride - mAttribStrides[0]) * mNumVertices;
+
+  MeshGroup<PositionSplit>::WriteStreamingRange(positionBytes * frame, positionBytes,
+                                                mStagingBuffer.data());
+  if (otherBytes > 0)
+  {
+    MeshGroup<PositionSplit>::WriteStreamingRange(positionBytes * mNumFrames + otherBytes * frame,
+                                                  otherBytes, &mStagingBuffer[positionBytes]);
+  }
+}
+
+template <>
+void MeshGroup<PositionSplit>::BuildVAO(const std::vector<std::pair<GLint, bool>> & attribList)
+{
+  // Streaming groups store the positions of every frame before the other stream.
+  const GLuint otherStreamShift = mAttribStrides[0] * mNumVertices * (mNumFrames - 1);
+
+  // Passes that only enable positions read nothing but the tightly packed position stream.
+  for (int j = 0; j < mNumAttributes; j++)
+  {
+    const VertexAttrib & attrib = mVertexAttributeList[j];
+    const GLint loc   = attribList[j].first;
+    const bool active = attribList[j].second;
+
+    if ((attrib.mSize > 0) && active)
+    {
+      const GLuint offset = mAttribOffsets[j] + (j > 0 ? otherStreamShift : 0);
+      glVertexAttribPointer(loc, GetAttribComponents(attrib), GetAttribType(attrib.mFormat),
+        IsAttribNormalized(attrib.mFormat), mAttribStrides[j], (void*)(GLintptr)offset);
+    }
   }
 }
 
 // ============================================================================================= //
 
 
-}  // namespace gloo.
\ No newline at end of file
+}  // namespace gloo.
@@ -13,11 +13,18 @@
 
 // [StorageFormat]
 //
-// Each group has a single vertex buffer in GPU, which can follow two kinds of storage:
+// Each group has a single vertex buffer in GPU, which can follow three kinds of storage:
 // 1. Interleaved (Tighly Packed):  (P N T) (P N T) ... (P N T)
 // 2. Batched (Sub-Buffered):       (P P ... P) (N N ... N) (T T ... T)
+// 3. Position-split:               (P P ... P) (N T) (N T) ... (N T)
 // Where P is the vertex positions array, N is the vertex normals array and so on.
 //
+// Position-split groups keep the first attribute (positions) in a tightly packed stream and
+// interleave the others after it. Rendering passes that only enable positions (shadow maps,
+// depth prepasses, picking) then fetch only positions (12 bytes per vertex for {3, kFloat32})
+// instead of whole vertices, and the other passes still read the remaining attributes together.
+// Raw buffers passed to Load()/Update() follow the same layout: (P P ... P) (N T) ... (N T).
+//
 // The storage format is provided by the template parameter <StorageFormat F>. 
 
 // [Vertex Attribute Data]
@@ -30,6 +37,15 @@
 // the second contains 3 floats and the last one has 2 floats (typically 3d coordinates, 
 // normal vector and uv texture coordinates).
 // Vertex attribute data is specified by calling SetVertexAttribList().
+//
+// Each attribute can also declare how its components are stored in the GPU buffer, e.g.
+// {{3, kHalfFloat16}, {3, kSnorm2_10_10_10}, {2, kUnorm16}}. Data is still passed as floats:
+// it is converted when loading/updating. See vertex_format.h for the available formats.
+// Interleaved groups whose attributes are all floats are loaded from separate buffers with
+// SIMD kernels (see interleave.h).
+//
+// Layouts known at compile time can be part of the type instead: TypedMeshGroup<Layout<Pos3f,
+// Nrm3f, Uv2f>> (typed_group.h) loads arrays of vertex structs as they are (LoadPacked()).
 
 // [Rendering Pass]
 // A single mesh group can be rendered in different ways and in multiple passes.
@@ -37,6 +53,11 @@
 // which attributes will be enabled or not and what are their locations in the shader.
 //
 // The location in shaders must be coeherent to attributes you've written on your shader.   
+//
+// On OpenGL 4.3 (or with GL_ARB_vertex_attrib_binding), rendering passes don't create VAOs of
+// their own: groups with the same storage format, attribute list and pass share a VAO that only
+// describes the vertex format (see vertex_array_cache.h), and each draw attaches the buffers of
+// the group with glBindVertexBuffer(). Older contexts get a VAO per group and pass.
 
 // [Loading/updating data]
 // 
@@ -44,12 +65,121 @@
 // containing all arranged data or pass a list of separate buffers containing per attribute
 // data.
 // You can do it using the two overloaded versions of Load().
-// If you don't want to provide elements, just pass nullptr to 'indices' parameter and Load()
-// will automatically build the element array for you (following the default order).
+// If you don't want to provide elements, just pass nullptr to 'indices' parameter: no element
+// array is created and Render() draws the first 'numElements' vertices in order (glDrawArrays).
+// Indices are stored with the narrowest type that addresses all vertices (see index_format.h).
 //
 // You can either load/update the geometry from a single buffer containing all vertex data or load from a
 // list of buffers, each one corresponding to an attribute. 
 // When updating, you can optionally pass nullptr for attributes you don't want to update.
+//
+// [Mesh optimization]
+//
+// EnableVertexCacheOptimization() makes Load() reorder the triangles of indexed GL_TRIANGLES
+// groups for the post-transform vertex cache (see mesh_optimizer.h). Static groups also have
+// their vertices renumbered by first use, so that vertex fetch is sequential: later full
+// updates are remapped automatically, but partial updates aren't allowed anymore.
+// GetCacheStatsBefore()/GetCacheStatsAfter() report the ACMR/ATVR of the indices.
+// EnableOverdrawOptimization() additionally sorts triangle clusters so that opaque meshes
+// draw their occluding surfaces first (it needs the position attribute, see Load()).
+//
+// EnableVertexWelding() makes Load() merge duplicate vertices first (see vertex_weld.h), which
+// turns triangle soups into indexed meshes: groups loaded without indices get an element array
+// over the unique vertices, and given indices are rewritten to them. GetNumVertices() is then
+// the number of unique vertices, which later full updates must pass.
+//
+// Partial updates are done by Update(attrib, firstVertex, count, data), which changes 'count'
+// vertices of a single attribute. Interleaved groups keep a CPU staging copy of the vertex buffer:
+// partial updates are scattered into it and only mark the touched vertex range as dirty.
+// FlushUpdates() then uploads all dirty ranges at once, merging close ranges into a few large
+// transfers (and orphaning the buffer when everything changed). Batched groups store each
+// attribute contiguously, so their partial updates are uploaded right away. Position-split groups
+// keep a staging copy too, and only upload the dirty ranges of the streams that changed.
+// Groups with GL_STATIC_DRAW usage drop their staging copy after uploading it (they aren't
+// expected to change): their first update rebuilds it, reading the vertex buffer back if the
+// update doesn't replace every attribute (which stalls until the GPU is done with it).
+
+// [Streaming]
+//
+// Groups whose geometry changes every frame can call EnableStreaming(numFrames) right after
+// SetVertexAttribList(). The vertex buffer then holds 'numFrames' copies of the vertex data and,
+// when ARB_buffer_storage is available, it stays persistently mapped. Every update writes the
+// whole vertex data into the next frame region (straight into the mapped memory) and Render()
+// draws from the last written region. A fence per region makes sure we never overwrite data the
+// GPU is still reading, so updates don't stall on the previous frames.
+// Streaming groups also keep a staging copy, and their partial updates (in both storages) are
+// only written into a new frame region by FlushUpdates().
+
+// [Level of detail]
+//
+// A group can hold a chain of index buffers (levels of detail) over the same vertex buffer,
+// stored one after the other in the element array. EnableLodGeneration(targetErrors) makes
+// Load() build them for indexed GL_TRIANGLES groups with a quadric error metric simplifier
+// (see mesh_simplifier.h); AddLod() appends levels built by the caller (e.g. a coarser grid).
+// SelectLod() picks the coarsest level whose error, projected on screen, stays below
+// 'maxPixelError' pixels (renderers call it with Camera::ComputePixelsPerUnit()). It only
+// switches to a coarser level than the current one once it is clearly acceptable (hysteresis),
+// to avoid popping. The group keeps no selection: the current level belongs to each drawn
+// object (the caller keeps it, so one group can be drawn at several distances), and Render()
+// draws the level it is given.
+
+// [Meshlets]
+//
+// EnableMeshlets() makes Load() split the (first level of detail of) indexed GL_TRIANGLES
+// groups into meshlets: ranges of the element array with a bounding sphere and a normal cone
+// (see meshlet.h). Each frame, CullMeshlets() rejects meshlets outside the frustum or facing
+// away from the camera and fills a compacted MeshletDrawList (adjacent visible meshlets are
+// merged), which Render(drawList) submits with a single glMultiDrawElements() call. On closed
+// meshes, about half of the triangles are skipped. The list belongs to the caller and is only
+// drawn when passed to Render() (with the first level of detail): passes that don't pass it
+// (other cameras, shadow maps) draw the whole level.
+
+// [Shared buffers]
+//
+// SetArena() places the vertices and indices of a static interleaved group in a MeshArena
+// (see mesh_arena.h) instead of buffers of its own. The group is then drawn from its block
+// with glDrawElementsBaseVertex() and shares the arena VAOs with the other groups.
+
+// [Instancing]
+//
+// RenderInstanced() draws many copies of the group in a single call. Per-instance data
+// (InstanceData: model matrix, normal matrix and material index) is uploaded with
+// UpdateInstances() into an instance buffer and read by instanced rendering passes
+// (AddInstancedRenderingPass()), whose instance attributes advance once per instance
+// (glVertexAttribDivisor). See shaders/phong_instanced.
+
+// [Morph targets]
+//
+// Blend shapes are kept out of the group by a MorphTargetSet (see morph_targets.h), which stores
+// the vertices moved by each target only. They are blended on the GPU (the group itself is never
+// updated), or on the CPU with partial updates of the vertices whose targets changed.
+
+// [Draw ranges]
+//
+// AddDrawRange() registers a range of the element array (first index, number of indices and
+// base vertex) that RenderRange() draws on its own, so that the submeshes of a model (e.g. one
+// per material) can share the buffers of a single group. Ranges registered before Load() are
+// kept when indices are optimized: each one is reordered for the vertex cache separately (levels
+// of detail and meshlets, which span the whole element array, aren't built).
+//
+// EnablePrimitiveRestart() lets index streams of strips, loops and fans contain
+// kPrimitiveRestartIndex (see index_format.h) to start a new primitive, instead of repeating
+// indices to connect them.
+
+// [Mesh cache]
+//
+// LoadFromCache() loads an interleaved group from a .gloomesh file (see mesh_cache.h), written
+// offline by BuildMeshCache(). The file holds the attribute list, draw mode, optimized indices,
+// levels of detail and bounds, so the group can be created with no vertices/elements and no
+// attribute list. The mapped vertex and index data is uploaded as it is: groups loaded from a
+// cache keep no staging copy (see [Updates] for static groups). LoadPacked(const PackedMesh &) does the same
+// from memory, for meshes packed on worker threads by PackMesh() (see mesh_loader.h).
+
+// [Ownership]
+//
+// A group owns its buffers and VAOs, so it can't be copied. It can be moved (the moved-from
+// group is left empty), which lets many groups be stored in a ResourcePool and referred to by
+// MeshHandle<F> (see resource_pool.h).
 
 // [USAGE]
 /*
@@ -67,6 +197,10 @@
     // Load data into GPU (from separate buffers).
     group->Load({positions.data(), normals.data(), uv.data()}, indices.data());
     ...
+    // Update the positions of vertices [first, first+count) and upload them.
+    group->Update(0, first, count, newPositions.data());
+    group->FlushUpdates();
+    ...
     // Render!
     group->Render();
     ...
@@ -84,9 +218,27 @@
 #pragma once
 
 #include "gloo/gl_header.h"
+#include "gloo/gl_capabilities.h"
+#include "vertex_format.h"
+#include "index_format.h"
+#include "mesh_optimizer.h"
+#include "mesh_simplifier.h"
+#include "meshlet.h"
+#include "vertex_weld.h"
+#include "interleave.h"
+#include "mesh_arena.h"
+#include "vertex_array_cache.h"
+#include "mesh_cache.h"
+#include "gloo/gpu_memory.h"
+#include "gloo/resource_pool.h"
+
+#include <string>
 #include <vector>
+#include <utility>
+#include <algorithm>
 #include <initializer_list>
 #include <cassert>
+#include <cstddef>
 
 namespace gloo
 {
@@ -96,10 +248,44 @@ enum StorageFormat
 {
   Interleave,  // (Tighly Packed):  (P N T) (P N T) ... (P N T)
   Batch,       // (Sub-Buffered):   (P P ... P) (N N ... N) (T T ... T)
+  PositionSplit,  // (Position stream, then the others interleaved): (P P ... P) (N T) ... (N T)
 };
 
 const std::pair<GLint, bool> kNoAttrib = {-1, false};
 
+// Number of copies of the vertex data kept by streaming groups (triple buffering).
+const GLuint kDefaultNumStreamingFrames = 3;
+
+// Maximum time (in nanoseconds) we wait for a fence at once before flushing again.
+const GLuint64 kStreamingWaitTimeout = 1000000;
+
+// Maximum screen-space error (in pixels) tolerated when selecting a level of detail.
+const GLfloat kDefaultLodPixelError = 1.0f;
+
+// A coarser level of detail is only selected once its error is below (1 - kLodHysteresis)
+// of the tolerance.
+const GLfloat kLodHysteresis = 0.25f;
+
+// Per-instance data of instanced rendering passes (see [Instancing]).
+struct InstanceData
+{
+  GLfloat mModel[16];  // Model matrix (column-major).
+  GLfloat mNormal[9];  // Normal matrix: inverse transpose of the model 3x3 (column-major).
+  GLuint mMaterial;    // Material index.
+};
+
+// Range of the element array drawn by RenderRange() (see [Draw ranges]).
+struct DrawRange
+{
+  GLuint mFirstIndex;  // Offset (in indices) in the element array.
+  GLuint mNumIndices;  // Number of indices.
+  GLint mBaseVertex;   // Added to every index of the range.
+};
+
+// Attribute locations taken by InstanceData, starting at the instance attribute location:
+// model matrix (4 locations), normal matrix (3 locations) and material index (1 location).
+const GLuint kNumInstanceAttribLocations = 8;
+
 template <StorageFormat F>
 class MeshGroup
 {
@@ -111,16 +297,104 @@ public:
 
   ~MeshGroup();
 
-  // Specifies which data/properties the vertices contain.
-  void SetVertexAttribList(std::initializer_list<GLuint> vertexAttribList);
+  // Groups own their OpenGL objects: they can be moved (into a ResourcePool, for instance), but
+  // not copied. A moved-from group is empty.
+  MeshGroup(const MeshGroup<F> &) = delete;
+  MeshGroup<F> & operator=(const MeshGroup<F> &) = delete;
+  MeshGroup(MeshGroup<F> && other);
+  MeshGroup<F> & operator=(MeshGroup<F> && other);
+
+  // Specifies which data/properties the vertices contain (and their storage formats).
+  void SetVertexAttribList(std::initializer_list<VertexAttrib> vertexAttribList);
+  void SetVertexAttribList(const std::vector<VertexAttrib> & vertexAttribList);
+
+  // Reorders indices passed to Load() for a post-transform cache of 'cacheSize' vertices.
+  // Must be called before Load(). Only indexed GL_TRIANGLES groups are optimized.
+  void EnableVertexCacheOptimization(GLuint cacheSize = kDefaultVertexCacheSize);
+
+  // Sorts triangle clusters after the vertex cache optimization to reduce overdraw.
+  // 'positionAttrib' is the attribute holding vertex positions (at least 3 components).
+  // The ACMR is allowed to grow by 'threshold' (ratio). Must be called before Load().
+  void EnableOverdrawOptimization(GLuint positionAttrib = 0,
+                                  GLfloat threshold = kDefaultOverdrawThreshold);
+
+  // Makes Load() merge vertices with equal attributes (and positions in the same cell of a
+  // 'positionEpsilon' grid, if not 0) and index the unique ones. Must be called before Load().
+  void EnableVertexWelding(GLfloat positionEpsilon = 0.0f, GLuint positionAttrib = 0);
+
+  // Makes Load() build one level of detail per target error (relative to the mesh radius,
+  // increasing). Must be called before Load(). Only indexed GL_TRIANGLES groups get levels.
+  void EnableLodGeneration(const std::vector<GLfloat> & targetErrors, GLuint positionAttrib = 0);
+
+  // Appends a level of detail (indices over the same vertices, in the original vertex order)
+  // with geometric error 'error' (object units). Must be called after Load(), coarsest last.
+  bool AddLod(const std::vector<GLuint> & indices, GLfloat error);
+
+  // Returns the level of detail to draw, given how many pixels one object unit covers on screen
+  // and the level the object was drawn with last ('currentLod'). See [Level of detail].
+  GLuint SelectLod(GLfloat pixelsPerUnit, GLuint currentLod = 0,
+                   GLfloat maxPixelError = kDefaultLodPixelError) const;
+
+  // Makes Load() build meshlets (see [Meshlets]). Must be called before Load().
+  void EnableMeshlets(GLuint positionAttrib = 0);
+
+  // Culls meshlets against the frustum of 'modelViewProj' (column-major) and the camera position
+  // 'eye' (object space), and stores the visible ones into 'drawList' (see Render(drawList)).
+  // Returns the number of triangles that will be drawn.
+  GLuint CullMeshlets(const GLfloat* modelViewProj, const GLfloat* eye,
+                      MeshletDrawList & drawList) const;
+
+  // Makes kPrimitiveRestartIndex restart strips/loops/fans (see [Draw ranges]).
+  // Must be called before Load().
+  void EnablePrimitiveRestart() { mPrimitiveRestart = true; }
+
+  // Registers a range of the element array (or of vertices, if the group isn't indexed) and
+  // returns its index, to be passed to RenderRange().
+  int AddDrawRange(GLuint firstIndex, GLuint numIndices, GLint baseVertex = 0);
+
+  // Stores the vertices and indices of this group in 'arena' (see [Shared buffers]).
+  // Must be called after SetVertexAttribList() (with the arena attribute list) and before
+  // adding rendering passes. Only for interleaved, non-streaming groups. The arena must
+  // outlive the group.
+  void SetArena(MeshArena* arena);
+
+  // Keeps 'numFrames' copies of the vertex data in a (persistently mapped) ring buffer.
+  // Must be called after SetVertexAttribList() and before adding rendering passes.
+  void EnableStreaming(GLuint numFrames = kDefaultNumStreamingFrames);
+
+  // Name of the buffers of this group in GPU memory reports (see gpu_memory.h).
+  void SetDebugName(const std::string & name);
+  const std::string & GetDebugName() const { return mDebugName; }
 
   // Adds a different way of rendering the object - each one might use different 
   // attributes of the vertex. The active attribute list specifies which attributes 
   // are enabled and their corresponding shader locations.
+  // The VAO of the pass is shared with other groups when possible (see [Rendering Pass]).
   int AddRenderingPass(const std::vector<std::pair<GLint, bool>> & attribList);
 
-  // Should be called on display function (it calls glDrawElements).
-  void Render(unsigned renderingPass = 0) const;
+  // Should be called on display function (it calls glDrawElements or glDrawArrays).
+  // Draws level of detail 'lod' (see SelectLod()).
+  void Render(unsigned renderingPass = 0, GLuint lod = 0) const;
+
+  // Same as Render(), but draws only the meshlets of 'drawList' (see CullMeshlets()) if 'lod'
+  // is the first level of detail.
+  void Render(const MeshletDrawList & drawList, unsigned renderingPass = 0, GLuint lod = 0) const;
+
+  // Draws a single range (see AddDrawRange()).
+  void RenderRange(unsigned drawRange, unsigned renderingPass = 0) const;
+
+  // Adds a rendering pass that also reads InstanceData from the instance buffer, at
+  // locations [instanceAttribLoc, instanceAttribLoc + kNumInstanceAttribLocations).
+  // Not available for groups stored in a MeshArena.
+  int AddInstancedRenderingPass(const std::vector<std::pair<GLint, bool>> & attribList,
+                                GLint instanceAttribLoc);
+
+  // Replaces the contents of the instance buffer (read by the next RenderInstanced() calls).
+  void UpdateInstances(const InstanceData* instances, GLuint numInstances);
+
+  // Draws one copy of the group per instance (an instanced rendering pass must be used), all of
+  // them at level of detail 'lod'.
+  void RenderInstanced(unsigned renderingPass = 0, GLuint lod = 0) const;
 
   // TODO: document.
   bool Load(const GLfloat* buffer, const GLuint* indices);
@@ -130,33 +404,185 @@ public:
   bool Update(const GLfloat* buffer);
   bool Update(const std::vector<GLfloat*> & bufferList);
 
+  // Loads/updates vertices that already follow the storage layout and attribute formats of
+  // this group (e.g. an array of vertex structs, see TypedMeshGroup in typed_group.h).
+  // They are copied as they are, without converting attributes.
+  bool LoadPacked(const void* vertices, const GLuint* indices);
+  bool UpdatePacked(const void* vertices);
+
+  // Replaces the geometry of this group (and its attribute list, if none was set) with the
+  // contents of a mesh cache. Returns false if the file isn't a valid cache or if its attribute
+  // list differs from this group's. Only for interleaved, non-streaming groups.
+  bool LoadFromCache(const std::string & path);
+
+  // Same as LoadFromCache(), from a mesh packed in memory (see PackMesh() and MeshLoader).
+  bool LoadPacked(const PackedMesh & mesh);
+
+  // Updates 'count' vertices of attribute 'attrib', starting at 'firstVertex'.
+  // 'data' is tightly packed (count * attribute size floats).
+  // Interleave/PositionSplit: scatters data into the staging copy and marks the range as dirty.
+  // Batch: uploads the (contiguous) range right away.
+  bool Update(GLuint attrib, GLuint firstVertex, GLuint count, const GLfloat* data);
+
+  // Uploads all dirty vertex ranges, merged into as few transfers as possible.
+  // It does nothing if there is no pending update (or if the storage is batched).
+  void FlushUpdates();
+
   // Generate buffers on GPU (VAO, VBO, EAB).
-  void AllocateBuffers(const GLfloat* vertices, const GLuint* elements);
+  // 'vertices' must already follow the storage layout and attribute formats of this group.
+  // If 'elements' is nullptr, the group is drawn without an element array.
+  void AllocateBuffers(const void* vertices, const GLuint* elements);
 
   // Destroys buffers on GPU (VAO, VBO, EAB).
   void ClearBuffers();
 
+  // Reads the geometry of this group back: vertices interleaved (in attribute order, whatever
+  // the storage format) in their formats, and the indices of the base level of detail (restart
+  // indices become kPrimitiveRestartIndex; empty if the group isn't indexed). Vertices come from
+  // the staging copy if it is kept; otherwise, and for indices, it stalls until the GPU is done
+  // with the buffers (or arena blocks): meant for static geometry (see StaticBatcher).
+  // Only for non-streaming groups.
+  void ReadBack(std::vector<GLubyte> & vertices, std::vector<GLuint> & indices) const;
+
   // Getters.
   GLuint GetNumVertices() const { return mNumVertices; }
   GLuint GetNumElements() const { return mNumElements; }
   GLuint GetVertexSize() const  { return mVertexSize;  }
+  GLuint GetVertexStride() const { return mVertexStride; }
+  const std::vector<VertexAttrib> & GetVertexAttribList() const { return mVertexAttributeList; }
   GLenum GetDataUsage() const { return mDataUsage; }
   GLenum GetDrawMode()  const { return mDrawMode;  }
+  GLenum GetIndexType() const { return mIndexType; }
+  bool IsIndexed()   const { return mIndexType != GL_NONE; }
+  bool IsStreaming() const { return mNumFrames > 1; }
+  bool IsPrimitiveRestartEnabled() const { return mPrimitiveRestart; }
+  GLuint GetNumDrawRanges() const { return mDrawRanges.size(); }
+  const std::vector<DrawRange> & GetDrawRanges() const { return mDrawRanges; }
+  const VertexCacheStats & GetCacheStatsBefore() const { return mCacheStatsBefore; }
+  const VertexCacheStats & GetCacheStatsAfter()  const { return mCacheStatsAfter;  }
+  const std::vector<GLuint> & GetVertexRemap() const { return mVertexRemap; }  // Loaded -> stored.
+  GLuint GetNumLods()   const { return std::max<GLuint>(mLodLevels.size(), 1); }
+  const std::vector<LodLevel> & GetLodLevels() const { return mLodLevels; }
+  const GLfloat* GetBoundingCenter() const { return mBoundingCenter; }
+  GLfloat GetBoundingRadius() const { return mBoundingRadius; }
+  GLuint GetNumMeshlets() const { return mMeshlets.size(); }
+  MeshArena* GetArena() const { return mArena; }
+  GLuint GetVao(unsigned renderingPass) const { return mVaoList[renderingPass]; }
+  GLuint GetBaseVertex() const;  // First vertex of this group in its vertex buffer.
+  GLuint GetFirstIndex() const;  // First index of this group in its element array.
+  const std::vector<Meshlet> & GetMeshlets() const { return mMeshlets; }
 
   // Setters.
   void SetDrawMode(GLenum drawMode) { mDrawMode = drawMode; }
 
+  // Lets small groups (up to 256 vertices) store GL_UNSIGNED_BYTE indices. Call before Load().
+  void AllowByteIndices(bool allow) { mAllowByteIndices = allow; }
+
 private:
   // Specifies vertex attribute object (how attributes are spatially stored into VBO and
   // mapped to attribute locations on shader).
   void BuildVAO(const std::vector<std::pair<GLint, bool>> & attribList);
 
+  // Adds a rendering pass with a VAO owned by this group (built with BuildVAO()).
+  int AddOwnedRenderingPass(const std::vector<std::pair<GLint, bool>> & attribList);
+
+  // Specifies the attribute pointers of the owned VAOs again (after the layout changed).
+  void RebuildOwnedVaos();
+
+  // Shared VAOs: binding point of attribute 'attrib', its offset within the binding and the
+  // offset of the binding in the vertex buffer (all frames of a binding are contiguous).
+  void GetAttribBinding(GLuint attrib, GLuint & binding, GLuint & relativeOffset,
+                        GLintptr & bindingOffset) const;
+
+  // Binds the VAO of a rendering pass (and the vertex buffers of this group, if it's shared).
+  void BindVertexArray(unsigned renderingPass) const;
+
+  // Draws level of detail 'lod', or the ranges of 'meshlets' if not nullptr (and 'lod' is 0).
+  void Draw(unsigned renderingPass, GLuint lod, const MeshletDrawList* meshlets) const;
+
+  // Computes where each attribute is stored in the vertex buffer (offsets and strides).
+  void ComputeLayout();
+
+  // Converts a raw buffer (floats, arranged by storage format) into the staging copy.
+  // Only streaming groups and non-static interleaved or position-split groups keep it after
+  // uploading (see ReleaseStagingCopy()).
+  void StoreStagingCopy(const GLfloat* vertices);
+  void ReleaseStagingCopy();
+
+  // Allocates the staging copy again if it was released, filled from the vertex buffer if
+  // 'readBack' is true (for updates that don't replace every attribute).
+  void RestoreStagingCopy(bool readBack);
+
+  // Vertex cache optimization: returns the indices to upload (reordered into 'optimized' if
+  // enabled) and moves vertex data to the positions given by the vertex remap table.
+  // 'positions' (may be nullptr) follows the raw float layout, 'positionStride' floats apart.
+  const GLuint* OptimizeIndices(const GLuint* indices, std::vector<GLuint> & optimized,
+                                const GLfloat* positions, GLuint positionStride);
+  const GLfloat* GetRawPositions(const GLfloat* buffer, GLuint & positionStride) const;
+  const GLfloat* GetPackedPositions(const void* vertices, GLuint & positionStride) const;
+
+  // Vertex welding: returns the unique vertices of 'bufferList' (stored in 'welded') and points
+  // 'indices' to the welded element array (in 'weldedIndices'). Updates the vertex count.
+  std::vector<GLfloat*> WeldBufferList(const std::vector<GLfloat*> & bufferList,
+                                       const GLuint* & indices,
+                                       std::vector<std::vector<GLfloat>> & welded,
+                                       std::vector<GLuint> & weldedIndices);
+
+  // Splits a raw buffer (floats, arranged by storage format) into one array per attribute.
+  std::vector<GLfloat*> SplitRawBuffer(const GLfloat* buffer,
+                                       std::vector<std::vector<GLfloat>> & attribData) const;
+
+  // Bounding sphere of the loaded positions (used to select levels of detail).
+  void ComputeBoundingSphere(const GLfloat* positions, GLuint positionStride);
+
+  // Number of indices stored in the element array (all levels of detail).
+  GLuint GetNumStoredIndices() const;
+  std::vector<GLfloat*> RemapBufferList(const std::vector<GLfloat*> & bufferList,
+                                        std::vector<std::vector<GLfloat>> & remapped) const;
+  void RemapStagingCopy();
+
+  // Copies packed vertices into the staging copy (as they are).
+  void StorePackedStagingCopy(const void* vertices);
+
+  // Uploads the whole staging copy after it was replaced by Update().
+  void UploadStagingCopy();
+
+  // Loads the sections of a cache (mapped or in memory, see LoadFromCache()).
+  bool LoadSections(const MeshCacheHeader & header, const std::vector<VertexAttrib> & attribList,
+                    const LodLevel* lodLevels, const void* vertices, const void* indices);
+
+  // Enables/disables primitive restart around draw calls (if enabled for this group).
+  void BeginPrimitiveRestart() const;
+  void EndPrimitiveRestart() const;
+
+  // Streaming: protects the region drawn by the last call until the GPU is done reading it.
+  void FenceCurrentFrame() const;
+
+  // Adds vertices [firstVertex, firstVertex+count) to the list of ranges to be uploaded.
+  void MarkDirty(GLuint firstVertex, GLuint count);
+
+  // Arena: allocates (or reallocates) the blocks of this group and uploads its data.
+  void AllocateArenaBlocks(const void* vertices, const GLuint* elements);
+
+  // Streaming: allocates the ring buffer, waits until the GPU is done with a frame region,
+  // writes the staging copy into the next region and writes 'size' bytes into the buffer.
+  void AllocateStreamingStorage();
+  void WaitForFrame(GLuint frame);
+  void PublishStagingCopy();
+  void CopyStagingToFrame(GLuint frame);
+  void WriteStreamingRange(GLintptr offset, GLsizeiptr size, const void* data);
+
+  // Exchanges every member (and so the OpenGL objects) with 'other'.
+  void Swap(MeshGroup<F> & other);
+
   /* Attributes */
 
   // OpenGL buffer IDs.
   GLuint mEab { 0 };  // Element array buffer.
   GLuint mVbo { 0 };  // Vertex buffer object.
   std::vector<GLuint> mVaoList;  // Verter array object list.
+  std::vector<bool> mSharedVaos;  // Whether each VAO belongs to the VertexArrayCache.
+  std::vector<std::vector<std::pair<GLint, bool>>> mPassAttribLists;  // Attributes of each VAO.
 
   // Mesh attributes.
   GLenum mDrawMode;     // How mesh is rendered (drawing mode).
@@ -165,14 +591,75 @@ private:
   GLuint mNumVertices;  // Number of vertices in this group.
   GLuint mNumElements;  // Number of elements (indices of vertex).
 
-  GLuint mVertexSize    { 0 };  // Number of floating points stored per vertex.
+  GLenum mIndexType { GL_NONE };       // Type of stored indices (GL_NONE if not indexed).
+  bool mAllowByteIndices { false };    // Whether GL_UNSIGNED_BYTE may be selected.
+  bool mPrimitiveRestart { false };    // Whether index streams contain restart indices.
+
+  // Draw ranges (see [Draw ranges]).
+  std::vector<DrawRange> mDrawRanges;
+
+  GLuint mVertexSize    { 0 };  // Number of floating points provided per vertex.
+  GLuint mVertexStride  { 0 };  // Number of bytes stored per vertex.
   GLuint mNumAttributes { 0 };  // Number of attributes.
 
   // Vertex attributes descriptor -> specifies which attributes a vertex contain and also
-  // their dimensionality and order. This is constant within the lifetime of a MeshGroup.
-  std::vector<GLuint> mVertexAttributeList;
+  // their dimensionality, format and order. This is constant within the lifetime of a MeshGroup.
+  std::vector<VertexAttrib> mVertexAttributeList;
+
+  // Byte offset of each attribute in the buffer (first vertex) and byte distance between
+  // two consecutive vertices of that attribute.
+  std::vector<GLuint> mAttribOffsets;
+  std::vector<GLuint> mAttribStrides;
+
+  // CPU copy of the vertex buffer and the vertex ranges [first, end) that differ from the GPU.
+  std::vector<GLubyte> mStagingBuffer;
+  std::vector<std::pair<GLuint, GLuint>> mDirtyRanges;
+
+  // Vertex cache optimization: cache size (0 if disabled), vertex remap table (old -> new,
+  // empty if vertices weren't reordered) and cache statistics of the loaded indices.
+  GLuint mVertexCacheSize { 0 };
+  GLuint mPositionAttrib { 0 };
+  GLfloat mOverdrawThreshold { 0.0f };  // 0 if the overdraw optimization is disabled.
+  bool mWeldingEnabled { false };
+  GLfloat mWeldEpsilon { 0.0f };        // Position grid of vertex welding (0 = exact).
+  std::vector<GLuint> mVertexRemap;
+  VertexCacheStats mCacheStatsBefore;
+  VertexCacheStats mCacheStatsAfter;
+
+  // Levels of detail: target errors for generation, levels stored in the element array
+  // (empty if there is a single level) and bounding sphere.
+  std::vector<GLfloat> mLodTargetErrors;
+  std::vector<LodLevel> mLodLevels;
+  GLfloat mBoundingCenter[3] { 0.0f, 0.0f, 0.0f };
+  GLfloat mBoundingRadius { 0.0f };
+
+  // Meshlets of the first level of detail.
+  bool mMeshletsEnabled { false };
+  std::vector<Meshlet> mMeshlets;
+
+  // Shared buffers: arena (nullptr if this group owns its buffers) and block handles.
+  MeshArena* mArena { nullptr };
+  GLuint mVertexBlock { kInvalidArenaBlock };
+  GLuint mIndexBlock  { kInvalidArenaBlock };
+
+  // Instancing: per-instance data buffer and number of instances stored.
+  GLuint mInstanceVbo { 0 };
+  GLuint mNumInstances { 0 };
+
+  std::string mDebugName { "MeshGroup" };  // See gpu_memory.h.
+
+  // Streaming ring buffer: number of frame regions, region drawn by Render(), persistent
+  // mapping (nullptr if unavailable) and one fence per region.
+  GLuint mNumFrames    { 1 };
+  GLuint mCurrentFrame { 0 };
+  GLubyte* mMappedBuffer { nullptr };
+  bool mStreamingStorageReady { false };
+  mutable std::vector<GLsync> mFences;
 };
 
+template <StorageFormat F>
+using MeshHandle = Handle<MeshGroup<F>>;
+
 // ============================================================================================ //
 // Implementation of template functions.
 
@@ -194,154 +681,1627 @@ MeshGroup<F>::~MeshGroup()
   MeshGroup<F>::ClearBuffers();
 }
 
-/* Rendering method */
+/* Move */
 template <StorageFormat F>
-void MeshGroup<F>::Render(unsigned renderingPass) const
+MeshGroup<F>::MeshGroup(MeshGroup<F> && other)
+: MeshGroup<F>(0, 0, other.mDrawMode, other.mDataUsage)
 {
-  assert((renderingPass >= 0) && (renderingPass < mVaoList.size()));
-
-  const int option = renderingPass;
-  
-  glBindVertexArray(mVaoList[option]);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mEab);
-
-  glDrawElements(
-    mDrawMode,         // mode (GL_LINES, GL_TRIANGLES, ...)
-    mNumElements,      // number of vertices.
-    GL_UNSIGNED_INT,   // type.
-    (void*)0           // element array buffer offset.
-   );
+  MeshGroup<F>::Swap(other);
 }
 
 template <StorageFormat F>
-void MeshGroup<F>::SetVertexAttribList(std::initializer_list<GLuint> vertexAttribList)
+MeshGroup<F> & MeshGroup<F>::operator=(MeshGroup<F> && other)
 {
-  mVertexAttributeList = std::vector<GLuint>(vertexAttribList);
+  MeshGroup<F> moved(std::move(other));  // Leaves 'other' empty.
+  MeshGroup<F>::Swap(moved);             // The previous contents are released with 'moved'.
+  return *this;
+}
 
-  mVertexSize = 0;
-  mNumAttributes = 0;
-  for (GLuint attribSize : mVertexAttributeList) 
-  {
-    mVertexSize += attribSize;
-    mNumAttributes++;
-  }
+/* Rendering method */
+template <StorageFormat F>
+void MeshGroup<F>::Render(unsigned renderingPass, GLuint lod) const
+{
+  MeshGroup<F>::Draw(renderingPass, lod, nullptr);
+}
 
-  // Generate geometry buffers.
-  glGenBuffers(1, &mVbo);       // Vertex buffer object.
-  glGenBuffers(1, &mEab);       // Element array buffer.
+template <StorageFormat F>
+void MeshGroup<F>::Render(const MeshletDrawList & drawList, unsigned renderingPass,
+                          GLuint lod) const
+{
+  MeshGroup<F>::Draw(renderingPass, lod, &drawList);
 }
 
 template <StorageFormat F>
-int MeshGroup<F>::AddRenderingPass(const std::vector<std::pair<GLint, bool>> & attribList)
+void MeshGroup<F>::Draw(unsigned renderingPass, GLuint lod, const MeshletDrawList* meshlets) const
 {
-  assert(attribList.size() == mNumAttributes);
+  assert((renderingPass >= 0) && (renderingPass < mVaoList.size()));
+  assert(lod < MeshGroup<F>::GetNumLods());
 
-  GLuint vao = 0;
-  glGenVertexArrays(1, &vao);
+  MeshGroup<F>::BindVertexArray(renderingPass);
 
-  glBindVertexArray(vao);
-  glBindBuffer(GL_ARRAY_BUFFER, mVbo);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mEab);
-  
-  MeshGroup<F>::BuildVAO(attribList);
+  // The element array may have been created (or reallocated) after this VAO.
+  if (mIndexType != GL_NONE && !mArena)
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mEab);
 
-  for (int i = 0; i < mNumAttributes; i++)
+  // Range of the element array of the level of detail.
+  GLsizei count = mNumElements;
+  GLuint firstIndex = MeshGroup<F>::GetFirstIndex();
+  if (!mLodLevels.empty())
   {
-    const GLuint attribLoc = attribList[i].first;
-    const bool active = attribList[i].second;
+    const LodLevel & level = mLodLevels[lod];
+    count = level.mNumIndices;
+    firstIndex += level.mFirstIndex;
+  }
 
-    // If the attribute is active...
-    if (active)
+  const GLvoid* offset = (void*)(GLintptr)(firstIndex * GetIndexBytes(mIndexType));
+
+  // Visible meshlets of the first level (see CullMeshlets()).
+  const bool drawMeshlets = meshlets && !mMeshlets.empty() && lod == 0;
+
+  MeshGroup<F>::BeginPrimitiveRestart();
+
+  if (mNumFrames > 1)  // Streaming: draw the last written frame region.
+  {
+    const GLint baseVertex = mCurrentFrame * mNumVertices;
+
+    if (drawMeshlets)
     {
-      glEnableVertexAttribArray(attribLoc);
+      std::vector<GLint> baseVertices(meshlets->mCounts.size(), baseVertex);
+      glMultiDrawElementsBaseVertex(mDrawMode, meshlets->mCounts.data(), mIndexType,
+                                    meshlets->mOffsets.data(), meshlets->mCounts.size(),
+                                    baseVertices.data());
     }
-    else if (attribLoc != -1)
+    else if (mIndexType != GL_NONE)
+      glDrawElementsBaseVertex(mDrawMode, count, mIndexType, offset, baseVertex);
+    else
+      glDrawArrays(mDrawMode, baseVertex, mNumElements);
+
+    MeshGroup<F>::FenceCurrentFrame();
+  }
+  else if (mArena)  // Shared buffers: the block starts at (base vertex, first index).
+  {
+    const GLint baseVertex = MeshGroup<F>::GetBaseVertex();
+
+    if (drawMeshlets)
     {
-      glDisableVertexAttribArray(attribLoc);
+      std::vector<GLint> baseVertices(meshlets->mCounts.size(), baseVertex);
+      std::vector<const GLvoid*> offsets(meshlets->mOffsets);
+      for (const GLvoid* & meshletOffset : offsets)
+        meshletOffset = (const GLubyte*)meshletOffset + (GLintptr)offset;
+
+      glMultiDrawElementsBaseVertex(mDrawMode, meshlets->mCounts.data(), mIndexType,
+                                    offsets.data(), meshlets->mCounts.size(),
+                                    baseVertices.data());
     }
+    else if (mIndexType != GL_NONE)
+      glDrawElementsBaseVertex(mDrawMode, count, mIndexType, offset, baseVertex);
+    else
+      glDrawArrays(mDrawMode, baseVertex, mNumElements);
+  }
+  else if (drawMeshlets)
+  {
+    glMultiDrawElements(mDrawMode, meshlets->mCounts.data(), mIndexType,
+                        meshlets->mOffsets.data(), meshlets->mCounts.size());
+  }
+  else if (mIndexType != GL_NONE)
+  {
+    glDrawElements(
+      mDrawMode,         // mode (GL_LINES, GL_TRIANGLES, ...)
+      count,             // number of vertices.
+      mIndexType,        // type.
+      offset             // element array buffer offset.
+     );
+  }
+  else  // No element array: draw vertices in order.
+  {
+    glDrawArrays(mDrawMode, 0, mNumElements);
   }
 
-  mVaoList.push_back(vao);
+  MeshGroup<F>::EndPrimitiveRestart();
+}
 
-  return mVaoList.size()-1;
+template <StorageFormat F>
+void MeshGroup<F>::RenderRange(unsigned drawRange, unsigned renderingPass) const
+{
+  assert(drawRange < mDrawRanges.size() && renderingPass < mVaoList.size());
+
+  const DrawRange & range = mDrawRanges[drawRange];
+
+  MeshGroup<F>::BindVertexArray(renderingPass);
+
+  if (mIndexType != GL_NONE && !mArena)
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mEab);
+
+  // The range is relative to the storage of the group (arena block, streaming frame region).
+  const GLint baseVertex = range.mBaseVertex + MeshGroup<F>::GetBaseVertex() 
+                         + mCurrentFrame * mNumVertices;
+  const GLuint firstIndex = MeshGroup<F>::GetFirstIndex() + range.mFirstIndex;
+  const GLvoid* offset = (void*)(GLintptr)(firstIndex * GetIndexBytes(mIndexType));
+
+  MeshGroup<F>::BeginPrimitiveRestart();
+
+  if (mIndexType == GL_NONE)
+  {
+    glDrawArrays(mDrawMode, baseVertex + range.mFirstIndex, range.mNumIndices);
+  }
+  else if (baseVertex != 0)
+  {
+    glDrawElementsBaseVertex(mDrawMode, range.mNumIndices, mIndexType, offset, baseVertex);
+  }
+  else
+  {
+    glDrawElements(mDrawMode, range.mNumIndices, mIndexType, offset);
+  }
+
+  MeshGroup<F>::EndPrimitiveRestart();
+
+  if (mNumFrames > 1)
+    MeshGroup<F>::FenceCurrentFrame();
 }
 
-/* Generate buffers */
 template <StorageFormat F>
-void MeshGroup<F>::AllocateBuffers(const GLfloat* vertices, const GLuint* elements)
-{  
-  // Allocate buffer for elements (EAB).
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mEab);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, mNumElements * sizeof(GLuint),
-               elements, GL_STATIC_DRAW);
+void MeshGroup<F>::BeginPrimitiveRestart() const
+{
+  if (mPrimitiveRestart && mIndexType != GL_NONE)
+  {
+    glEnable(GL_PRIMITIVE_RESTART);
+    glPrimitiveRestartIndex(GetRestartIndex(mIndexType));
+  }
+}
 
-  // Allocate buffer for vertices (VBO).
-  glBindBuffer(GL_ARRAY_BUFFER, mVbo);
-  glBufferData(GL_ARRAY_BUFFER, mVertexSize * mNumVertices * sizeof(GLfloat),
-               vertices, mDataUsage);
+template <StorageFormat F>
+void MeshGroup<F>::EndPrimitiveRestart() const
+{
+  if (mPrimitiveRestart && mIndexType != GL_NONE)
+    glDisable(GL_PRIMITIVE_RESTART);
 }
 
-/* Delete buffers */
 template <StorageFormat F>
-void MeshGroup<F>::ClearBuffers()
+void MeshGroup<F>::FenceCurrentFrame() const
 {
-  glDeleteBuffers(1, &mVbo);
-  glDeleteBuffers(1, &mEab);
-  glDeleteVertexArrays(mVaoList.size(), mVaoList.data());
+  GLsync & fence = mFences[mCurrentFrame];
+  if (fence)
+  {
+    glDeleteSync(fence);
+  }
+  fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
 }
 
 template <StorageFormat F>
-bool MeshGroup<F>::Load(const GLfloat* buffer, const GLuint* indices)
+int MeshGroup<F>::AddInstancedRenderingPass(const std::vector<std::pair<GLint, bool>> & attribList,
+                                            GLint instanceAttribLoc)
+{
+  // Instanced VAOs belong to the group (arena VAOs are shared by groups).
+  assert(!mArena && instanceAttribLoc >= 0);
+
+  // The instance attributes are part of the VAO, so it can't be shared.
+  const int pass = MeshGroup<F>::AddOwnedRenderingPass(attribList);
+
+  if (!mInstanceVbo)
+    glGenBuffers(1, &mInstanceVbo);
+
+  glBindVertexArray(mVaoList[pass]);
+  glBindBuffer(GL_ARRAY_BUFFER, mInstanceVbo);
+
+  const GLsizei stride = sizeof(InstanceData);
+  const GLuint modelLoc    = instanceAttribLoc;
+  const GLuint normalLoc   = instanceAttribLoc + 4;
+  const GLuint materialLoc = instanceAttribLoc + 7;
+
+  // Matrices take one location per column.
+  for (GLuint c = 0; c < 4; c++)
+  {
+    const GLintptr offset = offsetof(InstanceData, mModel) + 4 * c * sizeof(GLfloat);
+    glVertexAttribPointer(modelLoc + c, 4, GL_FLOAT, GL_FALSE, stride, (void*)offset);
+    glVertexAttribDivisor(modelLoc + c, 1);
+    glEnableVertexAttribArray(modelLoc + c);
+  }
+
+  for (GLuint c = 0; c < 3; c++)
+  {
+    const GLintptr offset = offsetof(InstanceData, mNormal) + 3 * c * sizeof(GLfloat);
+    glVertexAttribPointer(normalLoc + c, 3, GL_FLOAT, GL_FALSE, stride, (void*)offset);
+    glVertexAttribDivisor(normalLoc + c, 1);
+    glEnableVertexAttribArray(normalLoc + c);
+  }
+
+  glVertexAttribIPointer(materialLoc, 1, GL_UNSIGNED_INT, stride, 
+                         (void*)offsetof(InstanceData, mMaterial));
+  glVertexAttribDivisor(materialLoc, 1);
+  glEnableVertexAttribArray(materialLoc);
+
+  return pass;
+}
+
+template <StorageFormat F>
+void MeshGroup<F>::UpdateInstances(const InstanceData* instances, GLuint numInstances)
+{
+  assert(mInstanceVbo);
+
+  // Orphan the previous contents (they are usually still being read by the GPU).
+  glBindBuffer(GL_ARRAY_BUFFER, mInstanceVbo);
+  glBufferData(GL_ARRAY_BUFFER, numInstances * sizeof(InstanceData), instances, GL_STREAM_DRAW);
+  GpuMemory::TrackBuffer(mInstanceVbo, numInstances * sizeof(InstanceData), kGpuInstanceBuffer,
+                         mDebugName);
+
+  mNumInstances = numInstances;
+}
+
+template <StorageFormat F>
+void MeshGroup<F>::RenderInstanced(unsigned renderingPass, GLuint lod) const
 {
-  // Reserve vertex buffer and initialize element array (indices array).
-  if (indices)  // Element array provided.
+  assert(renderingPass < mVaoList.size());
+  assert(lod < MeshGroup<F>::GetNumLods());
+
+  if (mNumInstances == 0)
+    return;
+
+  MeshGroup<F>::BindVertexArray(renderingPass);
+
+  if (mIndexType != GL_NONE)
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mEab);
+
+  // Range of the element array of the level of detail.
+  GLsizei count = mNumElements;
+  GLuint firstIndex = 0;
+  if (!mLodLevels.empty())
+  {
+    count = mLodLevels[lod].mNumIndices;
+    firstIndex = mLodLevels[lod].mFirstIndex;
+  }
+
+  const GLvoid* offset = (void*)(GLintptr)(firstIndex * GetIndexBytes(mIndexType));
+  const GLint baseVertex = mCurrentFrame * mNumVertices;  // Streaming: last written region.
+
+  MeshGroup<F>::BeginPrimitiveRestart();
+
+  if (mIndexType == GL_NONE)
+  {
+    glDrawArraysInstanced(mDrawMode, baseVertex, mNumElements, mNumInstances);
+  }
+  else if (baseVertex != 0)
   {
-    MeshGroup<F>::AllocateBuffers(buffer, indices);
+    glDrawElementsInstancedBaseVertex(mDrawMode, count, mIndexType, offset, mNumInstances, 
+                                      baseVertex);
   }
-  else  // Element array wasn't provided -- build it up.
+  else
   {
-    std::vector<GLuint> elementsBuffer(mNumElements);
+    glDrawElementsInstanced(mDrawMode, count, mIndexType, offset, mNumInstances);
+  }
+
+  MeshGroup<F>::EndPrimitiveRestart();
+
+  if (mNumFrames > 1)
+    MeshGroup<F>::FenceCurrentFrame();
+}
+
+template <StorageFormat F>
+void MeshGroup<F>::SetVertexAttribList(std::initializer_list<VertexAttrib> vertexAttribList)
+{
+  MeshGroup<F>::SetVertexAttribList(std::vector<VertexAttrib>(vertexAttribList));
+}
 
-    for (int i = 0; i < mNumElements; i++)
-      elementsBuffer[i] = i;
+template <StorageFormat F>
+void MeshGroup<F>::SetVertexAttribList(const std::vector<VertexAttrib> & vertexAttribList)
+{
+  mVertexAttributeList = vertexAttribList;
 
-    MeshGroup<F>::AllocateBuffers(buffer, elementsBuffer.data());
+  mVertexSize = 0;
+  mVertexStride = 0;
+  mNumAttributes = 0;
+  for (const VertexAttrib & attrib : mVertexAttributeList) 
+  {
+    mVertexSize += attrib.mSize;
+    mVertexStride += GetAttribBytes(attrib);
+    mNumAttributes++;
   }
+
+  MeshGroup<F>::ComputeLayout();
+
+  // Generate geometry buffers (the element array buffer is only created if indices are loaded).
+  glGenBuffers(1, &mVbo);       // Vertex buffer object.
 }
 
 template <StorageFormat F>
-bool MeshGroup<F>::Update(const GLfloat* buffer)
+void MeshGroup<F>::SetDebugName(const std::string & name)
 {
-  glBindBuffer(GL_ARRAY_BUFFER, mVbo);
-  glBufferSubData(GL_ARRAY_BUFFER, 0, mVertexSize * mNumVertices * sizeof(GLfloat), buffer);
+  mDebugName = name;
+  GpuMemory::Rename(kGpuBufferObject, mVbo, name);
+  GpuMemory::Rename(kGpuBufferObject, mEab, name);
+  GpuMemory::Rename(kGpuBufferObject, mInstanceVbo, name);
 }
 
-// ============================================================================================= //
-// Specializations for different StorageFormats.
+template <StorageFormat F>
+void MeshGroup<F>::EnableStreaming(GLuint numFrames)
+{
+  // The VAO layout depends on the number of frames.
+  assert(mVaoList.empty());
 
-// ================ Batched Storage =================== //
+  mNumFrames = std::max(numFrames, 1u);
+  mFences.assign(mNumFrames, nullptr);
+}
 
-template <>
-bool MeshGroup<Batch>::Load(const std::vector<GLfloat*> & bufferList, const GLuint* indices);
+template <StorageFormat F>
+void MeshGroup<F>::EnableVertexCacheOptimization(GLuint cacheSize)
+{
+  mVertexCacheSize = cacheSize;
+}
 
-template <>
-bool MeshGroup<Batch>::Update(const std::vector<GLfloat*> & bufferList);
+template <StorageFormat F>
+void MeshGroup<F>::EnableOverdrawOptimization(GLuint positionAttrib, GLfloat threshold)
+{
+  assert(positionAttrib < mNumAttributes);
+  assert(mVertexAttributeList[positionAttrib].mSize >= 3);
 
+  // Clusters are cut from the cache-optimized order.
+  if (mVertexCacheSize == 0)
+    mVertexCacheSize = kDefaultVertexCacheSize;
 
-template <>
-void MeshGroup<Batch>::BuildVAO(const std::vector<std::pair<GLint, bool>> & attribList);
+  mPositionAttrib = positionAttrib;
+  mOverdrawThreshold = threshold;
+}
 
-// ================ Interleaved Storage ==================== //
+template <StorageFormat F>
+void MeshGroup<F>::EnableVertexWelding(GLfloat positionEpsilon, GLuint positionAttrib)
+{
+  assert(positionAttrib < mNumAttributes);
+  assert(positionEpsilon >= 0.0f);
 
-template <>
-bool MeshGroup<Interleave>::Load(const std::vector<GLfloat*> & bufferList, const GLuint* indices);
+  mWeldingEnabled = true;
+  mWeldEpsilon = positionEpsilon;
+  mPositionAttrib = positionAttrib;
+}
 
-template <>
-bool MeshGroup<Interleave>::Update(const std::vector<GLfloat*> & bufferList);
+template <StorageFormat F>
+void MeshGroup<F>::EnableLodGeneration(const std::vector<GLfloat> & targetErrors, 
+                                       GLuint positionAttrib)
+{
+  assert(positionAttrib < mNumAttributes);
+  assert(mVertexAttributeList[positionAttrib].mSize >= 3);
+
+  mLodTargetErrors = targetErrors;
+  mPositionAttrib = positionAttrib;
+}
 
+template <StorageFormat F>
+bool MeshGroup<F>::AddLod(const std::vector<GLuint> & indices, GLfloat error)
+{
+  // Levels of detail are ranges of the element array.
+  if (mIndexType == GL_NONE || indices.empty())
+    return false;
 
-template <>
-void MeshGroup<Interleave>::BuildVAO(const std::vector<std::pair<GLint, bool>> & attribList);
+  if (mLodLevels.empty())
+    mLodLevels.push_back({0, mNumElements, 0.0f});
+
+  std::vector<GLuint> level(indices);
+  if (!mVertexRemap.empty())  // Vertices were reordered by Load().
+  {
+    for (GLuint & index : level)
+      index = mVertexRemap[index];
+  }
+
+  if (mVertexCacheSize > 0 && mDrawMode == GL_TRIANGLES)
+    OptimizeVertexCache(level.data(), level.size(), mNumVertices, mVertexCacheSize);
+
+  const GLuint numStored = MeshGroup<F>::GetNumStoredIndices();
+
+  if (mArena)  // Move the index block to a larger one (it keeps the current levels).
+  {
+    mIndexBlock = mArena->ReallocateIndices(mIndexBlock, numStored + level.size());
+    mArena->UploadIndices(mIndexBlock, numStored, level.size(), level.data());
+    mLodLevels.push_back({numStored, static_cast<GLuint>(level.size()), error});
+    return true;
+  }
+
+  // Reallocate the element array and copy the current levels on the GPU.
+  const GLuint indexBytes = GetIndexBytes(mIndexType);
+  const GLsizeiptr oldSize = numStored * indexBytes;
+  const GLsizeiptr newSize = oldSize + level.size() * indexBytes;
+
+  GLuint eab = 0;
+  glGenBuffers(1, &eab);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, eab);
+  glBufferData(GL_COPY_WRITE_BUFFER, newSize, nullptr, GL_STATIC_DRAW);
+
+  glBindBuffer(GL_COPY_READ_BUFFER, mEab);
+  glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldSize);
+
+  std::vector<GLubyte> packed(level.size() * indexBytes);
+  PackIndices(mIndexType, level.data(), level.size(), packed.data());
+  glBufferSubData(GL_COPY_WRITE_BUFFER, oldSize, packed.size(), packed.data());
+
+  GpuMemory::ReleaseBuffer(mEab);
+  GpuMemory::TrackBuffer(eab, newSize, kGpuIndexBuffer, mDebugName);
+  glDeleteBuffers(1, &mEab);
+  mEab = eab;
+
+  mLodLevels.push_back({static_cast<GLuint>(oldSize / indexBytes), 
+                        static_cast<GLuint>(level.size()), error});
+  return true;
+}
+
+template <StorageFormat F>
+GLuint MeshGroup<F>::SelectLod(GLfloat pixelsPerUnit, GLuint currentLod,
+                               GLfloat maxPixelError) const
+{
+  if (mLodLevels.size() < 2)
+    return 0;
+
+  // Coarsest level whose error, projected on screen, is tolerable.
+  GLuint lod = 0;
+  while (lod + 1 < mLodLevels.size() && mLodLevels[lod+1].mError * pixelsPerUnit <= maxPixelError)
+    lod++;
+
+  // Refine right away, but only coarsen to levels that are clearly below the tolerance.
+  if (lod > currentLod)
+  {
+    const GLfloat tolerance = (1.0f - kLodHysteresis) * maxPixelError;
+
+    lod = currentLod;
+    while (lod + 1 < mLodLevels.size() && mLodLevels[lod+1].mError * pixelsPerUnit <= tolerance)
+      lod++;
+  }
+
+  return lod;
+}
+
+template <StorageFormat F>
+void MeshGroup<F>::EnableMeshlets(GLuint positionAttrib)
+{
+  assert(positionAttrib < mNumAttributes);
+  assert(mVertexAttributeList[positionAttrib].mSize >= 3);
+
+  mMeshletsEnabled = true;
+  mPositionAttrib = positionAttrib;
+}
+
+template <StorageFormat F>
+GLuint MeshGroup<F>::CullMeshlets(const GLfloat* modelViewProj, const GLfloat* eye,
+                                  MeshletDrawList & drawList) const
+{
+  std::vector<GLsizei> & counts = drawList.mCounts;
+  std::vector<const GLvoid*> & offsets = drawList.mOffsets;
+  counts.clear();
+  offsets.clear();
+
+  GLfloat planes[6][4];
+  ExtractFrustumPlanes(modelViewProj, planes);
+
+  const GLuint indexBytes = GetIndexBytes(mIndexType);
+  GLuint numTriangles = 0;
+  GLuint end = 0;  // End of the last range (in indices).
+
+  for (const Meshlet & meshlet : mMeshlets)
+  {
+    if (!IsMeshletVisible(meshlet, planes, eye))
+      continue;
+
+    if (!counts.empty() && end == meshlet.mFirstIndex)  // Extend the last range.
+    {
+      counts.back() += meshlet.mNumIndices;
+    }
+    else
+    {
+      counts.push_back(meshlet.mNumIndices);
+      offsets.push_back((void*)(GLintptr)(meshlet.mFirstIndex * indexBytes));
+    }
+
+    end = meshlet.mFirstIndex + meshlet.mNumIndices;
+    numTriangles += meshlet.mNumIndices / 3;
+  }
+
+  return numTriangles;
+}
+
+template <StorageFormat F>
+void MeshGroup<F>::SetArena(MeshArena* arena)
+{
+  assert(F == Interleave && mNumFrames == 1 && mVaoList.empty());
+  assert(arena->GetVertexStride() == mVertexStride);
+  assert(arena->GetVertexAttribList().size() == mNumAttributes);
+
+  // The arena buffers replace the ones of this group.
+  GpuMemory::ReleaseBuffer(mVbo);
+  glDeleteBuffers(1, &mVbo);
+  mVbo = 0;
+  mArena = arena;
+}
+
+template <StorageFormat F>
+GLuint MeshGroup<F>::GetBaseVertex() const
+{
+  return mArena ? mArena->GetBlockOffset(mVertexBlock) : 0;
+}
+
+template <StorageFormat F>
+GLuint MeshGroup<F>::GetFirstIndex() const
+{
+  return (mArena && mIndexBlock != kInvalidArenaBlock) ? mArena->GetBlockOffset(mIndexBlock) : 0;
+}
+
+template <StorageFormat F>
+void MeshGroup<F>::ReadBack(std::vector<GLubyte> & vertices, std::vector<GLuint> & indices) const
+{
+  assert(mNumFrames == 1);
+
+  // The staging copy (if kept) matches the vertex buffer: read it instead of stalling.
+  std::vector<GLubyte> stored;
+  const GLubyte* source = mStagingBuffer.data();
+  if (mStagingBuffer.empty())
+  {
+    // GL_COPY_READ_BUFFER: reading must not change the element array of the bound VAO.
+    stored.resize(mNumVertices * mVertexStride);
+    glBindBuffer(GL_COPY_READ_BUFFER, mArena ? mArena->GetVertexBuffer() : mVbo);
+    glGetBufferSubData(GL_COPY_READ_BUFFER, MeshGroup<F>::GetBaseVertex() * mVertexStride,
+                       stored.size(), stored.data());
+    source = stored.data();
+  }
+
+  // Storage layout -> (A0 B0 C0) (A1 B1 C1) ... (batched/split groups are de-interleaved).
+  vertices.resize(mNumVertices * mVertexStride);
+  GLuint offset = 0;
+  for (GLuint j = 0; j < mNumAttributes; j++)
+  {
+    const GLuint bytes = GetAttribBytes(mVertexAttributeList[j]);
+    for (GLuint v = 0; v < mNumVertices; v++)
+    {
+      const GLubyte* src = source + mAttribOffsets[j] + v * mAttribStrides[j];
+      std::copy(src, src + bytes, &vertices[v * mVertexStride + offset]);
+    }
+    offset += bytes;
+  }
+
+  indices.clear();
+  if (mIndexType != GL_NONE)
+  {
+    const GLuint indexBytes = GetIndexBytes(mIndexType);
+    std::vector<GLubyte> storedIndices(mNumElements * indexBytes);
+    glBindBuffer(GL_COPY_READ_BUFFER, mArena ? mArena->GetIndexBuffer() : mEab);
+    glGetBufferSubData(GL_COPY_READ_BUFFER, MeshGroup<F>::GetFirstIndex() * indexBytes,
+                       storedIndices.size(), storedIndices.data());
+
+    indices.resize(mNumElements);
+    UnpackIndices(mIndexType, storedIndices.data(), mNumElements, indices.data(),
+                  mPrimitiveRestart);
+  }
+
+  glBindBuffer(GL_COPY_READ_BUFFER, 0);
+}
+
+template <StorageFormat F>
+int MeshGroup<F>::AddDrawRange(GLuint firstIndex, GLuint numIndices, GLint baseVertex)
+{
+  assert(firstIndex + numIndices <= mNumElements);
+
+  mDrawRanges.push_back({firstIndex, numIndices, baseVertex});
+  return mDrawRanges.size()-1;
+}
+
+template <StorageFormat F>
+int MeshGroup<F>::AddRenderingPass(const std::vector<std::pair<GLint, bool>> & attribList)
+{
+  assert(attribList.size() == mNumAttributes);
+
+  if (mArena)  // Groups with the same attribute list share the arena VAO.
+  {
+    mVaoList.push_back(mArena->GetVao(mArena->AddRenderingPass(attribList)));
+    mSharedVaos.push_back(false);
+    mPassAttribLists.push_back(attribList);
+    return mVaoList.size()-1;
+  }
+
+  if (!VertexArrayCache::IsSupported())
+    return MeshGroup<F>::AddOwnedRenderingPass(attribList);
+
+  // Groups with the same format share the VAO (buffers are bound when drawing).
+  std::vector<SharedVertexAttrib> attribs;
+  for (GLuint j = 0; j < mNumAttributes; j++)
+  {
+    if (mVertexAttributeList[j].mSize > 0 && attribList[j].second)
+    {
+      GLuint binding = 0, relativeOffset = 0;
+      GLintptr bindingOffset = 0;
+      MeshGroup<F>::GetAttribBinding(j, binding, relativeOffset, bindingOffset);
+      attribs.push_back({ attribList[j].first, binding, relativeOffset,
+                          mVertexAttributeList[j] });
+    }
+  }
+
+  mVaoList.push_back(VertexArrayCache::Acquire(attribs));
+  mSharedVaos.push_back(true);
+  mPassAttribLists.push_back(attribList);
+  return mVaoList.size()-1;
+}
+
+template <StorageFormat F>
+int MeshGroup<F>::AddOwnedRenderingPass(const std::vector<std::pair<GLint, bool>> & attribList)
+{
+  assert(attribList.size() == mNumAttributes && !mArena);
+
+  GLuint vao = 0;
+  glGenVertexArrays(1, &vao);
+
+  glBindVertexArray(vao);
+  glBindBuffer(GL_ARRAY_BUFFER, mVbo);
+
+  if (mEab)
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mEab);
+  
+  MeshGroup<F>::BuildVAO(attribList);
+
+  for (int i = 0; i < mNumAttributes; i++)
+  {
+    const GLuint attribLoc = attribList[i].first;
+    const bool active = attribList[i].second;
+
+    // If the attribute is active...
+    if (active)
+    {
+      glEnableVertexAttribArray(attribLoc);
+    }
+    else if (attribLoc != -1)
+    {
+      glDisableVertexAttribArray(attribLoc);
+    }
+  }
+
+  mVaoList.push_back(vao);
+  mSharedVaos.push_back(false);
+  mPassAttribLists.push_back(attribList);
+
+  return mVaoList.size()-1;
+}
+
+template <StorageFormat F>
+void MeshGroup<F>::RebuildOwnedVaos()
+{
+  // Arena VAOs don't depend on the vertex count of a group, and shared VAOs get their buffer
+  // offsets when they are bound (see BindVertexArray()). Instance attributes are kept.
+  if (mArena)
+    return;
+
+  for (GLuint i = 0; i < mVaoList.size(); i++)
+  {
+    if (mSharedVaos[i])
+      continue;
+
+    glBindVertexArray(mVaoList[i]);
+    glBindBuffer(GL_ARRAY_BUFFER, mVbo);
+    MeshGroup<F>::BuildVAO(mPassAttribLists[i]);
+  }
+
+  glBindVertexArray(0);
+}
+
+template <StorageFormat F>
+void MeshGroup<F>::GetAttribBinding(GLuint attrib, GLuint & binding, GLuint & relativeOffset,
+                                    GLintptr & bindingOffset) const
+{
+  if (F == Interleave)  // (P N T) (P N T) ...: a single binding.
+  {
+    binding = 0;
+    relativeOffset = mAttribOffsets[attrib];
+    bindingOffset = 0;
+  }
+  else if (F == Batch)  // (P P ...) (N N ...) ...: a binding per sub-buffer.
+  {
+    binding = attrib;
+    relativeOffset = 0;
+    bindingOffset = mAttribOffsets[attrib] * mNumFrames;
+  }
+  else  // PositionSplit: (P P ...) (N T) (N T) ...: a binding per stream.
+  {
+    const GLuint streamOffset = (attrib == 0) ? 0 : mAttribStrides[0] * mNumVertices;
+    binding = (attrib == 0) ? 0 : 1;
+    relativeOffset = mAttribOffsets[attrib] - streamOffset;
+    bindingOffset = streamOffset * mNumFrames;
+  }
+}
+
+template <StorageFormat F>
+void MeshGroup<F>::BindVertexArray(unsigned renderingPass) const
+{
+  glBindVertexArray(mVaoList[renderingPass]);
+
+#if defined(GL_VERTEX_ATTRIB_BINDING)
+  if (!mSharedVaos[renderingPass])
+    return;
+
+  // The VAO only describes the format: attach the buffer of this group to every binding.
+  GLuint boundMask = 0;
+  for (GLuint j = 0; j < mNumAttributes; j++)
+  {
+    GLuint binding = 0, relativeOffset = 0;
+    GLintptr bindingOffset = 0;
+    MeshGroup<F>::GetAttribBinding(j, binding, relativeOffset, bindingOffset);
+
+    if (mVertexAttributeList[j].mSize > 0 && !(boundMask & (1u << binding)))
+    {
+      glBindVertexBuffer(binding, mVbo, bindingOffset, mAttribStrides[j]);
+      boundMask |= 1u << binding;
+    }
+  }
+#endif
+}
+
+/* Generate buffers */
+template <StorageFormat F>
+void MeshGroup<F>::AllocateBuffers(const void* vertices, const GLuint* elements)
+{  
+  if (mArena)
+  {
+    MeshGroup<F>::AllocateArenaBlocks(vertices, elements);
+    return;
+  }
+
+  // Allocate buffer for elements (EAB), using the narrowest index type.
+  if (elements)
+  {
+    mIndexType = SelectIndexType(mNumVertices, mAllowByteIndices, mPrimitiveRestart);
+
+    if (!mEab)
+      glGenBuffers(1, &mEab);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mEab);
+
+    // 'elements' holds every level of detail.
+    const GLuint numIndices = MeshGroup<F>::GetNumStoredIndices();
+
+    if (mIndexType == GL_UNSIGNED_INT)
+    {
+      glBufferData(GL_ELEMENT_ARRAY_BUFFER, numIndices * sizeof(GLuint), elements, GL_STATIC_DRAW);
+    }
+    else
+    {
+      std::vector<GLubyte> packed(numIndices * GetIndexBytes(mIndexType));
+      PackIndices(mIndexType, elements, numIndices, packed.data());
+      glBufferData(GL_ELEMENT_ARRAY_BUFFER, packed.size(), packed.data(), GL_STATIC_DRAW);
+    }
+
+    GpuMemory::TrackBuffer(mEab, numIndices * GetIndexBytes(mIndexType), kGpuIndexBuffer,
+                           mDebugName);
+  }
+  else
+  {
+    mIndexType = GL_NONE;
+  }
+
+  // Allocate buffer for vertices (VBO).
+  glBindBuffer(GL_ARRAY_BUFFER, mVbo);
+
+  if (mNumFrames > 1)  // Streaming: allocate the ring buffer and fill the current region.
+  {
+    MeshGroup<F>::AllocateStreamingStorage();
+    MeshGroup<F>::CopyStagingToFrame(mCurrentFrame);
+  }
+  else
+  {
+    glBufferData(GL_ARRAY_BUFFER, mVertexStride * mNumVertices, vertices, mDataUsage);
+    GpuMemory::TrackBuffer(mVbo, mVertexStride * mNumVertices, kGpuVertexBuffer, mDebugName);
+  }
+}
+
+/* Delete buffers */
+template <StorageFormat F>
+void MeshGroup<F>::ClearBuffers()
+{
+  for (GLsync fence : mFences)
+  {
+    if (fence)
+      glDeleteSync(fence);
+  }
+  mFences.assign(mFences.size(), nullptr);
+
+  if (mMappedBuffer)
+  {
+    glBindBuffer(GL_ARRAY_BUFFER, mVbo);
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+    mMappedBuffer = nullptr;
+  }
+
+  if (mArena)  // Blocks go back to the arena, which owns buffers and VAOs.
+  {
+    mArena->Free(mVertexBlock);
+    mArena->Free(mIndexBlock);
+    mVertexBlock = mIndexBlock = kInvalidArenaBlock;
+    mVaoList.clear();
+    mSharedVaos.clear();
+    mPassAttribLists.clear();
+    return;
+  }
+
+  GpuMemory::ReleaseBuffer(mVbo);
+  GpuMemory::ReleaseBuffer(mEab);
+  GpuMemory::ReleaseBuffer(mInstanceVbo);
+
+  glDeleteBuffers(1, &mVbo);
+  glDeleteBuffers(1, &mEab);
+  glDeleteBuffers(1, &mInstanceVbo);
+
+  // Shared VAOs are deleted by the cache, with their last group.
+  for (GLuint i = 0; i < mVaoList.size(); i++)
+  {
+    if (mSharedVaos[i])
+      VertexArrayCache::Release(mVaoList[i]);
+    else
+      glDeleteVertexArrays(1, &mVaoList[i]);
+  }
+
+  mVaoList.clear();
+  mSharedVaos.clear();
+  mPassAttribLists.clear();
+}
+
+template <StorageFormat F>
+void MeshGroup<F>::Swap(MeshGroup<F> & other)
+{
+  std::swap(mEab, other.mEab);
+  std::swap(mVbo, other.mVbo);
+  std::swap(mVaoList, other.mVaoList);
+  std::swap(mSharedVaos, other.mSharedVaos);
+  std::swap(mPassAttribLists, other.mPassAttribLists);
+
+  std::swap(mDrawMode, other.mDrawMode);
+  std::swap(mDataUsage, other.mDataUsage);
+  std::swap(mNumVertices, other.mNumVertices);
+  std::swap(mNumElements, other.mNumElements);
+  std::swap(mIndexType, other.mIndexType);
+  std::swap(mAllowByteIndices, other.mAllowByteIndices);
+  std::swap(mPrimitiveRestart, other.mPrimitiveRestart);
+  std::swap(mDrawRanges, other.mDrawRanges);
+
+  std::swap(mVertexSize, other.mVertexSize);
+  std::swap(mVertexStride, other.mVertexStride);
+  std::swap(mNumAttributes, other.mNumAttributes);
+  std::swap(mVertexAttributeList, other.mVertexAttributeList);
+  std::swap(mAttribOffsets, other.mAttribOffsets);
+  std::swap(mAttribStrides, other.mAttribStrides);
+  std::swap(mStagingBuffer, other.mStagingBuffer);
+  std::swap(mDirtyRanges, other.mDirtyRanges);
+
+  std::swap(mVertexCacheSize, other.mVertexCacheSize);
+  std::swap(mPositionAttrib, other.mPositionAttrib);
+  std::swap(mOverdrawThreshold, other.mOverdrawThreshold);
+  std::swap(mWeldingEnabled, other.mWeldingEnabled);
+  std::swap(mWeldEpsilon, other.mWeldEpsilon);
+  std::swap(mVertexRemap, other.mVertexRemap);
+  std::swap(mCacheStatsBefore, other.mCacheStatsBefore);
+  std::swap(mCacheStatsAfter, other.mCacheStatsAfter);
+
+  std::swap(mLodTargetErrors, other.mLodTargetErrors);
+  std::swap(mLodLevels, other.mLodLevels);
+  std::swap(mBoundingCenter, other.mBoundingCenter);
+  std::swap(mBoundingRadius, other.mBoundingRadius);
+
+  std::swap(mMeshletsEnabled, other.mMeshletsEnabled);
+  std::swap(mMeshlets, other.mMeshlets);
+
+  std::swap(mArena, other.mArena);
+  std::swap(mVertexBlock, other.mVertexBlock);
+  std::swap(mIndexBlock, other.mIndexBlock);
+
+  std::swap(mInstanceVbo, other.mInstanceVbo);
+  std::swap(mNumInstances, other.mNumInstances);
+  std::swap(mDebugName, other.mDebugName);
+
+  std::swap(mNumFrames, other.mNumFrames);
+  std::swap(mCurrentFrame, other.mCurrentFrame);
+  std::swap(mMappedBuffer, other.mMappedBuffer);
+  std::swap(mStreamingStorageReady, other.mStreamingStorageReady);
+  std::swap(mFences, other.mFences);
+}
+
+template <StorageFormat F>
+void MeshGroup<F>::AllocateArenaBlocks(const void* vertices, const GLuint* elements)
+{
+  mArena->Free(mVertexBlock);
+  mArena->Free(mIndexBlock);
+  mIndexBlock = kInvalidArenaBlock;
+
+  mVertexBlock = mArena->AllocateVertices(mNumVertices);
+  mArena->UploadVertices(mVertexBlock, 0, mNumVertices, vertices);
+
+  // Indices are relative to the base vertex, so they must fit in the arena index type.
+  mIndexType = GL_NONE;
+  if (elements)
+  {
+    assert(GetIndexBytes(mArena->GetIndexType()) == sizeof(GLuint)
+           || mNumVertices + (mPrimitiveRestart ? 1 : 0) 
+              <= (1u << (8 * GetIndexBytes(mArena->GetIndexType()))));
+
+    const GLuint numIndices = MeshGroup<F>::GetNumStoredIndices();
+    mIndexType = mArena->GetIndexType();
+    mIndexBlock = mArena->AllocateIndices(numIndices);
+    mArena->UploadIndices(mIndexBlock, 0, numIndices, elements);
+  }
+}
+
+template <StorageFormat F>
+bool MeshGroup<F>::Load(const GLfloat* buffer, const GLuint* indices)
+{
+  // Vertices are welded from separate attribute arrays.
+  if (mWeldingEnabled)
+  {
+    std::vector<std::vector<GLfloat>> attribData;
+    return MeshGroup<F>::Load(MeshGroup<F>::SplitRawBuffer(buffer, attribData), indices);
+  }
+
+  std::vector<GLuint> optimized;
+  GLuint positionStride = 0;
+  const GLfloat* positions = MeshGroup<F>::GetRawPositions(buffer, positionStride);
+  MeshGroup<F>::ComputeBoundingSphere(positions, positionStride);
+  indices = MeshGroup<F>::OptimizeIndices(indices, optimized, positions, positionStride);
+
+  MeshGroup<F>::StoreStagingCopy(buffer);
+  MeshGroup<F>::RemapStagingCopy();
+
+  // Reserve vertex buffer and initialize element array (if indices were provided).
+  MeshGroup<F>::AllocateBuffers(mStagingBuffer.data(), indices);
+
+  MeshGroup<F>::ReleaseStagingCopy();
+  return true;
+}
+
+template <StorageFormat F>
+bool MeshGroup<F>::Update(const GLfloat* buffer)
+{
+  MeshGroup<F>::StoreStagingCopy(buffer);
+  MeshGroup<F>::RemapStagingCopy();
+  MeshGroup<F>::UploadStagingCopy();
+  return true;
+}
+
+template <StorageFormat F>
+bool MeshGroup<F>::LoadPacked(const void* vertices, const GLuint* indices)
+{
+  std::vector<GLuint> optimized;
+  GLuint positionStride = 0;
+  const GLfloat* positions = MeshGroup<F>::GetPackedPositions(vertices, positionStride);
+  MeshGroup<F>::ComputeBoundingSphere(positions, positionStride);
+  indices = MeshGroup<F>::OptimizeIndices(indices, optimized, positions, positionStride);
+
+  MeshGroup<F>::StorePackedStagingCopy(vertices);
+  MeshGroup<F>::RemapStagingCopy();
+
+  // Reserve vertex buffer and initialize element array (if indices were provided).
+  MeshGroup<F>::AllocateBuffers(mStagingBuffer.data(), indices);
+
+  MeshGroup<F>::ReleaseStagingCopy();
+  return true;
+}
+
+template <StorageFormat F>
+bool MeshGroup<F>::UpdatePacked(const void* vertices)
+{
+  MeshGroup<F>::StorePackedStagingCopy(vertices);
+  MeshGroup<F>::RemapStagingCopy();
+  MeshGroup<F>::UploadStagingCopy();
+  return true;
+}
+
+template <StorageFormat F>
+bool MeshGroup<F>::LoadFromCache(const std::string & path)
+{
+  assert(mNumFrames == 1);
+  if (F != Interleave)  // Cached vertices are interleaved.
+    return false;
+
+  MeshCache cache;
+  if (!cache.Open(path))
+    return false;
+
+  return MeshGroup<F>::LoadSections(cache.GetHeader(), cache.GetVertexAttribList(),
+                                    cache.GetLodLevels(), cache.GetVertices(), cache.GetIndices());
+}
+
+template <StorageFormat F>
+bool MeshGroup<F>::LoadPacked(const PackedMesh & mesh)
+{
+  assert(mNumFrames == 1);
+  if (F != Interleave)
+    return false;
+
+  return MeshGroup<F>::LoadSections(mesh.mHeader, mesh.mVertexAttribList, mesh.mLodLevels.data(),
+                                    mesh.mVertices.data(), mesh.mIndices.data());
+}
+
+template <StorageFormat F>
+bool MeshGroup<F>::LoadSections(const MeshCacheHeader & header,
+                                const std::vector<VertexAttrib> & attribList,
+                                const LodLevel* lodLevels, const void* vertices,
+                                const void* indices)
+{
+  if (mNumAttributes == 0)
+  {
+    MeshGroup<F>::SetVertexAttribList(attribList);
+  }
+  else
+  {
+    bool sameLayout = (attribList.size() == mNumAttributes);
+    for (GLuint j = 0; sameLayout && j < mNumAttributes; j++)
+    {
+      sameLayout = attribList[j].mSize == mVertexAttributeList[j].mSize
+                && attribList[j].mFormat == mVertexAttributeList[j].mFormat;
+    }
+
+    if (!sameLayout)
+      return false;
+  }
+
+  mNumVertices = header.mNumVertices;
+  mNumElements = header.mNumElements;
+  mDrawMode = header.mDrawMode;
+  mPrimitiveRestart = (header.mFlags & kMeshCachePrimitiveRestart) != 0;
+
+  // Indices are already optimized: no vertex remap, meshlets or staging copy.
+  mVertexRemap.clear();
+  mMeshlets.clear();
+  mDirtyRanges.clear();
+  std::vector<GLubyte>().swap(mStagingBuffer);
+
+  mLodLevels.assign(lodLevels, lodLevels + header.mNumLods);
+
+  std::copy(header.mBoundingCenter, header.mBoundingCenter + 3, mBoundingCenter);
+  mBoundingRadius = header.mBoundingRadius;
+
+  if (mArena)  // Arena blocks use the arena index type.
+  {
+    std::vector<GLuint> elements(header.mNumStoredIndices);
+    if (header.mIndexType != GL_NONE)
+    {
+      UnpackIndices(header.mIndexType, indices, header.mNumStoredIndices, elements.data(),
+                    mPrimitiveRestart);
+    }
+
+    MeshGroup<F>::AllocateArenaBlocks(vertices,
+                                      header.mIndexType != GL_NONE ? elements.data() : nullptr);
+    return true;
+  }
+
+  // The sections go straight to the driver.
+  const GLuint vertexBytes = header.mNumVertices * header.mVertexStride;
+  mIndexType = header.mIndexType;
+  if (mIndexType != GL_NONE)
+  {
+    if (!mEab)
+      glGenBuffers(1, &mEab);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mEab);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, header.mNumStoredIndices * GetIndexBytes(mIndexType),
+                 indices, GL_STATIC_DRAW);
+    GpuMemory::TrackBuffer(mEab, header.mNumStoredIndices * GetIndexBytes(mIndexType),
+                           kGpuIndexBuffer, mDebugName);
+  }
+
+  glBindBuffer(GL_ARRAY_BUFFER, mVbo);
+  glBufferData(GL_ARRAY_BUFFER, vertexBytes, vertices, mDataUsage);
+  GpuMemory::TrackBuffer(mVbo, vertexBytes, kGpuVertexBuffer, mDebugName);
+
+  return true;
+}
+
+template <StorageFormat F>
+void MeshGroup<F>::StorePackedStagingCopy(const void* vertices)
+{
+  const GLubyte* bytes = static_cast<const GLubyte*>(vertices);
+  mStagingBuffer.assign(bytes, bytes + mNumVertices * mVertexStride);
+  mDirtyRanges.clear();
+}
+
+template <StorageFormat F>
+void MeshGroup<F>::RestoreStagingCopy(bool readBack)
+{
+  if (!mStagingBuffer.empty() || mNumVertices == 0)
+    return;
+
+  // Streaming groups never release it, so the vertices are in a single region.
+  mStagingBuffer.assign(mNumVertices * mVertexStride, 0);
+  if (!readBack)
+    return;
+
+  // GL_COPY_READ_BUFFER: reading must not change the element array of the bound VAO.
+  glBindBuffer(GL_COPY_READ_BUFFER, mArena ? mArena->GetVertexBuffer() : mVbo);
+  glGetBufferSubData(GL_COPY_READ_BUFFER, MeshGroup<F>::GetBaseVertex() * mVertexStride,
+                     mStagingBuffer.size(), mStagingBuffer.data());
+  glBindBuffer(GL_COPY_READ_BUFFER, 0);
+}
+
+template <StorageFormat F>
+void MeshGroup<F>::UploadStagingCopy()
+{
+  if (mNumFrames > 1)  // Streaming: write into the next frame region.
+  {
+    MeshGroup<F>::PublishStagingCopy();
+    return;
+  }
+
+  if (mArena)  // Shared buffer: only this block can be written.
+  {
+    mArena->UploadVertices(mVertexBlock, 0, mNumVertices, mStagingBuffer.data());
+    MeshGroup<F>::ReleaseStagingCopy();
+    return;
+  }
+
+  // The whole buffer changes: orphan the old storage instead of waiting for the GPU to release it.
+  glBindBuffer(GL_ARRAY_BUFFER, mVbo);
+  glBufferData(GL_ARRAY_BUFFER, mVertexStride * mNumVertices, mStagingBuffer.data(), mDataUsage);
+
+  MeshGroup<F>::ReleaseStagingCopy();
+}
+
+/* Vertex cache optimization */
+template <StorageFormat F>
+const GLuint* MeshGroup<F>::OptimizeIndices(const GLuint* indices, std::vector<GLuint> & optimized,
+                                            const GLfloat* positions, GLuint positionStride)
+{
+  mVertexRemap.clear();
+  mLodLevels.clear();
+  mMeshlets.clear();
+
+  // Triangles can't move between draw ranges, and levels of detail and meshlets span the
+  // whole element array. Ranges with a base vertex don't index 'positions' directly.
+  const bool hasRanges = !mDrawRanges.empty();
+  const bool hasBaseVertices = std::any_of(mDrawRanges.begin(), mDrawRanges.end(),
+                                           [](const DrawRange & r) { return r.mBaseVertex != 0; });
+
+  const bool generateLods = !mLodTargetErrors.empty() && positions && !hasRanges;
+  const bool generateMeshlets = mMeshletsEnabled && positions && !hasRanges;
+  if (!indices || mDrawMode != GL_TRIANGLES 
+      || (mVertexCacheSize == 0 && !generateLods && !generateMeshlets))
+  {
+    return indices;
+  }
+
+  optimized.assign(indices, indices + mNumElements);
+
+  if (mVertexCacheSize > 0)
+  {
+    mCacheStatsBefore = AnalyzeVertexCache(optimized.data(), mNumElements, mNumVertices, 
+                                           mVertexCacheSize);
+
+    std::vector<DrawRange> segments(mDrawRanges);
+    if (!hasRanges)
+      segments.push_back({0, mNumElements, 0});
+
+    for (const DrawRange & segment : segments)
+    {
+      GLuint* first = &optimized[segment.mFirstIndex];
+      OptimizeVertexCache(first, segment.mNumIndices, mNumVertices, mVertexCacheSize);
+
+      if (mOverdrawThreshold > 0.0f && positions && !hasBaseVertices)
+      {
+        OptimizeOverdraw(first, segment.mNumIndices, positions, positionStride, mNumVertices,
+                         mOverdrawThreshold, mVertexCacheSize);
+      }
+    }
+  }
+
+  // Levels of detail are appended to the element array (each one with its own triangle order).
+  if (generateLods)
+  {
+    BuildLodChain(optimized, positions, positionStride, mNumVertices, mLodTargetErrors, mLodLevels);
+
+    for (GLuint l = 1; l < mLodLevels.size() && mVertexCacheSize > 0; l++)
+    {
+      OptimizeVertexCache(&optimized[mLodLevels[l].mFirstIndex], mLodLevels[l].mNumIndices, 
+                          mNumVertices, mVertexCacheSize);
+    }
+
+    if (mLodLevels.size() < 2)
+      mLodLevels.clear();
+  }
+
+  // Meshlets are ranges of the first level (its triangle order is final here).
+  if (generateMeshlets)
+  {
+    BuildMeshlets(optimized.data(), mNumElements, positions, positionStride, mNumVertices, 
+                  mMeshlets);
+  }
+
+  // Reordering vertices breaks contiguous partial updates, so only static groups do it.
+  // Coarser levels only reference vertices of the first one.
+  if (mVertexCacheSize > 0 && mDataUsage == GL_STATIC_DRAW && mNumFrames == 1 && !hasBaseVertices)
+  {
+    OptimizeVertexFetch(optimized.data(), mNumElements, mNumVertices, mVertexRemap);
+
+    for (GLuint i = mNumElements; i < optimized.size(); i++)
+      optimized[i] = mVertexRemap[optimized[i]];
+  }
+
+  if (mVertexCacheSize > 0)
+  {
+    mCacheStatsAfter = AnalyzeVertexCache(optimized.data(), mNumElements, mNumVertices, 
+                                          mVertexCacheSize);
+  }
+
+  return optimized.data();
+}
+
+template <StorageFormat F>
+const GLfloat* MeshGroup<F>::GetRawPositions(const GLfloat* buffer, GLuint & positionStride) const
+{
+  if (!buffer || mPositionAttrib >= mNumAttributes)
+    return nullptr;
+
+  GLuint offset = 0;
+  for (GLuint j = 0; j < mPositionAttrib; j++)
+    offset += mVertexAttributeList[j].mSize;
+
+  // Interleave: (P N T) (P N T) ... | Batch: (P P ...) (N N ...) (T T ...).
+  if (F == Interleave)
+  {
+    positionStride = mVertexSize;
+    return buffer + offset;
+  }
+
+  // PositionSplit: (P P ...) (N T) (N T) ... (the first attribute is the one split).
+  const GLuint firstSize = mVertexAttributeList[0].mSize;
+  if (F == PositionSplit && mPositionAttrib > 0)
+  {
+    positionStride = mVertexSize - firstSize;
+    return buffer + firstSize * mNumVertices + (offset - firstSize);
+  }
+
+  positionStride = mVertexAttributeList[mPositionAttrib].mSize;
+  return buffer + offset * mNumVertices;
+}
+
+template <StorageFormat F>
+const GLfloat* MeshGroup<F>::GetPackedPositions(const void* vertices, GLuint & positionStride) const
+{
+  // Positions stored in other formats would have to be unpacked first.
+  if (!vertices || mPositionAttrib >= mNumAttributes 
+      || mVertexAttributeList[mPositionAttrib].mFormat != kFloat32)
+  {
+    return nullptr;
+  }
+
+  // Strides are multiples of 4 bytes (attributes are padded).
+  positionStride = mAttribStrides[mPositionAttrib] / sizeof(GLfloat);
+  return reinterpret_cast<const GLfloat*>(static_cast<const GLubyte*>(vertices) 
+                                          + mAttribOffsets[mPositionAttrib]);
+}
+
+template <StorageFormat F>
+std::vector<GLfloat*> MeshGroup<F>::WeldBufferList(const std::vector<GLfloat*> & bufferList,
+                                                   const GLuint* & indices,
+                                                   std::vector<std::vector<GLfloat>> & welded,
+                                                   std::vector<GLuint> & weldedIndices)
+{
+  // Ranges with a base vertex index vertices of their own.
+  const bool hasBaseVertices = std::any_of(mDrawRanges.begin(), mDrawRanges.end(),
+                                           [](const DrawRange & r) { return r.mBaseVertex != 0; });
+  if (!mWeldingEnabled || hasBaseVertices || mNumVertices == 0)
+    return bufferList;
+
+  // Attributes that weren't provided don't tell vertices apart.
+  std::vector<WeldStream> streams;
+  GLuint positionStream = mNumAttributes;  // No stream, if positions weren't provided.
+  for (GLuint j = 0; j < mNumAttributes; j++)
+  {
+    const GLuint size = mVertexAttributeList[j].mSize;
+    if (bufferList[j] && size > 0)
+    {
+      if (j == mPositionAttrib)
+        positionStream = streams.size();
+
+      streams.push_back({ bufferList[j], size, size });
+    }
+  }
+
+  std::vector<GLuint> remap;
+  const GLuint numUnique = WeldVertices(streams, mNumVertices, positionStream, mWeldEpsilon, remap);
+
+  // Unindexed groups draw the first 'mNumElements' vertices.
+  if (indices)
+  {
+    weldedIndices.resize(mNumElements);
+    for (GLuint i = 0; i < mNumElements; i++)
+    {
+      const bool restart = mPrimitiveRestart && indices[i] == kPrimitiveRestartIndex;
+      weldedIndices[i] = restart ? kPrimitiveRestartIndex : remap[indices[i]];
+    }
+  }
+  else
+  {
+    weldedIndices.assign(remap.begin(), remap.begin() + std::min(mNumElements, mNumVertices));
+    mNumElements = weldedIndices.size();
+  }
+
+  std::vector<GLfloat*> weldedList(bufferList.size(), nullptr);
+  welded.resize(bufferList.size());
+  for (GLuint j = 0, s = 0; j < mNumAttributes; j++)
+  {
+    if (bufferList[j] && mVertexAttributeList[j].mSize > 0)
+    {
+      welded[j].resize(mVertexAttributeList[j].mSize * numUnique);
+      CompactVertices(streams[s++], mNumVertices, remap, welded[j].data());
+      weldedList[j] = welded[j].data();
+    }
+  }
+
+  // Batched and split offsets depend on the vertex count (passes may have been added already).
+  mNumVertices = numUnique;
+  MeshGroup<F>::ComputeLayout();
+  MeshGroup<F>::RebuildOwnedVaos();
+
+  indices = weldedIndices.data();
+  return weldedList;
+}
+
+template <StorageFormat F>
+std::vector<GLfloat*> MeshGroup<F>::SplitRawBuffer(const GLfloat* buffer,
+                                                   std::vector<std::vector<GLfloat>> & attribData) const
+{
+  std::vector<GLfloat*> bufferList(mNumAttributes, nullptr);
+  std::vector<GLuint> sizes(mNumAttributes);
+  attribData.resize(mNumAttributes);
+
+  GLuint offset = 0;
+  for (GLuint j = 0; j < mNumAttributes; j++)
+  {
+    sizes[j] = mVertexAttributeList[j].mSize;
+    attribData[j].resize(sizes[j] * mNumVertices);
+    bufferList[j] = attribData[j].data();
+
+    // Batch: (P P ...) (N N ...) (T T ...) is already split. PositionSplit: (P P ...) as well.
+    if (F == Batch || (F == PositionSplit && j == 0))
+    {
+      std::copy(buffer + offset * mNumVertices, buffer + (offset + sizes[j]) * mNumVertices,
+                attribData[j].begin());
+    }
+
+    offset += sizes[j];
+  }
+
+  if (F == Interleave)
+    DeinterleaveFloats(buffer, sizes.data(), mNumAttributes, mNumVertices, bufferList.data());
+
+  if (F == PositionSplit && mNumAttributes > 1)
+  {
+    DeinterleaveFloats(buffer + sizes[0] * mNumVertices, &sizes[1], mNumAttributes - 1,
+                       mNumVertices, &bufferList[1]);
+  }
+
+  return bufferList;
+}
+
+template <StorageFormat F>
+void MeshGroup<F>::ComputeBoundingSphere(const GLfloat* positions, GLuint positionStride)
+{
+  if (positions && mNumVertices > 0 && mVertexAttributeList[mPositionAttrib].mSize >= 3)
+  {
+    mBoundingRadius = ComputeMeshRadius(positions, positionStride, mNumVertices, mBoundingCenter);
+  }
+}
+
+template <StorageFormat F>
+GLuint MeshGroup<F>::GetNumStoredIndices() const
+{
+  if (mLodLevels.empty())
+    return mNumElements;
+
+  return mLodLevels.back().mFirstIndex + mLodLevels.back().mNumIndices;
+}
+
+template <StorageFormat F>
+std::vector<GLfloat*> MeshGroup<F>::RemapBufferList(const std::vector<GLfloat*> & bufferList,
+                                                    std::vector<std::vector<GLfloat>> & remapped) const
+{
+  if (mVertexRemap.empty())
+    return bufferList;
+
+  std::vector<GLfloat*> remappedList(bufferList.size(), nullptr);
+  remapped.resize(bufferList.size());
+
+  for (GLuint j = 0; j < bufferList.size(); j++)
+  {
+    const GLuint size = mVertexAttributeList[j].mSize;
+    if (bufferList[j] && size > 0)
+    {
+      remapped[j].resize(size * mNumVertices);
+      RemapVertices(bufferList[j], size * sizeof(GLfloat), size * sizeof(GLfloat), mNumVertices,
+                    mVertexRemap, remapped[j].data());
+      remappedList[j] = remapped[j].data();
+    }
+  }
+
+  return remappedList;
+}
+
+template <StorageFormat F>
+void MeshGroup<F>::RemapStagingCopy()
+{
+  if (mVertexRemap.empty() || mStagingBuffer.empty())
+    return;
+
+  // Both storage formats place vertex v of attribute j at offset[j] + stride[j] * v.
+  std::vector<GLubyte> remapped(mStagingBuffer.size(), 0);
+  for (GLuint j = 0; j < mNumAttributes; j++)
+  {
+    RemapVertices(&mStagingBuffer[mAttribOffsets[j]], GetAttribBytes(mVertexAttributeList[j]),
+                  mAttribStrides[j], mNumVertices, mVertexRemap, &remapped[mAttribOffsets[j]]);
+  }
+
+  mStagingBuffer.swap(remapped);
+}
+
+template <StorageFormat F>
+void MeshGroup<F>::MarkDirty(GLuint firstVertex, GLuint count)
+{
+  if (count > 0)
+  {
+    mDirtyRanges.emplace_back(firstVertex, firstVertex + count);
+  }
+}
+
+/* Streaming */
+template <StorageFormat F>
+void MeshGroup<F>::AllocateStreamingStorage()
+{
+  // Immutable storage can't be reallocated (and the size never changes anyway).
+  if (mStreamingStorageReady)
+    return;
+
+  const GLsizeiptr size = mNumFrames * mNumVertices * mVertexStride;
+
+#if defined(GL_MAP_PERSISTENT_BIT)
+  if (IsGLVersionSupported(4, 4) || IsGLExtensionSupported("GL_ARB_buffer_storage"))
+  {
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glBufferStorage(GL_ARRAY_BUFFER, size, nullptr, flags);
+    mMappedBuffer = static_cast<GLubyte*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags));
+  }
+#endif
+
+  if (!mMappedBuffer)  // Fallback: regular buffer, mapped per update.
+  {
+    glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+  }
+
+  GpuMemory::TrackBuffer(mVbo, size, kGpuVertexBuffer, mDebugName);
+  mStreamingStorageReady = true;
+}
+
+template <StorageFormat F>
+void MeshGroup<F>::WaitForFrame(GLuint frame)
+{
+  GLsync & fence = mFences[frame];
+  if (!fence)
+    return;
+
+  GLenum status = glClientWaitSync(fence, 0, 0);
+  while (status == GL_TIMEOUT_EXPIRED)
+  {
+    status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, kStreamingWaitTimeout);
+  }
+
+  glDeleteSync(fence);
+  fence = nullptr;
+}
+
+template <StorageFormat F>
+void MeshGroup<F>::PublishStagingCopy()
+{
+  mCurrentFrame = (mCurrentFrame + 1) % mNumFrames;
+
+  MeshGroup<F>::WaitForFrame(mCurrentFrame);
+  MeshGroup<F>::CopyStagingToFrame(mCurrentFrame);
+
+  mDirtyRanges.clear();
+}
+
+template <StorageFormat F>
+void MeshGroup<F>::WriteStreamingRange(GLintptr offset, GLsizeiptr size, const void* data)
+{
+  if (mMappedBuffer)  // Persistent mapping: write straight into the buffer.
+  {
+    memcpy(mMappedBuffer + offset, data, size);
+  }
+  else  // Map only this range. Fences already guarantee the GPU isn't reading it.
+  {
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | 
+                             GL_MAP_UNSYNCHRONIZED_BIT;
+
+    glBindBuffer(GL_ARRAY_BUFFER, mVbo);
+    void* dst = glMapBufferRange(GL_ARRAY_BUFFER, offset, size, flags);
+    memcpy(dst, data, size);
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+  }
+}
+
+// ============================================================================================= //
+// Specializations for different StorageFormats.
+
+// ================ Batched Storage =================== //
+
+template <>
+bool MeshGroup<Batch>::Load(const std::vector<GLfloat*> & bufferList, const GLuint* indices);
+
+template <>
+bool MeshGroup<Batch>::Update(const std::vector<GLfloat*> & bufferList);
+
+template <>
+bool MeshGroup<Batch>::Update(GLuint attrib, GLuint firstVertex, GLuint count, const GLfloat* data);
+
+template <>
+void MeshGroup<Batch>::FlushUpdates();
+
+template <>
+void MeshGroup<Batch>::ComputeLayout();
+
+template <>
+void MeshGroup<Batch>::StoreStagingCopy(const GLfloat* vertices);
+
+template <>
+void MeshGroup<Batch>::ReleaseStagingCopy();
+
+template <>
+void MeshGroup<Batch>::CopyStagingToFrame(GLuint frame);
+
+template <>
+void MeshGroup<Batch>::BuildVAO(const std::vector<std::pair<GLint, bool>> & attribList);
+
+// ================ Interleaved Storage ==================== //
+
+template <>
+bool MeshGroup<Interleave>::Load(const std::vector<GLfloat*> & bufferList, const GLuint* indices);
+
+template <>
+bool MeshGroup<Interleave>::Update(const std::vector<GLfloat*> & bufferList);
+
+template <>
+bool MeshGroup<Interleave>::Update(GLuint attrib, GLuint firstVertex, GLuint count, 
+                                   const GLfloat* data);
+
+template <>
+void MeshGroup<Interleave>::FlushUpdates();
+
+template <>
+void MeshGroup<Interleave>::ComputeLayout();
+
+template <>
+void MeshGroup<Interleave>::StoreStagingCopy(const GLfloat* vertices);
+
+template <>
+void MeshGroup<Interleave>::ReleaseStagingCopy();
+
+template <>
+void MeshGroup<Interleave>::CopyStagingToFrame(GLuint frame);
+
+template <>
+void MeshGroup<Interleave>::BuildVAO(const std::vector<std::pair<GLint, bool>> & attribList);
+
+// ================ Position-split Storage ================= //
+
+template <>
+bool MeshGroup<PositionSplit>::Load(const std::vector<GLfloat*> & bufferList,
+                                    const GLuint* indices);
+
+template <>
+bool MeshGroup<PositionSplit>::Update(const std::vector<GLfloat*> & bufferList);
+
+template <>
+bool MeshGroup<PositionSplit>::Update(GLuint attrib, GLuint firstVertex, GLuint count,
+                                      const GLfloat* data);
+
+template <>
+void MeshGroup<PositionSplit>::FlushUpdates();
+
+template <>
+void MeshGroup<PositionSplit>::ComputeLayout();
+
+template <>
+void MeshGroup<PositionSplit>::StoreStagingCopy(const GLfloat* vertices);
+
+template <>
+void MeshGroup<PositionSplit>::ReleaseStagingCopy();
+
+template <>
+void MeshGroup<PositionSplit>::CopyStagingToFrame(GLuint frame);
+
+template <>
+void MeshGroup<PositionSplit>::BuildVAO(const std::vector<std::pair<GLint, bool>> & attribList);
 
 
 }  // namespace gloo.
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include "index_format.h"
+
+#include <cassert>
+#include <cstring>
+
+namespace gloo
+{
+
+GLenum SelectIndexType(GLuint numVertices, bool allowByteIndices, bool primitiveRestart)
+{
+  // The restart index can't address a vertex.
+  const GLuint reserved = primitiveRestart ? 1 : 0;
+
+  if (allowByteIndices && numVertices + reserved <= 0x100)
+    return GL_UNSIGNED_BYTE;
+
+  if (numVertices + reserved <= 0x10000)
+    return GL_UNSIGNED_SHORT;
+
+  return GL_UNSIGNED_INT;
+}
+
+GLuint GetRestartIndex(GLenum type)
+{
+  switch (type)
+  {
+    case GL_UNSIGNED_BYTE:  return 0xff;
+    case GL_UNSIGNED_SHORT: return 0xffff;
+    default:                return 0xffffffff;
+  }
+}
+
+GLuint GetIndexBytes(GLenum type)
+{
+  switch (type)
+  {
+    case GL_UNSIGNED_BYTE:  return sizeof(GLubyte);
+    case GL_UNSIGNED_SHORT: return sizeof(GLushort);
+    default:                return sizeof(GLuint);
+  }
+}
+
+void PackIndices(GLenum type, const GLuint* src, GLuint count, void* dst)
+{
+  switch (type)
+  {
+    case GL_UNSIGNED_BYTE:
+    {
+      GLubyte* out = static_cast<GLubyte*>(dst);
+      for (GLuint i = 0; i < count; i++)
+      {
+        assert(src[i] <= 0xff || src[i] == kPrimitiveRestartIndex);
+        out[i] = static_cast<GLubyte>(src[i]);  // The restart index is truncated to 0xff.
+      }
+      break;
+    }
+    case GL_UNSIGNED_SHORT:
+    {
+      GLushort* out = static_cast<GLushort*>(dst);
+      for (GLuint i = 0; i < count; i++)
+      {
+        assert(src[i] <= 0xffff || src[i] == kPrimitiveRestartIndex);
+        out[i] = static_cast<GLushort>(src[i]);  // The restart index is truncated to 0xffff.
+      }
+      break;
+    }
+    default:
+      memcpy(dst, src, count * sizeof(GLuint));
+      break;
+  }
+}
+
+void UnpackIndices(GLenum type, const void* src, GLuint count, GLuint* dst, bool primitiveRestart)
+{
+  switch (type)
+  {
+    case GL_UNSIGNED_BYTE:
+    {
+      const GLubyte* in = static_cast<const GLubyte*>(src);
+      for (GLuint i = 0; i < count; i++)
+        dst[i] = in[i];
+      break;
+    }
+    case GL_UNSIGNED_SHORT:
+    {
+      const GLushort* in = static_cast<const GLushort*>(src);
+      for (GLuint i = 0; i < count; i++)
+        dst[i] = in[i];
+      break;
+    }
+    default:
+      memcpy(dst, src, count * sizeof(GLuint));
+      break;
+  }
+
+  if (primitiveRestart && type != GL_UNSIGNED_INT)
+  {
+    const GLuint restartIndex = GetRestartIndex(type);
+    for (GLuint i = 0; i < count; i++)
+    {
+      if (dst[i] == restartIndex)
+        dst[i] = kPrimitiveRestartIndex;
+    }
+  }
+}
+
+std::vector<GLuint> TriangulateStrip(const GLuint* indices, GLuint count)
+{
+  std::vector<GLuint> triangles;
+  triangles.reserve(3 * count);
+
+  // 'first' is where the current strip starts: odd triangles of a strip flip their winding.
+  GLuint first = 0;
+  for (GLuint i = 0; i < count; i++)
+  {
+    if (indices[i] == kPrimitiveRestartIndex)
+    {
+      first = i + 1;
+      continue;
+    }
+
+    if (i < first + 2)
+      continue;
+
+    const GLuint a = indices[i-2];
+    const GLuint b = indices[i-1];
+    const GLuint c = indices[i];
+    if (a == b || b == c || a == c)
+      continue;
+
+    const bool odd = ((i - first) % 2 == 1);
+    triangles.push_back(odd ? b : a);
+    triangles.push_back(odd ? a : b);
+    triangles.push_back(c);
+  }
+
+  return triangles;
+}
+
+}  // namespace gloo.
@@ -0,0 +1,58 @@
+// + ======================================== +
+// |         gl-oo-interface library          |
+// |            Module: GLOO Mesh.            |
+// |        Author: Rodrigo Castiel, 2016.    |
+// + ======================================== +
+//
+// Index (element) formats.
+//
+// Indices are always handed to MeshGroup as GLuint, but they are stored with the narrowest
+// type that can address every vertex of the group:
+//  -> GL_UNSIGNED_SHORT for groups up to 65536 vertices (half the memory/bandwidth).
+//  -> GL_UNSIGNED_INT otherwise.
+//
+// GL_UNSIGNED_BYTE is only picked if explicitly allowed: several drivers don't support it
+// natively and convert the whole element buffer on the CPU before drawing.
+//
+// Primitive restart: kPrimitiveRestartIndex in a GLuint index stream ends the current strip
+// (or loop/fan). It is stored as the largest value of the index type (GetRestartIndex()), which
+// is then reserved: a type addresses one vertex less when restart is enabled.
+
+#pragma once
+
+#include "gloo/gl_header.h"
+
+#include <vector>
+
+namespace gloo
+{
+
+// Index that restarts the primitive in the GLuint indices passed to MeshGroup.
+const GLuint kPrimitiveRestartIndex = ~0u;
+
+// Returns the narrowest index type able to address 'numVertices' vertices (and to keep its
+// largest value free for primitive restart if 'primitiveRestart' is true).
+GLenum SelectIndexType(GLuint numVertices, bool allowByteIndices = false,
+                       bool primitiveRestart = false);
+
+// Restart index of type 'type' (its largest value).
+GLuint GetRestartIndex(GLenum type);
+
+// Size in bytes of an index of type 'type' (GL_UNSIGNED_BYTE/SHORT/INT).
+GLuint GetIndexBytes(GLenum type);
+
+// Converts 'count' GLuint indices into 'dst', stored as 'type' (kPrimitiveRestartIndex becomes
+// the restart index of 'type').
+// 'dst' must hold count * GetIndexBytes(type) bytes.
+void PackIndices(GLenum type, const GLuint* src, GLuint count, void* dst);
+
+// Converts 'count' indices stored as 'type' back into GLuint indices (restart indices of
+// 'type' become kPrimitiveRestartIndex if 'primitiveRestart' is true).
+void UnpackIndices(GLenum type, const void* src, GLuint count, GLuint* dst,
+                   bool primitiveRestart = false);
+
+// Converts a GL_TRIANGLE_STRIP index stream (strips separated by kPrimitiveRestartIndex) into
+// a triangle list with the same winding. Degenerate triangles are dropped.
+std::vector<GLuint> TriangulateStrip(const GLuint* indices, GLuint count);
+
+}  // namespace gloo.
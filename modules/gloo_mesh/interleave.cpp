@@ -0,0 +1,322 @@
+#include "interleave.h"
+#include "vertex_format.h"
+
+#include <thread>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define GLOO_INTERLEAVE_AVX2 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define GLOO_INTERLEAVE_SSE2 1
+#endif
+
+namespace gloo
+{
+
+namespace
+{
+  // Layouts with dedicated kernels: {3, 3, 2} and {3, 3, 2, 3} (tangents).
+  bool IsPhongLayout(const GLuint* sizes, GLuint numAttribs, bool & hasTangents)
+  {
+    hasTangents = (numAttribs == 4);
+    return (numAttribs == 3 || numAttribs == 4) && sizes[0] == 3 && sizes[1] == 3 && sizes[2] == 2
+        && (!hasTangents || sizes[3] == 3);
+  }
+
+  // Runs 'kernel(first, last)' over [0, count), split across threads if it's large enough.
+  template <class Kernel>
+  void RunRanges(GLuint count, const Kernel & kernel)
+  {
+    const GLuint maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    const GLuint numThreads = std::min(maxThreads, count / kParallelInterleaveVertices);
+
+    if (numThreads <= 1)
+    {
+      kernel(0, count);
+      return;
+    }
+
+    // Ranges are rounded to 8 vertices, so that aligned vertices stay aligned.
+    const GLuint rangeSize = ((count + numThreads - 1) / numThreads + 7) & ~7u;
+
+    std::vector<std::thread> threads;
+    for (GLuint first = rangeSize; first < count; first += rangeSize)
+      threads.emplace_back(kernel, first, std::min(first + rangeSize, count));
+
+    kernel(0, std::min(rangeSize, count));
+    for (std::thread & thread : threads)
+      thread.join();
+  }
+
+  // Scalar kernels (also used for the last vertex of each range by the SIMD kernels, whose
+  // vector loads and stores go one float past the vertex).
+  template <bool kTangents>
+  void InterleavePhongScalar(const GLfloat* const* srcList, GLuint first, GLuint last,
+                             GLfloat* dst)
+  {
+    const GLuint stride = kTangents ? 11 : 8;
+    for (GLuint i = first; i < last; i++)
+    {
+      GLfloat* out = dst + stride*i;
+      memcpy(out + 0, srcList[0] + 3*i, 3 * sizeof(GLfloat));
+      memcpy(out + 3, srcList[1] + 3*i, 3 * sizeof(GLfloat));
+      memcpy(out + 6, srcList[2] + 2*i, 2 * sizeof(GLfloat));
+      if (kTangents)
+        memcpy(out + 8, srcList[3] + 3*i, 3 * sizeof(GLfloat));
+    }
+  }
+
+  template <bool kTangents>
+  void DeinterleavePhongScalar(const GLfloat* src, GLuint first, GLuint last,
+                               GLfloat* const* dstList)
+  {
+    const GLuint stride = kTangents ? 11 : 8;
+    for (GLuint i = first; i < last; i++)
+    {
+      const GLfloat* in = src + stride*i;
+      memcpy(dstList[0] + 3*i, in + 0, 3 * sizeof(GLfloat));
+      memcpy(dstList[1] + 3*i, in + 3, 3 * sizeof(GLfloat));
+      memcpy(dstList[2] + 2*i, in + 6, 2 * sizeof(GLfloat));
+      if (kTangents)
+        memcpy(dstList[3] + 3*i, in + 8, 3 * sizeof(GLfloat));
+    }
+  }
+
+#if GLOO_INTERLEAVE_SSE2 == 1
+  bool IsAligned(const void* pointer, std::uintptr_t alignment)
+  {
+    return reinterpret_cast<std::uintptr_t>(pointer) % alignment == 0;
+  }
+
+  template <bool kTangents>
+  void InterleavePhongSse2(const GLfloat* const* srcList, GLuint first, GLuint last,
+                           GLfloat* dst, bool streamStores)
+  {
+    const GLfloat* positions = srcList[0];
+    const GLfloat* normals   = srcList[1];
+    const GLfloat* uvs       = srcList[2];
+    const GLfloat* tangents  = kTangents ? srcList[3] : nullptr;
+    const GLuint stride = kTangents ? 11 : 8;
+
+    // {3, 3, 2} vertices are 32 bytes: all of them are aligned if the first one is.
+    const bool stream = streamStores && !kTangents && IsAligned(dst, 16);
+
+    const GLuint simdLast = (last > first) ? last - 1 : first;
+    for (GLuint i = first; i < simdLast; i++)
+    {
+      const __m128 p  = _mm_loadu_ps(positions + 3*i);  // px py pz -
+      const __m128 n  = _mm_loadu_ps(normals + 3*i);    // nx ny nz -
+      const __m128 uv = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(uvs + 2*i)));
+
+      const __m128 t  = _mm_shuffle_ps(p, n, _MM_SHUFFLE(0, 0, 2, 2));   // pz pz nx nx
+      const __m128 v0 = _mm_shuffle_ps(p, t, _MM_SHUFFLE(2, 0, 1, 0));   // px py pz nx
+      const __m128 v1 = _mm_shuffle_ps(n, uv, _MM_SHUFFLE(1, 0, 2, 1));  // ny nz u  v
+
+      GLfloat* out = dst + stride*i;
+      if (stream)
+      {
+        _mm_stream_ps(out, v0);
+        _mm_stream_ps(out + 4, v1);
+      }
+      else
+      {
+        _mm_storeu_ps(out, v0);
+        _mm_storeu_ps(out + 4, v1);
+      }
+
+      if (kTangents)  // The 4th float is overwritten by the next vertex.
+        _mm_storeu_ps(out + 8, _mm_loadu_ps(tangents + 3*i));
+    }
+
+    if (stream)
+      _mm_sfence();
+
+    InterleavePhongScalar<kTangents>(srcList, simdLast, last, dst);
+  }
+
+  template <bool kTangents>
+  void DeinterleavePhongSse2(const GLfloat* src, GLuint first, GLuint last,
+                             GLfloat* const* dstList)
+  {
+    GLfloat* positions = dstList[0];
+    GLfloat* normals   = dstList[1];
+    GLfloat* uvs       = dstList[2];
+    GLfloat* tangents  = kTangents ? dstList[3] : nullptr;
+    const GLuint stride = kTangents ? 11 : 8;
+
+    // Stores write one float past each attribute, overwritten by the next vertex.
+    const GLuint simdLast = (last > first) ? last - 1 : first;
+    for (GLuint i = first; i < simdLast; i++)
+    {
+      const GLfloat* in = src + stride*i;
+      const __m128 v0 = _mm_loadu_ps(in);      // px py pz nx
+      const __m128 v1 = _mm_loadu_ps(in + 4);  // ny nz u  v
+
+      const __m128 t = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(0, 0, 3, 3));  // nx nx ny ny
+      const __m128 n = _mm_shuffle_ps(t, v1, _MM_SHUFFLE(3, 1, 2, 0));   // nx ny nz v
+
+      _mm_storeu_ps(positions + 3*i, v0);
+      _mm_storeu_ps(normals + 3*i, n);
+      _mm_store_sd(reinterpret_cast<double*>(uvs + 2*i), _mm_castps_pd(_mm_movehl_ps(v1, v1)));
+
+      if (kTangents)
+        _mm_storeu_ps(tangents + 3*i, _mm_loadu_ps(in + 8));
+    }
+
+    DeinterleavePhongScalar<kTangents>(src, simdLast, last, dstList);
+  }
+#endif
+
+#if GLOO_INTERLEAVE_AVX2 == 1
+  template <bool kTangents>
+  void InterleavePhongAvx2(const GLfloat* const* srcList, GLuint first, GLuint last,
+                           GLfloat* dst, bool streamStores)
+  {
+    const GLfloat* positions = srcList[0];
+    const GLfloat* normals   = srcList[1];
+    const GLfloat* uvs       = srcList[2];
+    const GLfloat* tangents  = kTangents ? srcList[3] : nullptr;
+    const GLuint stride = kTangents ? 11 : 8;
+
+    const bool stream = streamStores && !kTangents && IsAligned(dst, 32);
+    const __m256i permutation = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 6, 7);
+
+    const GLuint simdLast = (last > first) ? last - 1 : first;
+    for (GLuint i = first; i < simdLast; i++)
+    {
+      // px py pz - | nx ny nz -  ->  px py pz nx | ny nz u v
+      const __m256 pn = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(positions + 3*i)),
+                                             _mm_loadu_ps(normals + 3*i), 1);
+      const __m256 uv = _mm256_castpd_ps(
+        _mm256_broadcast_sd(reinterpret_cast<const double*>(uvs + 2*i)));
+      const __m256 v = _mm256_blend_ps(_mm256_permutevar8x32_ps(pn, permutation), uv, 0xc0);
+
+      GLfloat* out = dst + stride*i;
+      if (stream)
+        _mm256_stream_ps(out, v);
+      else
+        _mm256_storeu_ps(out, v);
+
+      if (kTangents)  // The 4th float is overwritten by the next vertex.
+        _mm_storeu_ps(out + 8, _mm_loadu_ps(tangents + 3*i));
+    }
+
+    if (stream)
+      _mm_sfence();
+
+    InterleavePhongScalar<kTangents>(srcList, simdLast, last, dst);
+  }
+#endif
+
+  template <bool kTangents>
+  void InterleavePhong(const GLfloat* const* srcList, GLuint first, GLuint last, GLfloat* dst,
+                       bool streamStores)
+  {
+#if GLOO_INTERLEAVE_AVX2 == 1
+    InterleavePhongAvx2<kTangents>(srcList, first, last, dst, streamStores);
+#elif GLOO_INTERLEAVE_SSE2 == 1
+    InterleavePhongSse2<kTangents>(srcList, first, last, dst, streamStores);
+#else
+    InterleavePhongScalar<kTangents>(srcList, first, last, dst);
+#endif
+  }
+
+  template <bool kTangents>
+  void DeinterleavePhong(const GLfloat* src, GLuint first, GLuint last, GLfloat* const* dstList)
+  {
+#if GLOO_INTERLEAVE_SSE2 == 1
+    DeinterleavePhongSse2<kTangents>(src, first, last, dstList);
+#else
+    DeinterleavePhongScalar<kTangents>(src, first, last, dstList);
+#endif
+  }
+}  // namespace.
+
+InterleaveKernel GetInterleaveKernel(const GLuint* sizes, GLuint numAttribs)
+{
+  bool hasTangents = false;
+  if (!IsPhongLayout(sizes, numAttribs, hasTangents))
+    return kInterleaveGeneric;
+
+#if GLOO_INTERLEAVE_AVX2 == 1
+  return kInterleaveAvx2;
+#elif GLOO_INTERLEAVE_SSE2 == 1
+  return kInterleaveSse2;
+#else
+  return kInterleaveScalar;
+#endif
+}
+
+void InterleaveFloats(const GLfloat* const* srcList, const GLuint* sizes, GLuint numAttribs,
+                      GLuint count, GLfloat* dst, bool streamStores)
+{
+  bool hasTangents = false;
+  if (IsPhongLayout(sizes, numAttribs, hasTangents))
+  {
+    RunRanges(count, [=](GLuint first, GLuint last) {
+      if (hasTangents)
+        InterleavePhong<true>(srcList, first, last, dst, streamStores);
+      else
+        InterleavePhong<false>(srcList, first, last, dst, streamStores);
+    });
+    return;
+  }
+
+  GLuint vertexSize = 0;
+  for (GLuint j = 0; j < numAttribs; j++)
+    vertexSize += sizes[j];
+
+  // Other layouts: one strided pass per attribute (see PackAttrib()).
+  RunRanges(count, [=](GLuint first, GLuint last) {
+    GLuint offset = 0;
+    for (GLuint j = 0; j < numAttribs; j++)
+    {
+      PackAttrib(VertexAttrib(sizes[j]), srcList[j] + sizes[j]*first, sizes[j], last - first,
+                 reinterpret_cast<GLubyte*>(dst + vertexSize*first + offset),
+                 vertexSize * sizeof(GLfloat));
+      offset += sizes[j];
+    }
+  });
+}
+
+void DeinterleaveFloats(const GLfloat* src, const GLuint* sizes, GLuint numAttribs,
+                        GLuint count, GLfloat* const* dstList)
+{
+  bool hasTangents = false;
+  if (IsPhongLayout(sizes, numAttribs, hasTangents))
+  {
+    RunRanges(count, [=](GLuint first, GLuint last) {
+      if (hasTangents)
+        DeinterleavePhong<true>(src, first, last, dstList);
+      else
+        DeinterleavePhong<false>(src, first, last, dstList);
+    });
+    return;
+  }
+
+  GLuint vertexSize = 0;
+  for (GLuint j = 0; j < numAttribs; j++)
+    vertexSize += sizes[j];
+
+  RunRanges(count, [=](GLuint first, GLuint last) {
+    GLuint offset = 0;
+    for (GLuint j = 0; j < numAttribs; j++)
+    {
+      for (GLuint i = first; i < last; i++)
+      {
+        memcpy(dstList[j] + sizes[j]*i, src + vertexSize*i + offset,
+               sizes[j] * sizeof(GLfloat));
+      }
+      offset += sizes[j];
+    }
+  });
+}
+
+}  // namespace gloo.
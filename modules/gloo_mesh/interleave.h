@@ -0,0 +1,54 @@
+// + ======================================== +
+// |         gl-oo-interface library          |
+// |            Module: GLOO Mesh.            |
+// |        Author: Rodrigo Castiel, 2016.    |
+// + ======================================== +
+//
+// Interleave/deinterleave kernels for float vertex attributes.
+//
+// InterleaveFloats() turns separate attribute arrays (P0 P1 ...) (N0 N1 ...) (T0 T1 ...) into
+// interleaved vertices (P0 N0 T0) (P1 N1 T1) ..., and DeinterleaveFloats() does the opposite.
+// The common {3, 3, 2} (position, normal, uv) and {3, 3, 2, 3} (+ tangent) layouts have SIMD
+// kernels: AVX2 if the library is compiled with it (-mavx2), SSE2 on any other x86-64 build,
+// and a scalar loop otherwise. Other layouts use a generic copy loop.
+//
+// Large arrays (at least kParallelInterleaveVertices vertices) are split across threads.
+//
+// 'dst' can be a mapped buffer (glMapBufferRange() with GL_MAP_WRITE_BIT): with 'streamStores',
+// vertices aligned to 16 bytes are written with non-temporal stores, which bypass the cache
+// (mapped memory is usually write-combined and must never be read back).
+//
+// MeshGroup<Interleave> uses them in Load() and Update() when every attribute is stored as
+// kFloat32 (see group.h). The benchmark in examples/interleave_bench compares them with a
+// plain copy loop.
+
+#pragma once
+
+#include "gloo/gl_header.h"
+
+namespace gloo
+{
+
+const GLuint kParallelInterleaveVertices = 1 << 17;  // Minimum vertices per thread.
+
+// Available kernel for a layout (and the instruction set the library was compiled with).
+enum InterleaveKernel
+{
+  kInterleaveGeneric,  // Any layout.
+  kInterleaveScalar,   // {3, 3, 2} or {3, 3, 2, 3} without SIMD.
+  kInterleaveSse2,
+  kInterleaveAvx2,
+};
+
+InterleaveKernel GetInterleaveKernel(const GLuint* sizes, GLuint numAttribs);
+
+// Writes 'count' vertices into 'dst' (sum of 'sizes' floats per vertex). 'srcList[j]' holds
+// 'sizes[j]' floats per vertex.
+void InterleaveFloats(const GLfloat* const* srcList, const GLuint* sizes, GLuint numAttribs,
+                      GLuint count, GLfloat* dst, bool streamStores = false);
+
+// Splits 'count' interleaved vertices from 'src' into 'dstList'.
+void DeinterleaveFloats(const GLfloat* src, const GLuint* sizes, GLuint numAttribs,
+                        GLuint count, GLfloat* const* dstList);
+
+}  // namespace gloo.
@@ -0,0 +1,370 @@
+#include "mesh_arena.h"
+#include "index_format.h"
+#include "gloo/gpu_memory.h"
+
+#include <cassert>
+#include <iostream>
+#include <iterator>
+#include <algorithm>
+
+#define LOG_OUTPUT_ON 1
+
+namespace gloo
+{
+
+// ============================================================================================= //
+
+RangeAllocator::RangeAllocator(GLuint capacity)
+{
+  RangeAllocator::Grow(capacity);
+}
+
+GLuint RangeAllocator::Allocate(GLuint size)
+{
+  for (auto it = mFreeRanges.begin(); it != mFreeRanges.end(); ++it)
+  {
+    if (it->second < size)
+      continue;
+
+    const GLuint offset = it->first;
+    const GLuint remaining = it->second - size;
+
+    mFreeRanges.erase(it);
+    if (remaining > 0)
+      mFreeRanges[offset + size] = remaining;
+
+    mFreeSpace -= size;
+    return offset;
+  }
+
+  return kInvalidOffset;
+}
+
+void RangeAllocator::Free(GLuint offset, GLuint size)
+{
+  if (size == 0)
+    return;
+
+  assert(offset + size <= mCapacity);
+  mFreeSpace += size;
+
+  // Merge with the next free range...
+  auto next = mFreeRanges.lower_bound(offset);
+  if (next != mFreeRanges.end() && next->first == offset + size)
+  {
+    size += next->second;
+    next = mFreeRanges.erase(next);
+  }
+
+  // ... and with the previous one.
+  if (next != mFreeRanges.begin())
+  {
+    auto prev = std::prev(next);
+    assert(prev->first + prev->second <= offset);  // Double free.
+
+    if (prev->first + prev->second == offset)
+    {
+      prev->second += size;
+      return;
+    }
+  }
+
+  mFreeRanges[offset] = size;
+}
+
+void RangeAllocator::Grow(GLuint capacity)
+{
+  if (capacity <= mCapacity)
+    return;
+
+  const GLuint oldCapacity = mCapacity;
+  mCapacity = capacity;
+  RangeAllocator::Free(oldCapacity, capacity - oldCapacity);
+}
+
+void RangeAllocator::Reset(GLuint used)
+{
+  assert(used <= mCapacity);
+
+  mFreeRanges.clear();
+  mFreeSpace = 0;
+  RangeAllocator::Free(used, mCapacity - used);
+}
+
+GLuint RangeAllocator::GetLargestFreeRange() const
+{
+  GLuint largest = 0;
+  for (const std::pair<const GLuint, GLuint> & range : mFreeRanges)
+    largest = std::max(largest, range.second);
+
+  return largest;
+}
+
+// ============================================================================================= //
+
+MeshArena::MeshArena(const std::vector<VertexAttrib> & vertexAttribList, GLuint vertexCapacity,
+                     GLuint indexCapacity, GLenum indexType)
+: mVertexAttributeList(vertexAttribList)
+, mIndexType(indexType)
+, mVertexAllocator(vertexCapacity)
+, mIndexAllocator(indexCapacity)
+{
+  // Interleaved layout: (A0 B0 C0) (A1 B1 C1) ...
+  for (const VertexAttrib & attrib : mVertexAttributeList)
+  {
+    mAttribOffsets.push_back(mVertexStride);
+    mVertexStride += GetAttribBytes(attrib);
+  }
+
+  glGenBuffers(1, &mVbo);
+  glBindBuffer(GL_ARRAY_BUFFER, mVbo);
+  glBufferData(GL_ARRAY_BUFFER, vertexCapacity * mVertexStride, nullptr, GL_STATIC_DRAW);
+
+  glGenBuffers(1, &mEab);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, mEab);
+  glBufferData(GL_COPY_WRITE_BUFFER, indexCapacity * GetIndexBytes(mIndexType), nullptr,
+               GL_STATIC_DRAW);
+
+  GpuMemory::TrackBuffer(mVbo, vertexCapacity * mVertexStride, kGpuArenaBuffer,
+                         "MeshArena vertices");
+  GpuMemory::TrackBuffer(mEab, indexCapacity * GetIndexBytes(mIndexType), kGpuArenaBuffer,
+                         "MeshArena indices");
+}
+
+MeshArena::~MeshArena()
+{
+  GpuMemory::ReleaseBuffer(mVbo);
+  GpuMemory::ReleaseBuffer(mEab);
+
+  glDeleteBuffers(1, &mVbo);
+  glDeleteBuffers(1, &mEab);
+  glDeleteVertexArrays(mVaoList.size(), mVaoList.data());
+}
+
+GLuint MeshArena::AllocateVertices(GLuint count)
+{
+  return MeshArena::AllocateBlock(count, false);
+}
+
+GLuint MeshArena::AllocateIndices(GLuint count)
+{
+  return MeshArena::AllocateBlock(count, true);
+}
+
+GLuint MeshArena::ReallocateIndices(GLuint block, GLuint count)
+{
+  assert(mBlocks[block].mLive && mBlocks[block].mIsIndexBlock);
+
+  // Allocating may move the old block, so its offset is read afterwards.
+  const GLuint newBlock = MeshArena::AllocateBlock(count, true);
+  const GLuint bytes = GetIndexBytes(mIndexType);
+  const GLuint kept  = std::min(count, mBlocks[block].mSize);
+
+  glBindBuffer(GL_COPY_READ_BUFFER, mEab);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, mEab);
+  glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                      mBlocks[block].mOffset * bytes, mBlocks[newBlock].mOffset * bytes,
+                      kept * bytes);
+
+  MeshArena::Free(block);
+  return newBlock;
+}
+
+void MeshArena::Free(GLuint block)
+{
+  if (block == kInvalidArenaBlock)
+    return;
+
+  Block & b = mBlocks[block];
+  assert(b.mLive);
+
+  RangeAllocator & allocator = b.mIsIndexBlock ? mIndexAllocator : mVertexAllocator;
+  allocator.Free(b.mOffset, b.mSize);
+
+  b.mLive = false;
+  mFreeBlocks.push_back(block);
+}
+
+void MeshArena::UploadVertices(GLuint block, GLuint first, GLuint count, const void* vertices)
+{
+  const Block & b = mBlocks[block];
+  assert(b.mLive && !b.mIsIndexBlock && first + count <= b.mSize);
+
+  glBindBuffer(GL_ARRAY_BUFFER, mVbo);
+  glBufferSubData(GL_ARRAY_BUFFER, (b.mOffset + first) * mVertexStride, count * mVertexStride,
+                  vertices);
+}
+
+void MeshArena::UploadIndices(GLuint block, GLuint first, GLuint count, const GLuint* indices)
+{
+  const Block & b = mBlocks[block];
+  assert(b.mLive && b.mIsIndexBlock && first + count <= b.mSize);
+
+  const GLuint bytes = GetIndexBytes(mIndexType);
+  std::vector<GLubyte> packed(count * bytes);
+  PackIndices(mIndexType, indices, count, packed.data());
+
+  // Not bound to GL_ELEMENT_ARRAY_BUFFER: that would change the element array of the bound VAO.
+  glBindBuffer(GL_COPY_WRITE_BUFFER, mEab);
+  glBufferSubData(GL_COPY_WRITE_BUFFER, (b.mOffset + first) * bytes, packed.size(), packed.data());
+}
+
+void MeshArena::Defragment()
+{
+  MeshArena::Relocate(false, mVertexAllocator.GetCapacity(), true);
+  MeshArena::Relocate(true, mIndexAllocator.GetCapacity(), true);
+}
+
+int MeshArena::AddRenderingPass(const std::vector<std::pair<GLint, bool>> & attribList)
+{
+  assert(attribList.size() == mVertexAttributeList.size());
+
+  for (GLuint i = 0; i < mPassList.size(); i++)
+  {
+    if (mPassList[i] == attribList)
+      return i;
+  }
+
+  GLuint vao = 0;
+  glGenVertexArrays(1, &vao);
+  MeshArena::BuildVAO(vao, attribList);
+
+  mVaoList.push_back(vao);
+  mPassList.push_back(attribList);
+
+  return mVaoList.size()-1;
+}
+
+GLuint MeshArena::AllocateBlock(GLuint count, bool isIndexBlock)
+{
+  RangeAllocator & allocator = isIndexBlock ? mIndexAllocator : mVertexAllocator;
+
+  GLuint offset = allocator.Allocate(count);
+  if (offset == kInvalidOffset)
+  {
+    MeshArena::MakeRoom(count, isIndexBlock);
+    offset = allocator.Allocate(count);
+    assert(offset != kInvalidOffset);
+  }
+
+  const Block block = { offset, count, isIndexBlock, true };
+  if (mFreeBlocks.empty())
+  {
+    mBlocks.push_back(block);
+    return mBlocks.size()-1;
+  }
+
+  const GLuint handle = mFreeBlocks.back();
+  mFreeBlocks.pop_back();
+  mBlocks[handle] = block;
+  return handle;
+}
+
+void MeshArena::MakeRoom(GLuint count, bool isIndexBlock)
+{
+  const RangeAllocator & allocator = isIndexBlock ? mIndexAllocator : mVertexAllocator;
+
+  // Enough free space, but fragmented: compacting the buffer is enough.
+  if (allocator.GetFreeSpace() >= count)
+  {
+    MeshArena::Relocate(isIndexBlock, allocator.GetCapacity(), true);
+    return;
+  }
+
+  // Grow geometrically (the last free range is extended by the new space).
+  const GLuint capacity = std::max(2 * allocator.GetCapacity(), allocator.GetCapacity() + count);
+
+#if LOG_OUTPUT_ON == 1
+  std::cerr << "MeshArena: growing " << (isIndexBlock ? "index" : "vertex") << " buffer to "
+            << capacity << " elements.\n";
+#endif
+
+  MeshArena::Relocate(isIndexBlock, capacity, false);
+}
+
+void MeshArena::Relocate(bool isIndexBlock, GLuint capacity, bool compact)
+{
+  RangeAllocator & allocator = isIndexBlock ? mIndexAllocator : mVertexAllocator;
+  GLuint & buffer = isIndexBlock ? mEab : mVbo;
+  const GLuint bytes = isIndexBlock ? GetIndexBytes(mIndexType) : mVertexStride;
+
+  // Live blocks of this buffer, in address order.
+  std::vector<GLuint> blocks;
+  for (GLuint i = 0; i < mBlocks.size(); i++)
+  {
+    if (mBlocks[i].mLive && mBlocks[i].mIsIndexBlock == isIndexBlock)
+      blocks.push_back(i);
+  }
+
+  std::sort(blocks.begin(), blocks.end(), [this](GLuint a, GLuint b) {
+    return mBlocks[a].mOffset < mBlocks[b].mOffset;
+  });
+
+  GLuint newBuffer = 0;
+  glGenBuffers(1, &newBuffer);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+  glBufferData(GL_COPY_WRITE_BUFFER, capacity * bytes, nullptr, GL_STATIC_DRAW);
+  glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+
+  GLuint end = 0;  // End of the last copied block (compaction).
+  for (GLuint i : blocks)
+  {
+    Block & block = mBlocks[i];
+    const GLuint offset = compact ? end : block.mOffset;
+
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, block.mOffset * bytes,
+                        offset * bytes, block.mSize * bytes);
+
+    block.mOffset = offset;
+    end = offset + block.mSize;
+  }
+
+  GpuMemory::ReleaseBuffer(buffer);
+  GpuMemory::TrackBuffer(newBuffer, capacity * bytes, kGpuArenaBuffer,
+                         isIndexBlock ? "MeshArena indices" : "MeshArena vertices");
+
+  glDeleteBuffers(1, &buffer);
+  buffer = newBuffer;
+
+  if (compact)
+  {
+    allocator.Reset(end);
+  }
+  else
+  {
+    allocator.Grow(capacity);
+  }
+
+  // The VAOs still reference the old buffer.
+  for (GLuint i = 0; i < mVaoList.size(); i++)
+    MeshArena::BuildVAO(mVaoList[i], mPassList[i]);
+}
+
+void MeshArena::BuildVAO(GLuint vao, const std::vector<std::pair<GLint, bool>> & attribList) const
+{
+  glBindVertexArray(vao);
+  glBindBuffer(GL_ARRAY_BUFFER, mVbo);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mEab);
+
+  for (GLuint j = 0; j < mVertexAttributeList.size(); j++)
+  {
+    const VertexAttrib & attrib = mVertexAttributeList[j];
+    const GLint loc   = attribList[j].first;
+    const bool active = attribList[j].second;
+
+    if ((attrib.mSize > 0) && active)
+    {
+      glVertexAttribPointer(loc, GetAttribComponents(attrib), GetAttribType(attrib.mFormat),
+        IsAttribNormalized(attrib.mFormat), mVertexStride, (void*)(GLintptr)mAttribOffsets[j]);
+      glEnableVertexAttribArray(loc);
+    }
+    else if (loc != -1)
+    {
+      glDisableVertexAttribArray(loc);
+    }
+  }
+
+  glBindVertexArray(0);
+}
+
+}  // namespace gloo.
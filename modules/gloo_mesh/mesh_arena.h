@@ -0,0 +1,170 @@
+// + ======================================== +
+// |         gl-oo-interface library          |
+// |            Module: GLOO Mesh.            |
+// |        Author: Rodrigo Castiel, 2016.    |
+// + ======================================== +
+//
+// MeshArena stores the vertices and indices of many MeshGroups in two large buffers.
+//
+// Each MeshGroup normally owns a VBO, an EAB and one VAO per rendering pass, so thousands of
+// small meshes mean thousands of buffer objects and a VAO switch per draw. Groups attached to
+// an arena (MeshGroup::SetArena()) get a block of vertices and a block of indices inside the
+// arena buffers instead, and are drawn with glDrawElementsBaseVertex() (indices are relative
+// to the first vertex of the group). All of them share the arena VAOs, one per distinct
+// rendering pass (attribute locations).
+//
+// Blocks are suballocated with a first-fit free list (RangeAllocator) that merges adjacent free
+// ranges. When a block doesn't fit, the arena is compacted (Defragment()) if that frees enough
+// contiguous space, or grown otherwise. Both operations copy the data on the GPU and move
+// blocks, so groups query their offsets (GetBlockOffset()) every time they are drawn.
+//
+// Vertices are interleaved (see MeshGroup<Interleave>) and every group of an arena must have
+// the same attribute list and use the arena index type.
+//
+// [USAGE]
+/*
+    MeshArena* arena = new MeshArena({{3}, {3, kSnorm2_10_10_10}, {2, kUnorm16}});
+
+    MeshGroup<Interleave>* mesh = new MeshGroup<Interleave>(numVertices, numIndices, GL_TRIANGLES);
+    mesh->SetVertexAttribList(arena->GetVertexAttribList());
+    mesh->SetArena(arena);
+    mesh->AddRenderingPass({{posLoc, true}, {normalLoc, true}, {uvLoc, true}});
+    mesh->Load(vertices, indices);
+    ...
+    delete mesh;   // Frees its blocks.
+    delete arena;  // After all of its groups.
+*/
+
+#pragma once
+
+#include "gloo/gl_header.h"
+#include "vertex_format.h"
+
+#include <map>
+#include <vector>
+#include <utility>
+
+namespace gloo
+{
+
+// Returned by RangeAllocator::Allocate() on failure and used for "no block".
+const GLuint kInvalidOffset = ~0u;
+const GLuint kInvalidArenaBlock = ~0u;
+
+// Default arena capacities (grown on demand).
+const GLuint kDefaultArenaVertices = 1 << 16;
+const GLuint kDefaultArenaIndices  = 1 << 18;
+
+// First-fit suballocator of [0, capacity) that merges adjacent free ranges.
+class RangeAllocator
+{
+public:
+  explicit RangeAllocator(GLuint capacity = 0);
+
+  // Returns the offset of 'size' free units, or kInvalidOffset if no free range is large enough.
+  GLuint Allocate(GLuint size);
+  void Free(GLuint offset, GLuint size);
+
+  // Extends the range to [0, capacity).
+  void Grow(GLuint capacity);
+
+  // Marks [0, used) as allocated and [used, capacity) as free (after compaction).
+  void Reset(GLuint used);
+
+  GLuint GetCapacity() const { return mCapacity; }
+  GLuint GetFreeSpace() const { return mFreeSpace; }
+  GLuint GetLargestFreeRange() const;
+  GLuint GetNumFreeRanges() const { return mFreeRanges.size(); }
+
+private:
+  std::map<GLuint, GLuint> mFreeRanges;  // Offset -> size (never adjacent).
+  GLuint mCapacity  { 0 };
+  GLuint mFreeSpace { 0 };
+};
+
+class MeshArena
+{
+public:
+  MeshArena(const std::vector<VertexAttrib> & vertexAttribList,
+            GLuint vertexCapacity = kDefaultArenaVertices,
+            GLuint indexCapacity  = kDefaultArenaIndices,
+            GLenum indexType = GL_UNSIGNED_INT);
+
+  ~MeshArena();
+
+  // The arena owns its buffers (and groups point to it).
+  MeshArena(const MeshArena &) = delete;
+  MeshArena & operator=(const MeshArena &) = delete;
+
+  // Allocates a block of 'count' vertices/indices and returns its handle.
+  GLuint AllocateVertices(GLuint count);
+  GLuint AllocateIndices(GLuint count);
+
+  // Moves an index block into a block of 'count' indices, keeping its first indices.
+  // Returns the new handle (the old one is freed).
+  GLuint ReallocateIndices(GLuint block, GLuint count);
+
+  void Free(GLuint block);
+
+  // Writes vertices (interleaved, already packed) or indices (converted to the index type)
+  // into a block, starting at element 'first'.
+  void UploadVertices(GLuint block, GLuint first, GLuint count, const void* vertices);
+  void UploadIndices(GLuint block, GLuint first, GLuint count, const GLuint* indices);
+
+  // Moves all blocks to the beginning of the buffers (removes free ranges between them).
+  void Defragment();
+
+  // Returns the index of the (shared) VAO that maps the arena attributes to 'attribList'.
+  // Identical attribute lists get the same VAO.
+  int AddRenderingPass(const std::vector<std::pair<GLint, bool>> & attribList);
+
+  // Getters.
+  GLuint GetBlockOffset(GLuint block) const { return mBlocks[block].mOffset; }
+  GLuint GetBlockSize(GLuint block) const   { return mBlocks[block].mSize;   }
+  GLuint GetVertexBuffer() const { return mVbo; }
+  GLuint GetIndexBuffer()  const { return mEab; }
+  GLuint GetVao(int renderingPass) const { return mVaoList[renderingPass]; }
+  GLenum GetIndexType() const { return mIndexType; }
+  GLuint GetVertexStride() const { return mVertexStride; }
+  const std::vector<VertexAttrib> & GetVertexAttribList() const { return mVertexAttributeList; }
+  const RangeAllocator & GetVertexAllocator() const { return mVertexAllocator; }
+  const RangeAllocator & GetIndexAllocator()  const { return mIndexAllocator;  }
+
+private:
+  struct Block
+  {
+    GLuint mOffset;  // In vertices or indices.
+    GLuint mSize;
+    bool mIsIndexBlock;
+    bool mLive;
+  };
+
+  GLuint AllocateBlock(GLuint count, bool isIndexBlock);
+
+  // Makes room for 'count' units in the vertex/index buffer (compacting or growing it).
+  void MakeRoom(GLuint count, bool isIndexBlock);
+
+  // Copies the live blocks of one buffer into a new buffer of 'capacity' units, either at the
+  // same offsets (growth) or packed at the beginning (compaction).
+  void Relocate(bool isIndexBlock, GLuint capacity, bool compact);
+
+  // Specifies the attribute pointers and buffers of a VAO.
+  void BuildVAO(GLuint vao, const std::vector<std::pair<GLint, bool>> & attribList) const;
+
+  std::vector<VertexAttrib> mVertexAttributeList;
+  std::vector<GLuint> mAttribOffsets;
+  GLuint mVertexStride { 0 };
+  GLenum mIndexType;
+
+  GLuint mVbo { 0 };
+  GLuint mEab { 0 };
+  std::vector<GLuint> mVaoList;
+  std::vector<std::vector<std::pair<GLint, bool>>> mPassList;  // Attribute list of each VAO.
+
+  RangeAllocator mVertexAllocator;
+  RangeAllocator mIndexAllocator;
+  std::vector<Block> mBlocks;
+  std::vector<GLuint> mFreeBlocks;  // Unused handles.
+};
+
+}  // namespace gloo.
@@ -0,0 +1,400 @@
+#include "mesh_cache.h"
+#include "index_format.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <cassert>
+#include <iostream>
+
+#define LOG_OUTPUT_ON 1
+
+namespace gloo
+{
+
+namespace
+{
+  GLuint AlignOffset(GLuint offset)
+  {
+    return (offset + kMeshCacheAlignment - 1) / kMeshCacheAlignment * kMeshCacheAlignment;
+  }
+
+  // True if [offset, offset + bytes) lies inside a file of 'size' bytes.
+  bool IsSectionValid(GLuint offset, unsigned long long bytes, size_t size)
+  {
+    return (offset % kMeshCacheAlignment == 0) && (offset + bytes <= size);
+  }
+
+  bool IsIndexTypeValid(GLenum type)
+  {
+    return type == GL_NONE || type == GL_UNSIGNED_BYTE || type == GL_UNSIGNED_SHORT
+        || type == GL_UNSIGNED_INT;
+  }
+
+  bool IsDrawModeValid(GLenum drawMode)
+  {
+    switch (drawMode)
+    {
+      case GL_POINTS:
+      case GL_LINES:
+      case GL_LINE_LOOP:
+      case GL_LINE_STRIP:
+      case GL_TRIANGLES:
+      case GL_TRIANGLE_STRIP:
+      case GL_TRIANGLE_FAN:
+      case GL_LINES_ADJACENCY:
+      case GL_LINE_STRIP_ADJACENCY:
+      case GL_TRIANGLES_ADJACENCY:
+      case GL_TRIANGLE_STRIP_ADJACENCY:
+      case GL_PATCHES:
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  // Writes 'bytes' bytes at the next aligned offset of 'file' (zero padding) and returns it.
+  GLuint WriteSection(FILE* file, const void* data, size_t bytes, GLuint & fileBytes)
+  {
+    static const GLubyte kPadding[kMeshCacheAlignment] = { 0 };
+
+    const GLuint offset = AlignOffset(fileBytes);
+    fwrite(kPadding, 1, offset - fileBytes, file);
+    if (bytes > 0)
+      fwrite(data, 1, bytes, file);
+
+    fileBytes = offset + bytes;
+    return offset;
+  }
+
+  void LogError(const std::string & path, const char* message)
+  {
+#if LOG_OUTPUT_ON == 1
+    std::cerr << "MeshCache: " << path << ": " << message << std::endl;
+#endif
+  }
+}  // namespace.
+
+// ============================================================================================= //
+
+MeshCache::~MeshCache()
+{
+  MeshCache::Close();
+}
+
+bool MeshCache::Open(const std::string & path)
+{
+  MeshCache::Close();
+
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1)
+  {
+    LogError(path, "could not open file.");
+    return false;
+  }
+
+  struct stat status;
+  if (fstat(fd, &status) != 0 || status.st_size < static_cast<off_t>(sizeof(MeshCacheHeader)))
+  {
+    LogError(path, "not a mesh cache.");
+    close(fd);
+    return false;
+  }
+
+  // The mapping stays valid after closing the file.
+  void* data = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+
+  if (data == MAP_FAILED)
+  {
+    LogError(path, "could not map file.");
+    return false;
+  }
+
+  mData = data;
+  mSize = status.st_size;
+
+  // Check the header and that every section lies inside the file.
+  const MeshCacheHeader & header = MeshCache::GetHeader();
+  const bool indexed = header.mIndexType != GL_NONE;
+  const unsigned long long indexBytes = (!indexed || !IsIndexTypeValid(header.mIndexType)) ? 0
+                                      : gloo::GetIndexBytes(header.mIndexType);
+
+  bool valid = memcmp(header.mMagic, kMeshCacheMagic, sizeof(kMeshCacheMagic)) == 0
+            && header.mVersion == kMeshCacheVersion
+            && header.mHeaderBytes == sizeof(MeshCacheHeader)
+            && header.mFileBytes == mSize
+            && IsIndexTypeValid(header.mIndexType)
+            && IsDrawModeValid(header.mDrawMode)
+            && header.mNumElements <= (indexed ? header.mNumStoredIndices : header.mNumVertices)
+            && IsSectionValid(header.mAttribOffset,
+                              1ull * header.mNumAttributes * sizeof(MeshCacheAttrib), mSize)
+            && IsSectionValid(header.mLodOffset, 1ull * header.mNumLods * sizeof(LodLevel), mSize)
+            && IsSectionValid(header.mVertexOffset, 1ull * header.mNumVertices * header.mVertexStride,
+                              mSize)
+            && IsSectionValid(header.mIndexOffset, header.mNumStoredIndices * indexBytes, mSize);
+
+  // The attribute layout must match the stored vertices.
+  if (valid)
+  {
+    GLuint stride = 0;
+    for (const VertexAttrib & attrib : MeshCache::GetVertexAttribList())
+    {
+      valid = valid && attrib.mFormat <= kUint8;
+      stride += GetAttribBytes(attrib);
+    }
+
+    valid = valid && stride == header.mVertexStride;
+  }
+
+  // Levels of detail must lie inside the stored indices.
+  if (valid)
+  {
+    const LodLevel* lodLevels = MeshCache::GetLodLevels();
+    for (GLuint i = 0; i < header.mNumLods; i++)
+    {
+      valid = valid && 1ull * lodLevels[i].mFirstIndex + lodLevels[i].mNumIndices
+                       <= header.mNumStoredIndices;
+    }
+  }
+
+  if (!valid)
+  {
+    LogError(path, "invalid or incompatible mesh cache.");
+    MeshCache::Close();
+    return false;
+  }
+
+  return true;
+}
+
+void MeshCache::Close()
+{
+  if (mData)
+    munmap(mData, mSize);
+
+  mData = nullptr;
+  mSize = 0;
+}
+
+std::vector<VertexAttrib> MeshCache::GetVertexAttribList() const
+{
+  std::vector<VertexAttrib> vertexAttribList;
+
+  const MeshCacheAttrib* attribs = MeshCache::GetAttribs();
+  for (GLuint j = 0; j < MeshCache::GetHeader().mNumAttributes; j++)
+    vertexAttribList.emplace_back(attribs[j].mSize, static_cast<AttribFormat>(attribs[j].mFormat));
+
+  return vertexAttribList;
+}
+
+const MeshCacheAttrib* MeshCache::GetAttribs() const
+{
+  return static_cast<const MeshCacheAttrib*>(MeshCache::GetSection(GetHeader().mAttribOffset));
+}
+
+const LodLevel* MeshCache::GetLodLevels() const
+{
+  return static_cast<const LodLevel*>(MeshCache::GetSection(GetHeader().mLodOffset));
+}
+
+const void* MeshCache::GetVertices() const
+{
+  return MeshCache::GetSection(GetHeader().mVertexOffset);
+}
+
+const void* MeshCache::GetIndices() const
+{
+  return MeshCache::GetSection(GetHeader().mIndexOffset);
+}
+
+GLuint MeshCache::GetVertexDataBytes() const
+{
+  return GetHeader().mNumVertices * GetHeader().mVertexStride;
+}
+
+GLuint MeshCache::GetIndexDataBytes() const
+{
+  const MeshCacheHeader & header = MeshCache::GetHeader();
+  return (header.mIndexType == GL_NONE) ? 0
+         : header.mNumStoredIndices * gloo::GetIndexBytes(header.mIndexType);
+}
+
+const void* MeshCache::GetSection(GLuint offset) const
+{
+  assert(mData && offset <= mSize);
+  return static_cast<const GLubyte*>(mData) + offset;
+}
+
+// ============================================================================================= //
+
+void PackMesh(const std::vector<VertexAttrib> & vertexAttribList, const GLfloat* vertices,
+              GLuint numVertices, const GLuint* indices, GLuint numIndices, GLenum drawMode,
+              const MeshCacheOptions & options, PackedMesh & mesh)
+{
+  assert(options.mPositionAttrib < vertexAttribList.size());
+
+  MeshCacheHeader & header = mesh.mHeader;
+  memset(&header, 0, sizeof(MeshCacheHeader));
+  memcpy(header.mMagic, kMeshCacheMagic, sizeof(kMeshCacheMagic));
+  header.mVersion = kMeshCacheVersion;
+  header.mHeaderBytes = sizeof(MeshCacheHeader);
+  header.mFlags = options.mPrimitiveRestart ? kMeshCachePrimitiveRestart : 0;
+  header.mDrawMode = drawMode;
+  header.mNumVertices = numVertices;
+  header.mNumElements = indices ? numIndices : numVertices;
+  header.mNumAttributes = vertexAttribList.size();
+
+  // Raw layout: interleaved floats (see MeshGroup<Interleave>::Load()).
+  std::vector<GLuint> attribOffsets;
+  GLuint vertexSize = 0;
+  GLuint positionOffset = 0;
+
+  for (GLuint j = 0; j < vertexAttribList.size(); j++)
+  {
+    const VertexAttrib & attrib = vertexAttribList[j];
+    if (j == options.mPositionAttrib)
+      positionOffset = vertexSize;
+
+    attribOffsets.push_back(header.mVertexStride);
+    vertexSize += attrib.mSize;
+    header.mVertexStride += GetAttribBytes(attrib);
+  }
+
+  const GLfloat* positions = vertices + positionOffset;
+  header.mBoundingRadius = ComputeMeshRadius(positions, vertexSize, numVertices,
+                                             header.mBoundingCenter);
+
+  // Optimize indices (same passes as MeshGroup::Load(), see mesh_optimizer.h).
+  std::vector<GLuint> elements;
+  std::vector<LodLevel> & lodLevels = mesh.mLodLevels;
+  std::vector<GLuint> remap;
+
+  mesh.mVertexAttribList = vertexAttribList;
+  lodLevels.clear();
+
+  if (indices)
+  {
+    elements.assign(indices, indices + numIndices);
+
+    if (drawMode == GL_TRIANGLES && options.mVertexCacheSize > 0)
+    {
+      OptimizeVertexCache(elements.data(), numIndices, numVertices, options.mVertexCacheSize);
+
+      if (options.mOverdrawThreshold > 0.0f)
+      {
+        OptimizeOverdraw(elements.data(), numIndices, positions, vertexSize, numVertices,
+                         options.mOverdrawThreshold, options.mVertexCacheSize);
+      }
+    }
+
+    if (drawMode == GL_TRIANGLES && !options.mLodTargetErrors.empty())
+    {
+      BuildLodChain(elements, positions, vertexSize, numVertices, options.mLodTargetErrors,
+                    lodLevels);
+
+      for (GLuint l = 1; l < lodLevels.size() && options.mVertexCacheSize > 0; l++)
+      {
+        OptimizeVertexCache(&elements[lodLevels[l].mFirstIndex], lodLevels[l].mNumIndices,
+                            numVertices, options.mVertexCacheSize);
+      }
+
+      if (lodLevels.size() < 2)
+        lodLevels.clear();
+    }
+
+    if (drawMode == GL_TRIANGLES && options.mVertexCacheSize > 0)
+    {
+      OptimizeVertexFetch(elements.data(), numIndices, numVertices, remap);
+
+      for (GLuint i = numIndices; i < elements.size(); i++)
+        elements[i] = remap[elements[i]];
+    }
+
+    header.mNumStoredIndices = elements.size();
+    header.mIndexType = SelectIndexType(numVertices, options.mAllowByteIndices,
+                                        options.mPrimitiveRestart);
+  }
+  else
+  {
+    header.mIndexType = GL_NONE;
+  }
+
+  header.mNumLods = lodLevels.size();
+
+  // Pack vertices into their storage formats, in their final order.
+  std::vector<GLubyte> & packed = mesh.mVertices;
+  packed.assign(numVertices * header.mVertexStride, 0);
+  for (GLuint j = 0, offset = 0; j < vertexAttribList.size(); j++)
+  {
+    PackAttrib(vertexAttribList[j], vertices + offset, vertexSize, numVertices,
+               &packed[attribOffsets[j]], header.mVertexStride);
+    offset += vertexAttribList[j].mSize;
+  }
+
+  if (!remap.empty())
+  {
+    std::vector<GLubyte> remapped(packed.size());
+    RemapVertices(packed.data(), header.mVertexStride, header.mVertexStride, numVertices, remap,
+                  remapped.data());
+    packed.swap(remapped);
+  }
+
+  mesh.mIndices.clear();
+  if (indices)
+  {
+    mesh.mIndices.resize(elements.size() * GetIndexBytes(header.mIndexType));
+    PackIndices(header.mIndexType, elements.data(), elements.size(), mesh.mIndices.data());
+  }
+}
+
+bool BuildMeshCache(const std::string & path, const std::vector<VertexAttrib> & vertexAttribList,
+                    const GLfloat* vertices, GLuint numVertices, const GLuint* indices,
+                    GLuint numIndices, GLenum drawMode, const MeshCacheOptions & options)
+{
+  PackedMesh mesh;
+  PackMesh(vertexAttribList, vertices, numVertices, indices, numIndices, drawMode, options, mesh);
+
+  MeshCacheHeader & header = mesh.mHeader;
+  std::vector<MeshCacheAttrib> attribs;
+  for (const VertexAttrib & attrib : vertexAttribList)
+    attribs.push_back({attrib.mSize, static_cast<GLuint>(attrib.mFormat)});
+
+  // Write sections after the header, then the header (now with their offsets).
+  FILE* file = fopen(path.c_str(), "wb");
+  if (!file)
+  {
+    LogError(path, "could not create file.");
+    return false;
+  }
+
+  GLuint fileBytes = sizeof(MeshCacheHeader);
+  fseek(file, fileBytes, SEEK_SET);
+
+  header.mAttribOffset = WriteSection(file, attribs.data(),
+                                      attribs.size() * sizeof(MeshCacheAttrib), fileBytes);
+  header.mLodOffset    = WriteSection(file, mesh.mLodLevels.data(),
+                                      mesh.mLodLevels.size() * sizeof(LodLevel), fileBytes);
+  header.mVertexOffset = WriteSection(file, mesh.mVertices.data(), mesh.mVertices.size(),
+                                      fileBytes);
+  header.mIndexOffset  = WriteSection(file, mesh.mIndices.data(), mesh.mIndices.size(),
+                                      fileBytes);
+  header.mFileBytes = fileBytes;
+
+  fseek(file, 0, SEEK_SET);
+  fwrite(&header, sizeof(MeshCacheHeader), 1, file);
+
+  const bool success = !ferror(file);
+  fclose(file);
+
+  if (!success)
+    LogError(path, "could not write file.");
+
+  return success;
+}
+
+}  // namespace gloo.
@@ -0,0 +1,161 @@
+// + ======================================== +
+// |         gl-oo-interface library          |
+// |            Module: GLOO Mesh.            |
+// |        Author: Rodrigo Castiel, 2016.    |
+// + ======================================== +
+//
+// Binary mesh cache (.gloomesh files).
+//
+// Building a group on startup means generating or parsing geometry, optimizing its indices and
+// packing its vertices, every time. A mesh cache stores the result instead: vertices already
+// interleaved and packed (see vertex_format.h), indices already optimized and stored with their
+// final type (see index_format.h), levels of detail, attribute layout and bounding sphere.
+//
+// MeshCache maps a file into memory (mmap) and validates it. Its vertex and index sections are
+// handed to glBufferData() as they are by MeshGroup::LoadFromCache(), with no intermediate copy.
+// BuildMeshCache() runs the optimization passes offline and writes a file (see
+// examples/mesh_converter, which converts Wavefront .obj models).
+//
+// [File layout]
+//   MeshCacheHeader
+//   MeshCacheAttrib[mNumAttributes]
+//   LodLevel[mNumLods]
+//   Vertex data (mNumVertices * mVertexStride bytes, interleaved)
+//   Index data (mNumStoredIndices indices of type mIndexType)
+// Sections start at the offsets recorded in the header (aligned to kMeshCacheAlignment).
+// Values are stored with the byte order of the machine that wrote the file.
+//
+// [USAGE]
+/*
+    // Offline.
+    MeshCacheOptions options;
+    options.mLodTargetErrors = {0.01f, 0.05f};
+    BuildMeshCache("bunny.gloomesh", {{3}, {3, kSnorm2_10_10_10}, {2, kUnorm16}}, vertices,
+                   numVertices, indices, numIndices, GL_TRIANGLES, options);
+
+    // On startup.
+    MeshGroup<Interleave>* mesh = new MeshGroup<Interleave>(0, 0);
+    if (mesh->LoadFromCache("bunny.gloomesh"))
+      mesh->AddRenderingPass({{posLoc, true}, {normalLoc, true}, {uvLoc, true}});
+*/
+
+#pragma once
+
+#include "gloo/gl_header.h"
+#include "vertex_format.h"
+#include "mesh_optimizer.h"
+#include "mesh_simplifier.h"
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace gloo
+{
+
+const char kMeshCacheMagic[8] = {'G', 'L', 'O', 'O', 'M', 'E', 'S', 'H'};
+const GLuint kMeshCacheVersion = 1;
+const GLuint kMeshCacheAlignment = 16;
+
+// Header flags.
+const GLuint kMeshCachePrimitiveRestart = 1 << 0;  // Indices contain restart indices.
+
+struct MeshCacheHeader
+{
+  char mMagic[8];            // kMeshCacheMagic.
+  GLuint mVersion;           // kMeshCacheVersion.
+  GLuint mHeaderBytes;       // sizeof(MeshCacheHeader).
+  GLuint mFlags;
+  GLenum mDrawMode;
+  GLenum mIndexType;         // GL_NONE if the group isn't indexed.
+  GLuint mNumVertices;
+  GLuint mNumElements;       // Indices of the first level of detail (vertices if not indexed).
+  GLuint mNumStoredIndices;  // Indices of all levels of detail.
+  GLuint mNumAttributes;
+  GLuint mNumLods;           // 0 if the group has a single level of detail.
+  GLuint mVertexStride;      // Bytes per vertex.
+  GLfloat mBoundingCenter[3];
+  GLfloat mBoundingRadius;
+
+  // Section offsets (bytes from the beginning of the file) and file size.
+  GLuint mAttribOffset;
+  GLuint mLodOffset;
+  GLuint mVertexOffset;
+  GLuint mIndexOffset;
+  GLuint mFileBytes;
+};
+
+struct MeshCacheAttrib
+{
+  GLuint mSize;    // Number of components.
+  GLuint mFormat;  // AttribFormat.
+};
+
+// Read-only view of a mapped cache file.
+class MeshCache
+{
+public:
+  MeshCache() { }
+  ~MeshCache();
+
+  // Maps 'path' and checks its header and sections. Returns false if it isn't a valid cache.
+  bool Open(const std::string & path);
+  void Close();
+
+  bool IsOpen() const { return mData != nullptr; }
+
+  // Getters (the cache must be open).
+  const MeshCacheHeader & GetHeader() const { return *static_cast<const MeshCacheHeader*>(mData); }
+  std::vector<VertexAttrib> GetVertexAttribList() const;
+  const MeshCacheAttrib* GetAttribs() const;
+  const LodLevel* GetLodLevels() const;
+  const void* GetVertices() const;  // Interleaved vertex data.
+  const void* GetIndices() const;   // Element array (all levels of detail).
+  GLuint GetVertexDataBytes() const;
+  GLuint GetIndexDataBytes() const;
+
+private:
+  MeshCache(const MeshCache &) = delete;
+  MeshCache & operator=(const MeshCache &) = delete;
+
+  const void* GetSection(GLuint offset) const;
+
+  void* mData { nullptr };  // Mapped file.
+  size_t mSize { 0 };
+};
+
+// Offline processing applied by BuildMeshCache() (see MeshGroup for each pass).
+struct MeshCacheOptions
+{
+  GLuint mVertexCacheSize { kDefaultVertexCacheSize };       // 0 = no vertex cache optimization.
+  GLfloat mOverdrawThreshold { kDefaultOverdrawThreshold };  // 0 = no overdraw optimization.
+  std::vector<GLfloat> mLodTargetErrors;                     // Empty = single level of detail.
+  GLuint mPositionAttrib { 0 };
+  bool mAllowByteIndices { false };
+  bool mPrimitiveRestart { false };
+};
+
+// Mesh as stored in a cache file, in memory: ready to be uploaded by MeshGroup::LoadPacked().
+struct PackedMesh
+{
+  MeshCacheHeader mHeader;  // Section offsets and file size are unused.
+  std::vector<VertexAttrib> mVertexAttribList;
+  std::vector<LodLevel> mLodLevels;
+  std::vector<GLubyte> mVertices;
+  std::vector<GLubyte> mIndices;
+};
+
+// Runs the passes of BuildMeshCache() into 'mesh'. Uses no OpenGL calls, so it can run on any
+// thread (see mesh_loader.h).
+void PackMesh(const std::vector<VertexAttrib> & vertexAttribList, const GLfloat* vertices,
+              GLuint numVertices, const GLuint* indices, GLuint numIndices, GLenum drawMode,
+              const MeshCacheOptions & options, PackedMesh & mesh);
+
+// Optimizes and packs a mesh and writes it to 'path'. 'vertices' holds interleaved floats
+// (as passed to MeshGroup<Interleave>::Load()) and 'indices' may be nullptr.
+bool BuildMeshCache(const std::string & path, const std::vector<VertexAttrib> & vertexAttribList,
+                    const GLfloat* vertices, GLuint numVertices, const GLuint* indices,
+                    GLuint numIndices, GLenum drawMode,
+                    const MeshCacheOptions & options = MeshCacheOptions());
+
+}  // namespace gloo.
@@ -0,0 +1,174 @@
+#include "mesh_loader.h"
+
+#include <chrono>
+#include <cassert>
+#include <algorithm>
+#include <iostream>
+
+#define LOG_OUTPUT_ON 1
+
+namespace gloo
+{
+
+MeshLoader::MeshLoader(GLuint numWorkers)
+{
+  if (numWorkers == 0)
+  {
+    const GLuint numThreads = std::thread::hardware_concurrency();
+    numWorkers = std::max<GLuint>(numThreads, 2) - 1;
+  }
+
+  for (GLuint i = 0; i < numWorkers; i++)
+    mWorkers.emplace_back(&MeshLoader::RunWorker, this);
+}
+
+MeshLoader::~MeshLoader()
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStopping = true;
+  }
+
+  mBuildCondition.notify_all();
+  for (std::thread & worker : mWorkers)
+    worker.join();
+}
+
+void MeshLoader::Submit(MeshGroup<Interleave>* group, const BuildTask & build,
+                        const UploadCallback & onUploaded)
+{
+  assert(group && build);
+
+  std::unique_ptr<Request> request(new Request { group, build, onUploaded, PackedMesh(), false });
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mBuildQueue.push_back(std::move(request));
+  }
+
+  mBuildCondition.notify_one();
+}
+
+void MeshLoader::Cancel(const MeshGroup<Interleave>* group)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+
+  auto isGroupRequest = [group](const std::unique_ptr<Request> & request) {
+    return request->mGroup == group;
+  };
+
+  mBuildQueue.erase(std::remove_if(mBuildQueue.begin(), mBuildQueue.end(), isGroupRequest),
+                    mBuildQueue.end());
+  mUploadQueue.erase(std::remove_if(mUploadQueue.begin(), mUploadQueue.end(), isGroupRequest),
+                     mUploadQueue.end());
+
+  // Running tasks are dropped when they finish.
+  for (Request* request : mBuilding)
+  {
+    if (request->mGroup == group)
+      request->mCancelled = true;
+  }
+}
+
+GLuint MeshLoader::ProcessUploads(double budgetMs)
+{
+  typedef std::chrono::steady_clock Clock;
+  const Clock::time_point start = Clock::now();
+
+  GLuint numUploads = 0;
+  while (true)
+  {
+    std::unique_ptr<Request> request;
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      if (mUploadQueue.empty())
+        break;
+
+      request = std::move(mUploadQueue.front());
+      mUploadQueue.pop_front();
+    }
+
+    // The lock is released, so callbacks may submit new requests.
+    if (request->mGroup->LoadPacked(request->mMesh))
+    {
+      if (request->mOnUploaded)
+        request->mOnUploaded(request->mGroup);
+    }
+    else
+    {
+#if LOG_OUTPUT_ON == 1
+      std::cerr << "MeshLoader: mesh doesn't match the attribute list of its group." << std::endl;
+#endif
+    }
+
+    numUploads++;
+
+    const std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+    if (elapsed.count() >= budgetMs)
+      break;
+  }
+
+  return numUploads;
+}
+
+bool MeshLoader::IsPending(const MeshGroup<Interleave>* group) const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+
+  auto isGroupRequest = [group](const std::unique_ptr<Request> & request) {
+    return request->mGroup == group;
+  };
+
+  return std::any_of(mBuildQueue.begin(), mBuildQueue.end(), isGroupRequest)
+      || std::any_of(mUploadQueue.begin(), mUploadQueue.end(), isGroupRequest)
+      || std::any_of(mBuilding.begin(), mBuilding.end(), [group](const Request* request) {
+           return request->mGroup == group && !request->mCancelled;
+         });
+}
+
+GLuint MeshLoader::GetNumPending() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+
+  const GLuint numBuilding = std::count_if(mBuilding.begin(), mBuilding.end(),
+                                           [](const Request* request) {
+                                             return !request->mCancelled;
+                                           });
+
+  return mBuildQueue.size() + numBuilding + mUploadQueue.size();
+}
+
+void MeshLoader::RunWorker()
+{
+  while (true)
+  {
+    std::unique_ptr<Request> request;
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mBuildCondition.wait(lock, [this] { return mStopping || !mBuildQueue.empty(); });
+      if (mStopping)
+        return;
+
+      request = std::move(mBuildQueue.front());
+      mBuildQueue.pop_front();
+      mBuilding.push_back(request.get());
+    }
+
+    const bool success = request->mBuild(request->mMesh);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mBuilding.erase(std::find(mBuilding.begin(), mBuilding.end(), request.get()));
+
+    if (!success)
+    {
+#if LOG_OUTPUT_ON == 1
+      std::cerr << "MeshLoader: build task failed." << std::endl;
+#endif
+    }
+    else if (!request->mCancelled)
+    {
+      mUploadQueue.push_back(std::move(request));
+    }
+  }
+}
+
+}  // namespace gloo.
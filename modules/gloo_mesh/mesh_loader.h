@@ -0,0 +1,121 @@
+// + ======================================== +
+// |         gl-oo-interface library          |
+// |            Module: GLOO Mesh.            |
+// |        Author: Rodrigo Castiel, 2016.    |
+// + ======================================== +
+//
+// MeshLoader builds meshes on worker threads and uploads them on the GL thread.
+//
+// Generating geometry, interleaving it and running the optimization passes of Load() can take
+// much longer than a frame for large meshes (or many small ones), and freezes the window if
+// it's done while initializing a model. A MeshLoader splits this work in two:
+//   1. A build task runs on a worker thread. It generates the vertices and indices and packs
+//      them with PackMesh() (see mesh_cache.h). It must not use OpenGL.
+//   2. ProcessUploads(), called once per frame on the GL thread, uploads finished meshes with
+//      MeshGroup::LoadPacked() until a time budget (in milliseconds) is spent, and calls their
+//      upload callbacks.
+// A group becomes renderable once its upload callback is called (that's where rendering passes
+// are usually added). GlutApplication owns a MeshLoader and processes its uploads every frame
+// (see GlutApplication::GetMeshLoader()).
+//
+// Submitted groups must not be deleted before they're uploaded, unless they're cancelled first.
+//
+// [USAGE]
+/*
+    // In ModelBase::Init().
+    mMesh = new MeshGroup<Interleave>(0, 0);
+    GlutApplication::GetMeshLoader()->Submit(mMesh,
+      [](PackedMesh & mesh)  // Worker thread.
+      {
+        std::vector<GLfloat> vertices;  // Interleaved {position, normal, uv}.
+        std::vector<GLuint> indices;
+        ...
+        PackMesh({{3}, {3, kSnorm2_10_10_10}, {2, kUnorm16}}, vertices.data(),
+                 vertices.size()/8, indices.data(), indices.size(), GL_TRIANGLES,
+                 MeshCacheOptions(), mesh);
+        return true;
+      },
+      [this](MeshGroup<Interleave>* group)  // GL thread, after the upload.
+      {
+        group->AddRenderingPass({{mPosLoc, true}, {mNormalLoc, true}, {mUvLoc, true}});
+        mMeshReady = true;
+      });
+*/
+
+#pragma once
+
+#include "gloo/gl_header.h"
+#include "group.h"
+#include "mesh_cache.h"
+
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+
+namespace gloo
+{
+
+const double kDefaultUploadBudget = 2.0;  // Milliseconds per frame.
+
+class MeshLoader
+{
+public:
+  // Fills 'mesh' on a worker thread. Returns false if the mesh couldn't be built.
+  typedef std::function<bool(PackedMesh & mesh)> BuildTask;
+
+  // Called on the GL thread after 'group' is uploaded.
+  typedef std::function<void(MeshGroup<Interleave>* group)> UploadCallback;
+
+  // Starts 'numWorkers' threads (0 = one less than the hardware threads, at least 1).
+  explicit MeshLoader(GLuint numWorkers = 0);
+
+  // Waits for the running build tasks. Meshes that weren't uploaded are dropped.
+  ~MeshLoader();
+
+  // Builds a mesh for 'group' asynchronously (any thread).
+  void Submit(MeshGroup<Interleave>* group, const BuildTask & build,
+              const UploadCallback & onUploaded = nullptr);
+
+  // Drops the requests for 'group' (any thread). Tasks that are running still finish.
+  void Cancel(const MeshGroup<Interleave>* group);
+
+  // Uploads finished meshes until 'budgetMs' milliseconds are spent (GL thread). At least one
+  // mesh is uploaded per call, if any is ready. Returns the number of uploaded meshes.
+  GLuint ProcessUploads(double budgetMs);
+
+  // Getters.
+  bool IsPending(const MeshGroup<Interleave>* group) const;  // Submitted and not uploaded.
+  GLuint GetNumPending() const;
+  GLuint GetNumWorkers() const { return mWorkers.size(); }
+
+private:
+  struct Request
+  {
+    MeshGroup<Interleave>* mGroup;
+    BuildTask mBuild;
+    UploadCallback mOnUploaded;
+    PackedMesh mMesh;
+    bool mCancelled;
+  };
+
+  MeshLoader(const MeshLoader &) = delete;
+  MeshLoader & operator=(const MeshLoader &) = delete;
+
+  void RunWorker();
+
+  std::vector<std::thread> mWorkers;
+
+  // Requests move from the build queue to the workers, then to the upload queue.
+  mutable std::mutex mMutex;
+  std::condition_variable mBuildCondition;
+  std::deque<std::unique_ptr<Request>> mBuildQueue;
+  std::vector<Request*> mBuilding;
+  std::deque<std::unique_ptr<Request>> mUploadQueue;
+  bool mStopping { false };
+};
+
+}  // namespace gloo.
@@ -0,0 +1,387 @@
+#include "mesh_optimizer.h"
+
+#include <cmath>
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+
+namespace gloo
+{
+
+namespace
+{
+  const GLint kNoVertex = -1;
+
+  // FIFO post-transform cache simulation (an entry is evicted after 'size' other misses).
+  class FifoCache
+  {
+  public:
+    FifoCache(GLuint numVertices, GLuint size)
+    : mInsertedAt(numVertices, 0)
+    , mSize(size)
+    { }
+
+    // Returns true if 'v' had to be transformed (and inserts it).
+    bool Access(GLuint v)
+    {
+      if (mInsertedAt[v] != 0 && mTime - mInsertedAt[v] < mSize)
+        return false;
+
+      mTime++;
+      mInsertedAt[v] = mTime;
+      return true;
+    }
+
+    // Number of vertices of triangle t that had to be transformed.
+    GLuint AccessTriangle(const GLuint* indices, GLuint t)
+    {
+      return Access(indices[3*t]) + Access(indices[3*t + 1]) + Access(indices[3*t + 2]);
+    }
+
+    // Invalidates all entries.
+    void Flush() { mTime += mSize; }
+
+  private:
+    std::vector<GLuint> mInsertedAt;  // Time stamps (0 = never inserted).
+    GLuint mTime { 0 };               // Number of misses so far (plus flushes).
+    GLuint mSize;
+  };
+
+  // Cluster of consecutive triangles [mFirst, mEnd) and its occlusion potential.
+  struct TriangleCluster
+  {
+    GLuint mFirst;
+    GLuint mEnd;
+    GLfloat mSortKey;
+  };
+
+  // Triangles adjacent to each vertex, stored as a compressed list (offsets + triangles).
+  struct VertexAdjacency
+  {
+    std::vector<GLuint> mOffsets;    // Triangles of vertex v: [mOffsets[v], mOffsets[v+1]).
+    std::vector<GLuint> mTriangles;
+  };
+
+  void BuildAdjacency(const GLuint* indices, GLuint numIndices, GLuint numVertices,
+                      VertexAdjacency & adjacency, std::vector<GLuint> & liveTriangles)
+  {
+    liveTriangles.assign(numVertices, 0);
+    for (GLuint i = 0; i < numIndices; i++)
+    {
+      assert(indices[i] < numVertices);
+      liveTriangles[indices[i]]++;
+    }
+
+    adjacency.mOffsets.assign(numVertices + 1, 0);
+    for (GLuint v = 0; v < numVertices; v++)
+      adjacency.mOffsets[v+1] = adjacency.mOffsets[v] + liveTriangles[v];
+
+    std::vector<GLuint> fill(adjacency.mOffsets.begin(), adjacency.mOffsets.end() - 1);
+    adjacency.mTriangles.resize(numIndices);
+    for (GLuint i = 0; i < numIndices; i++)
+      adjacency.mTriangles[fill[indices[i]]++] = i / 3;
+  }
+
+  // Tipsify: picks the next fanning vertex among the candidates (vertices of the last fan).
+  // Prefers vertices that will still be in the cache after emitting all their triangles.
+  GLint GetNextVertex(const std::vector<GLuint> & candidates, const std::vector<GLuint> & live,
+                      const std::vector<GLuint> & cacheTime, GLuint timeStamp, GLuint cacheSize,
+                      std::vector<GLuint> & deadEnd, GLuint & cursor, GLuint numVertices)
+  {
+    GLint best = kNoVertex;
+    GLint bestPriority = -1;
+
+    for (GLuint v : candidates)
+    {
+      if (live[v] == 0)
+        continue;
+
+      GLint priority = 0;
+      if (timeStamp - cacheTime[v] + 2 * live[v] <= cacheSize)
+        priority = timeStamp - cacheTime[v];
+
+      if (priority > bestPriority)
+      {
+        bestPriority = priority;
+        best = v;
+      }
+    }
+
+    if (best != kNoVertex)
+      return best;
+
+    // Dead end: go back to recently emitted vertices, then scan the remaining ones in order.
+    while (!deadEnd.empty())
+    {
+      const GLuint v = deadEnd.back();
+      deadEnd.pop_back();
+
+      if (live[v] > 0)
+        return v;
+    }
+
+    for (; cursor < numVertices; cursor++)
+    {
+      if (live[cursor] > 0)
+        return cursor;
+    }
+
+    return kNoVertex;
+  }
+}
+
+VertexCacheStats AnalyzeVertexCache(const GLuint* indices, GLuint numIndices, GLuint numVertices,
+                                    GLuint cacheSize)
+{
+  VertexCacheStats stats;
+  if (numIndices < 3)
+    return stats;
+
+  FifoCache cache(numVertices, cacheSize);
+  std::vector<bool> referenced(numVertices, false);
+  GLuint misses = 0;
+  GLuint numReferenced = 0;
+
+  for (GLuint i = 0; i < numIndices; i++)
+  {
+    const GLuint v = indices[i];
+
+    if (!referenced[v])
+    {
+      referenced[v] = true;
+      numReferenced++;
+    }
+
+    misses += cache.Access(v);
+  }
+
+  stats.mAcmr = static_cast<GLfloat>(misses) / (numIndices / 3);
+  stats.mAtvr = static_cast<GLfloat>(misses) / numReferenced;
+
+  return stats;
+}
+
+void OptimizeVertexCache(GLuint* indices, GLuint numIndices, GLuint numVertices, GLuint cacheSize)
+{
+  assert(numIndices % 3 == 0);
+  const GLuint numTriangles = numIndices / 3;
+
+  VertexAdjacency adjacency;
+  std::vector<GLuint> live;
+  BuildAdjacency(indices, numIndices, numVertices, adjacency, live);
+
+  std::vector<GLuint> cacheTime(numVertices, 0);
+  std::vector<bool> emitted(numTriangles, false);
+  std::vector<GLuint> deadEnd;
+  std::vector<GLuint> candidates;
+  std::vector<GLuint> output;
+  output.reserve(numIndices);
+
+  GLuint timeStamp = cacheSize + 1;
+  GLuint cursor = 0;
+  GLint fan = GetNextVertex(candidates, live, cacheTime, timeStamp, cacheSize,
+                            deadEnd, cursor, numVertices);
+
+  while (fan != kNoVertex)
+  {
+    candidates.clear();
+
+    // Emit all triangles around the fanning vertex.
+    for (GLuint k = adjacency.mOffsets[fan]; k < adjacency.mOffsets[fan+1]; k++)
+    {
+      const GLuint t = adjacency.mTriangles[k];
+      if (emitted[t])
+        continue;
+
+      for (GLuint c = 0; c < 3; c++)
+      {
+        const GLuint v = indices[3*t + c];
+        output.push_back(v);
+        deadEnd.push_back(v);
+        candidates.push_back(v);
+        live[v]--;
+
+        if (timeStamp - cacheTime[v] > cacheSize)  // Miss: v enters the cache.
+        {
+          cacheTime[v] = timeStamp;
+          timeStamp++;
+        }
+      }
+
+      emitted[t] = true;
+    }
+
+    fan = GetNextVertex(candidates, live, cacheTime, timeStamp, cacheSize,
+                        deadEnd, cursor, numVertices);
+  }
+
+  assert(output.size() == numIndices);
+  memcpy(indices, output.data(), numIndices * sizeof(GLuint));
+}
+
+void OptimizeOverdraw(GLuint* indices, GLuint numIndices, const GLfloat* positions,
+                      GLuint positionStride, GLuint numVertices, GLfloat threshold, GLuint cacheSize)
+{
+  assert(numIndices % 3 == 0);
+  const GLuint numTriangles = numIndices / 3;
+  if (numTriangles == 0)
+    return;
+
+  // 1. Hard boundaries: triangles whose vertices all miss (the cache was flushed before them).
+  std::vector<GLuint> hardBoundaries;
+  FifoCache cache(numVertices, cacheSize);
+  for (GLuint t = 0; t < numTriangles; t++)
+  {
+    if (cache.AccessTriangle(indices, t) == 3 || t == 0)
+      hardBoundaries.push_back(t);
+  }
+  hardBoundaries.push_back(numTriangles);
+
+  // 2. Soft boundaries: split each hard cluster as soon as the running ACMR gets within
+  // 'threshold' of the ACMR of the whole cluster (so splitting costs at most that much).
+  std::vector<TriangleCluster> clusters;
+  for (GLuint h = 0; h + 1 < hardBoundaries.size(); h++)
+  {
+    const GLuint first = hardBoundaries[h];
+    const GLuint end   = hardBoundaries[h+1];
+
+    GLuint clusterMisses = 0;
+    cache.Flush();
+    for (GLuint t = first; t < end; t++)
+      clusterMisses += cache.AccessTriangle(indices, t);
+
+    const GLfloat maxAcmr = threshold * clusterMisses / (end - first);
+
+    GLuint start = first;
+    GLuint misses = 0;
+    cache.Flush();
+    for (GLuint t = first; t < end; t++)
+    {
+      misses += cache.AccessTriangle(indices, t);
+
+      if (t + 1 == end || misses <= maxAcmr * (t + 1 - start))
+      {
+        clusters.push_back({start, t + 1, 0.0f});
+        start = t + 1;
+        misses = 0;
+        cache.Flush();
+      }
+    }
+  }
+
+  // 3. Occlusion potential: area-weighted centroid and normal of each cluster.
+  std::vector<GLfloat> centroids(3 * clusters.size(), 0.0f);
+  std::vector<GLfloat> normals(3 * clusters.size(), 0.0f);
+  GLfloat meshCentroid[3] = {0.0f, 0.0f, 0.0f};
+  GLfloat meshArea = 0.0f;
+
+  for (GLuint c = 0; c < clusters.size(); c++)
+  {
+    GLfloat* centroid = &centroids[3*c];
+    GLfloat* normal   = &normals[3*c];
+    GLfloat area = 0.0f;
+
+    for (GLuint t = clusters[c].mFirst; t < clusters[c].mEnd; t++)
+    {
+      const GLfloat* p0 = positions + positionStride * indices[3*t];
+      const GLfloat* p1 = positions + positionStride * indices[3*t + 1];
+      const GLfloat* p2 = positions + positionStride * indices[3*t + 2];
+
+      const GLfloat e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+      const GLfloat e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+      const GLfloat n[3]  = {e1[1]*e2[2] - e1[2]*e2[1],
+                             e1[2]*e2[0] - e1[0]*e2[2],
+                             e1[0]*e2[1] - e1[1]*e2[0]};
+      const GLfloat a = std::sqrt(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+
+      for (int k = 0; k < 3; k++)
+      {
+        centroid[k] += a * (p0[k] + p1[k] + p2[k]) / 3.0f;
+        normal[k]   += n[k];
+      }
+      area += a;
+    }
+
+    for (int k = 0; k < 3; k++)
+      meshCentroid[k] += centroid[k];
+    meshArea += area;
+
+    if (area > 0.0f)
+    {
+      for (int k = 0; k < 3; k++)
+        centroid[k] /= area;
+    }
+  }
+
+  if (meshArea > 0.0f)
+  {
+    for (int k = 0; k < 3; k++)
+      meshCentroid[k] /= meshArea;
+  }
+
+  for (GLuint c = 0; c < clusters.size(); c++)
+  {
+    const GLfloat* centroid = &centroids[3*c];
+    const GLfloat* normal   = &normals[3*c];
+    const GLfloat length = std::sqrt(normal[0]*normal[0] + normal[1]*normal[1] + normal[2]*normal[2]);
+
+    GLfloat key = 0.0f;
+    for (int k = 0; k < 3; k++)
+      key += (centroid[k] - meshCentroid[k]) * normal[k];
+
+    clusters[c].mSortKey = (length > 0.0f) ? key / length : 0.0f;
+  }
+
+  // 4. Draw clusters with the highest occlusion potential first.
+  std::stable_sort(clusters.begin(), clusters.end(),
+    [](const TriangleCluster & a, const TriangleCluster & b) { return a.mSortKey > b.mSortKey; });
+
+  std::vector<GLuint> output;
+  output.reserve(numIndices);
+  for (const TriangleCluster & cluster : clusters)
+  {
+    output.insert(output.end(), indices + 3*cluster.mFirst, indices + 3*cluster.mEnd);
+  }
+
+  memcpy(indices, output.data(), numIndices * sizeof(GLuint));
+}
+
+void OptimizeVertexFetch(GLuint* indices, GLuint numIndices, GLuint numVertices,
+                         std::vector<GLuint> & remap)
+{
+  const GLuint kUnassigned = ~0u;
+  remap.assign(numVertices, kUnassigned);
+
+  GLuint next = 0;
+  for (GLuint i = 0; i < numIndices; i++)
+  {
+    GLuint & newIndex = remap[indices[i]];
+    if (newIndex == kUnassigned)
+      newIndex = next++;
+
+    indices[i] = newIndex;
+  }
+
+  // Unreferenced vertices keep their relative order, after all referenced ones.
+  for (GLuint v = 0; v < numVertices; v++)
+  {
+    if (remap[v] == kUnassigned)
+      remap[v] = next++;
+  }
+}
+
+void RemapVertices(const void* src, GLuint bytes, GLuint stride, GLuint numVertices,
+                   const std::vector<GLuint> & remap, void* dst)
+{
+  assert(remap.size() == numVertices);
+
+  const GLubyte* in = static_cast<const GLubyte*>(src);
+  GLubyte* out = static_cast<GLubyte*>(dst);
+
+  for (GLuint v = 0; v < numVertices; v++)
+  {
+    memcpy(out + stride * remap[v], in + stride * v, bytes);
+  }
+}
+
+}  // namespace gloo.
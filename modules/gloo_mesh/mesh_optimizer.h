@@ -0,0 +1,83 @@
+// + ======================================== +
+// |         gl-oo-interface library          |
+// |            Module: GLOO Mesh.            |
+// |        Author: Rodrigo Castiel, 2016.    |
+// + ======================================== +
+//
+// Mesh optimization (preprocessing) passes for indexed triangle lists (GL_TRIANGLES).
+//
+// [Post-transform vertex cache]
+//
+// The GPU keeps the outputs of the last few vertex shader invocations in a small cache.
+// If triangles that share vertices are drawn close to each other, those vertices are
+// transformed only once. OptimizeVertexCache() reorders triangles using Tipsify
+// (Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced
+// Overdraw", 2007), which runs in linear time.
+//
+// The result is measured by simulating a FIFO cache (AnalyzeVertexCache()):
+//  -> ACMR: average cache miss ratio = transformed vertices / triangles (0.5 is ideal on large
+//           meshes, 3 is the worst case).
+//  -> ATVR: average transformed vertex ratio = transformed vertices / vertices (1 is ideal).
+//
+// [Overdraw]
+//
+// OptimizeOverdraw() runs after OptimizeVertexCache(). It splits the triangle order into
+// clusters (where the simulated cache is flushed, and then wherever the local ACMR is within
+// 'threshold' of its cluster's ACMR) and sorts clusters by occlusion potential: clusters far
+// from the mesh centroid and facing away from it are drawn first, since they tend to occlude
+// the others. This doesn't depend on the view, so it only helps the depth test reject
+// fragments earlier; the ACMR grows by at most 'threshold' (e.g. 1.05 -> 5%).
+//
+// [Vertex fetch]
+//
+// After reordering triangles, OptimizeVertexFetch() renumbers vertices in the order they are
+// first referenced, so that the vertex buffer is read (almost) sequentially.
+// It outputs a remap table (old index -> new index) that must be applied to vertex data.
+
+#pragma once
+
+#include "gloo/gl_header.h"
+
+#include <vector>
+
+namespace gloo
+{
+
+// Cache size assumed by default (typical post-transform cache of current GPUs).
+const GLuint kDefaultVertexCacheSize = 16;
+
+// Maximum ACMR increase accepted by the overdraw optimization (ratio).
+const GLfloat kDefaultOverdrawThreshold = 1.05f;
+
+struct VertexCacheStats
+{
+  GLfloat mAcmr { 0.0f };  // Average cache miss ratio (per triangle).
+  GLfloat mAtvr { 0.0f };  // Average transformed vertex ratio (per referenced vertex).
+};
+
+// Simulates a FIFO post-transform cache of 'cacheSize' entries over a triangle list.
+VertexCacheStats AnalyzeVertexCache(const GLuint* indices, GLuint numIndices, GLuint numVertices,
+                                    GLuint cacheSize = kDefaultVertexCacheSize);
+
+// Reorders the triangles of 'indices' (in place) for a post-transform cache of 'cacheSize'.
+void OptimizeVertexCache(GLuint* indices, GLuint numIndices, GLuint numVertices,
+                         GLuint cacheSize = kDefaultVertexCacheSize);
+
+// Sorts triangle clusters of 'indices' (in place) to reduce overdraw. Vertex v has position
+// (x, y, z) at positions[positionStride * v]. Call it on a cache-optimized triangle list.
+void OptimizeOverdraw(GLuint* indices, GLuint numIndices, const GLfloat* positions,
+                      GLuint positionStride, GLuint numVertices,
+                      GLfloat threshold = kDefaultOverdrawThreshold,
+                      GLuint cacheSize = kDefaultVertexCacheSize);
+
+// Renumbers vertices by first use (in place) and fills remap[oldIndex] = newIndex.
+// Unreferenced vertices are moved to the end, so the number of vertices doesn't change.
+void OptimizeVertexFetch(GLuint* indices, GLuint numIndices, GLuint numVertices,
+                         std::vector<GLuint> & remap);
+
+// Moves the data of every vertex to its new position: 'bytes' bytes per vertex, consecutive
+// vertices 'stride' bytes apart (in both 'src' and 'dst', which must not overlap).
+void RemapVertices(const void* src, GLuint bytes, GLuint stride, GLuint numVertices,
+                   const std::vector<GLuint> & remap, void* dst);
+
+}  // namespace gloo.
@@ -0,0 +1,419 @@
+#include "mesh_simplifier.h"
+
+#include <cmath>
+#include <queue>
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+
+namespace gloo
+{
+
+namespace
+{
+  // Levels must remove at least this fraction of the previous level's triangles.
+  const GLfloat kMinLodReduction = 0.1f;
+
+  // Collapses that rotate a triangle normal more than acos(kMinNormalCosine) are rejected.
+  const double kMinNormalCosine = 0.25;
+
+  // Symmetric 4x4 matrix: sum of squared distances to a set of planes.
+  struct Quadric
+  {
+    double m[10] { 0.0 };  // a2 ab ac ad b2 bc bd c2 cd d2.
+
+    void AddPlane(double a, double b, double c, double d)
+    {
+      m[0] += a*a;  m[1] += a*b;  m[2] += a*c;  m[3] += a*d;
+      m[4] += b*b;  m[5] += b*c;  m[6] += b*d;
+      m[7] += c*c;  m[8] += c*d;
+      m[9] += d*d;
+    }
+
+    void Add(const Quadric & q)
+    {
+      for (int i = 0; i < 10; i++)
+        m[i] += q.m[i];
+    }
+
+    double Evaluate(const GLfloat* p) const
+    {
+      const double x = p[0], y = p[1], z = p[2];
+      return m[0]*x*x + 2*m[1]*x*y + 2*m[2]*x*z + 2*m[3]*x
+           + m[4]*y*y + 2*m[5]*y*z + 2*m[6]*y
+           + m[7]*z*z + 2*m[8]*z
+           + m[9];
+    }
+  };
+
+  // Candidate collapse 'from' -> 'to', valid while neither vertex changed.
+  struct Collapse
+  {
+    double mCost;
+    GLuint mFrom;
+    GLuint mTo;
+    GLuint mFromVersion;
+    GLuint mToVersion;
+
+    bool operator>(const Collapse & other) const { return mCost > other.mCost; }
+  };
+
+  void Cross(const GLfloat* p0, const GLfloat* p1, const GLfloat* p2, double* n)
+  {
+    const double e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+    const double e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+
+    n[0] = e1[1]*e2[2] - e1[2]*e2[1];
+    n[1] = e1[2]*e2[0] - e1[0]*e2[2];
+    n[2] = e1[0]*e2[1] - e1[1]*e2[0];
+  }
+
+  GLuint64 EdgeKey(GLuint a, GLuint b)
+  {
+    return (static_cast<GLuint64>(std::min(a, b)) << 32) | std::max(a, b);
+  }
+
+  struct PositionHash
+  {
+    size_t operator()(const std::vector<GLuint> & key) const
+    {
+      return (key[0] * 73856093u) ^ (key[1] * 19349663u) ^ (key[2] * 83492791u);
+    }
+  };
+
+  class Simplifier
+  {
+  public:
+    Simplifier(const GLuint* indices, GLuint numIndices, const GLfloat* positions,
+               GLuint positionStride, GLuint numVertices)
+    : mTriangles(indices, indices + numIndices)
+    , mAlive(numIndices / 3, true)
+    , mNumAliveIndices(numIndices)
+    , mPositions(positions)
+    , mPositionStride(positionStride)
+    , mQuadrics(numVertices)
+    , mLocked(numVertices, false)
+    , mCollapsed(numVertices, false)
+    , mVersions(numVertices, 0)
+    , mVertexTriangles(numVertices)
+    {
+      BuildAdjacency();
+      LockBordersAndSeams(numVertices);
+      ComputeQuadrics();
+    }
+
+    GLfloat Run(GLfloat targetError, GLuint targetIndexCount)
+    {
+      const double maxCost = static_cast<double>(targetError) * targetError;
+      double error = 0.0;
+
+      for (GLuint t = 0; t < mAlive.size(); t++)
+      {
+        for (int k = 0; k < 3; k++)
+        {
+          PushCollapse(mTriangles[3*t + k], mTriangles[3*t + (k+1)%3]);
+          PushCollapse(mTriangles[3*t + (k+1)%3], mTriangles[3*t + k]);
+        }
+      }
+
+      while (!mQueue.empty() && mNumAliveIndices > targetIndexCount)
+      {
+        const Collapse collapse = mQueue.top();
+        mQueue.pop();
+
+        if (collapse.mCost > maxCost)
+          break;
+
+        if (mCollapsed[collapse.mFrom] || mCollapsed[collapse.mTo] ||
+            mVersions[collapse.mFrom] != collapse.mFromVersion ||
+            mVersions[collapse.mTo]   != collapse.mToVersion)
+          continue;  // Outdated.
+
+        if (!IsValid(collapse.mFrom, collapse.mTo))
+          continue;
+
+        Apply(collapse.mFrom, collapse.mTo);
+        error = std::max(error, collapse.mCost);
+      }
+
+      return static_cast<GLfloat>(std::sqrt(std::max(error, 0.0)));
+    }
+
+    void GetIndices(std::vector<GLuint> & output) const
+    {
+      output.clear();
+      output.reserve(mNumAliveIndices);
+
+      for (GLuint t = 0; t < mAlive.size(); t++)
+      {
+        if (mAlive[t])
+          output.insert(output.end(), &mTriangles[3*t], &mTriangles[3*t] + 3);
+      }
+    }
+
+  private:
+    const GLfloat* Position(GLuint v) const { return mPositions + mPositionStride * v; }
+
+    bool Contains(GLuint t, GLuint v) const
+    {
+      return mTriangles[3*t] == v || mTriangles[3*t + 1] == v || mTriangles[3*t + 2] == v;
+    }
+
+    void BuildAdjacency()
+    {
+      for (GLuint t = 0; t < mAlive.size(); t++)
+      {
+        for (int k = 0; k < 3; k++)
+          mVertexTriangles[mTriangles[3*t + k]].push_back(t);
+      }
+    }
+
+    void LockBordersAndSeams(GLuint numVertices)
+    {
+      // Border edges belong to a single triangle.
+      std::unordered_map<GLuint64, GLuint> edgeCount;
+      for (GLuint i = 0; i < mTriangles.size(); i += 3)
+      {
+        for (int k = 0; k < 3; k++)
+          edgeCount[EdgeKey(mTriangles[i + k], mTriangles[i + (k+1)%3])]++;
+      }
+
+      for (const std::pair<const GLuint64, GLuint> & edge : edgeCount)
+      {
+        if (edge.second == 1)
+        {
+          mLocked[edge.first >> 32] = true;
+          mLocked[edge.first & 0xffffffffu] = true;
+        }
+      }
+
+      // Seams: distinct vertices sharing the same position.
+      std::unordered_map<std::vector<GLuint>, GLuint, PositionHash> firstAtPosition;
+      for (GLuint v = 0; v < numVertices; v++)
+      {
+        std::vector<GLuint> key(3);
+        memcpy(key.data(), Position(v), 3 * sizeof(GLfloat));
+
+        auto inserted = firstAtPosition.insert(std::make_pair(key, v));
+        if (!inserted.second)
+        {
+          mLocked[v] = true;
+          mLocked[inserted.first->second] = true;
+        }
+      }
+    }
+
+    void ComputeQuadrics()
+    {
+      for (GLuint t = 0; t < mAlive.size(); t++)
+      {
+        const GLuint* tri = &mTriangles[3*t];
+        double n[3];
+        Cross(Position(tri[0]), Position(tri[1]), Position(tri[2]), n);
+
+        const double length = std::sqrt(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+        if (length <= 0.0)
+          continue;
+
+        const double a = n[0] / length, b = n[1] / length, c = n[2] / length;
+        const GLfloat* p = Position(tri[0]);
+        const double d = -(a*p[0] + b*p[1] + c*p[2]);
+
+        for (int k = 0; k < 3; k++)
+          mQuadrics[tri[k]].AddPlane(a, b, c, d);
+      }
+    }
+
+    void PushCollapse(GLuint from, GLuint to)
+    {
+      if (mLocked[from] || from == to)
+        return;
+
+      Quadric q = mQuadrics[from];
+      q.Add(mQuadrics[to]);
+
+      mQueue.push({std::max(q.Evaluate(Position(to)), 0.0), from, to,
+                   mVersions[from], mVersions[to]});
+    }
+
+    // Rejects collapses that flip (or nearly flip) the triangles around 'from'.
+    bool IsValid(GLuint from, GLuint to) const
+    {
+      for (GLuint t : mVertexTriangles[from])
+      {
+        if (!mAlive[t] || !Contains(t, from) || Contains(t, to))
+          continue;
+
+        const GLuint* tri = &mTriangles[3*t];
+        const GLfloat* p[3];
+        for (int k = 0; k < 3; k++)
+          p[k] = Position(tri[k]);
+
+        double before[3];
+        Cross(p[0], p[1], p[2], before);
+
+        for (int k = 0; k < 3; k++)
+        {
+          if (tri[k] == from)
+            p[k] = Position(to);
+        }
+
+        double after[3];
+        Cross(p[0], p[1], p[2], after);
+
+        const double dot = before[0]*after[0] + before[1]*after[1] + before[2]*after[2];
+        const double lengths = std::sqrt((before[0]*before[0] + before[1]*before[1] + before[2]*before[2]) *
+                                         (after[0]*after[0] + after[1]*after[1] + after[2]*after[2]));
+
+        if (lengths <= 0.0 || dot < kMinNormalCosine * lengths)
+          return false;
+      }
+
+      return true;
+    }
+
+    void Apply(GLuint from, GLuint to)
+    {
+      mCollapsed[from] = true;
+      mQuadrics[to].Add(mQuadrics[from]);
+      mVersions[to]++;
+
+      for (GLuint t : mVertexTriangles[from])
+      {
+        if (!mAlive[t] || !Contains(t, from))
+          continue;
+
+        if (Contains(t, to))  // The collapsed edge: triangle degenerates.
+        {
+          mAlive[t] = false;
+          mNumAliveIndices -= 3;
+          continue;
+        }
+
+        for (int k = 0; k < 3; k++)
+        {
+          if (mTriangles[3*t + k] == from)
+            mTriangles[3*t + k] = to;
+        }
+        mVertexTriangles[to].push_back(t);
+      }
+      mVertexTriangles[from].clear();
+
+      // Costs of the edges around 'to' changed.
+      for (GLuint t : mVertexTriangles[to])
+      {
+        if (!mAlive[t])
+          continue;
+
+        for (int k = 0; k < 3; k++)
+        {
+          const GLuint v = mTriangles[3*t + k];
+          PushCollapse(v, to);
+          PushCollapse(to, v);
+        }
+      }
+    }
+
+    std::vector<GLuint> mTriangles;
+    std::vector<bool> mAlive;
+    GLuint mNumAliveIndices;
+
+    const GLfloat* mPositions;
+    GLuint mPositionStride;
+
+    std::vector<Quadric> mQuadrics;
+    std::vector<bool> mLocked;
+    std::vector<bool> mCollapsed;
+    std::vector<GLuint> mVersions;
+    std::vector<std::vector<GLuint>> mVertexTriangles;
+
+    std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> mQueue;
+  };
+}
+
+GLfloat SimplifyMesh(const GLuint* indices, GLuint numIndices, const GLfloat* positions,
+                     GLuint positionStride, GLuint numVertices, GLfloat targetError,
+                     GLuint targetIndexCount, std::vector<GLuint> & output)
+{
+  assert(numIndices % 3 == 0);
+
+  Simplifier simplifier(indices, numIndices, positions, positionStride, numVertices);
+  const GLfloat error = simplifier.Run(targetError, targetIndexCount);
+  simplifier.GetIndices(output);
+
+  return error;
+}
+
+GLfloat ComputeMeshRadius(const GLfloat* positions, GLuint positionStride, GLuint numVertices,
+                          GLfloat* center)
+{
+  if (numVertices == 0)
+    return 0.0f;
+
+  GLfloat minCorner[3] = {positions[0], positions[1], positions[2]};
+  GLfloat maxCorner[3] = {positions[0], positions[1], positions[2]};
+
+  for (GLuint v = 1; v < numVertices; v++)
+  {
+    const GLfloat* p = positions + positionStride * v;
+    for (int k = 0; k < 3; k++)
+    {
+      minCorner[k] = std::min(minCorner[k], p[k]);
+      maxCorner[k] = std::max(maxCorner[k], p[k]);
+    }
+  }
+
+  GLfloat c[3];
+  for (int k = 0; k < 3; k++)
+    c[k] = 0.5f * (minCorner[k] + maxCorner[k]);
+
+  GLfloat radius2 = 0.0f;
+  for (GLuint v = 0; v < numVertices; v++)
+  {
+    const GLfloat* p = positions + positionStride * v;
+    const GLfloat d[3] = {p[0] - c[0], p[1] - c[1], p[2] - c[2]};
+    radius2 = std::max(radius2, d[0]*d[0] + d[1]*d[1] + d[2]*d[2]);
+  }
+
+  if (center)
+    memcpy(center, c, sizeof(c));
+
+  return std::sqrt(radius2);
+}
+
+void BuildLodChain(std::vector<GLuint> & indices, const GLfloat* positions, GLuint positionStride,
+                   GLuint numVertices, const std::vector<GLfloat> & targetErrors,
+                   std::vector<LodLevel> & levels)
+{
+  const GLfloat radius = ComputeMeshRadius(positions, positionStride, numVertices);
+
+  levels.clear();
+  levels.push_back({0, static_cast<GLuint>(indices.size()), 0.0f});
+
+  std::vector<GLuint> simplified;
+  for (GLfloat targetError : targetErrors)
+  {
+    const LodLevel previous = levels.back();
+    const GLfloat budget = targetError * radius - previous.mError;
+    if (budget <= 0.0f)
+      continue;
+
+    // Simplify the previous level (cheaper), so errors add up.
+    const GLfloat error = SimplifyMesh(&indices[previous.mFirstIndex], previous.mNumIndices,
+                                       positions, positionStride, numVertices, budget, 0,
+                                       simplified);
+
+    if (simplified.empty())
+      break;
+
+    if (simplified.size() > (1.0f - kMinLodReduction) * previous.mNumIndices)
+      continue;
+
+    levels.push_back({static_cast<GLuint>(indices.size()), static_cast<GLuint>(simplified.size()),
+                      previous.mError + error});
+    indices.insert(indices.end(), simplified.begin(), simplified.end());
+  }
+}
+
+}  // namespace gloo.
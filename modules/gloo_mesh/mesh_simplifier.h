@@ -0,0 +1,63 @@
+// + ======================================== +
+// |         gl-oo-interface library          |
+// |            Module: GLOO Mesh.            |
+// |        Author: Rodrigo Castiel, 2016.    |
+// + ======================================== +
+//
+// Mesh simplification and level of detail (LOD) chains for indexed triangle lists.
+//
+// SimplifyMesh() implements quadric error metric simplification (Garland and Heckbert,
+// "Surface Simplification Using Quadric Error Metrics", 1997) restricted to half-edge
+// collapses: a vertex is always collapsed onto one of its neighbors, so the simplified
+// mesh is just a new index buffer over the original vertex buffer.
+//
+// The error of a collapse is the square root of its quadric error: the sum of the squared
+// distances (in object units) between the moved vertex and the planes of the triangles it has
+// absorbed so far. It is not a measured distance to the original surface, but it bounds the
+// distance to each of those planes from above (it's conservative). Vertices on open borders or on attribute
+// seams (another vertex has the same position, e.g. different uvs) never move, so the
+// silhouette and texture mapping of the mesh are preserved.
+//
+// BuildLodChain() generates one level per target error. Levels are appended to the same
+// index array and described by LodLevel (range of indices and achieved error).
+
+#pragma once
+
+#include "gloo/gl_header.h"
+
+#include <vector>
+
+namespace gloo
+{
+
+// A level of detail: range of the shared index buffer and its geometric error.
+struct LodLevel
+{
+  GLuint mFirstIndex;  // Offset (in indices) in the element array.
+  GLuint mNumIndices;  // Number of indices.
+  GLfloat mError;      // Accumulated collapse error (object units, see SimplifyMesh()).
+};
+
+// Simplifies the triangle list 'indices' until the collapse error would exceed 'targetError'
+// (object units) or the mesh gets down to 'targetIndexCount' indices (0 = no limit).
+// Vertex v has position (x, y, z) at positions[positionStride * v].
+// Returns the error of the simplified mesh: the largest collapse error applied (the square root
+// of its quadric error, see above).
+GLfloat SimplifyMesh(const GLuint* indices, GLuint numIndices, const GLfloat* positions,
+                     GLuint positionStride, GLuint numVertices, GLfloat targetError,
+                     GLuint targetIndexCount, std::vector<GLuint> & output);
+
+// Radius of the bounding sphere centered at the center of the bounding box of all vertices.
+GLfloat ComputeMeshRadius(const GLfloat* positions, GLuint positionStride, GLuint numVertices,
+                          GLfloat* center = nullptr);
+
+// Appends one simplified level per target error to 'indices' (which initially holds level 0)
+// and fills 'levels', including level 0. Each level is simplified from the previous one and its
+// error is the sum of the errors of the steps that led to it. Target errors are relative to the mesh radius
+// (e.g. 0.01 = 1%) and must be increasing. Levels that don't remove enough triangles to be
+// worth it are skipped.
+void BuildLodChain(std::vector<GLuint> & indices, const GLfloat* positions, GLuint positionStride,
+                   GLuint numVertices, const std::vector<GLfloat> & targetErrors,
+                   std::vector<LodLevel> & levels);
+
+}  // namespace gloo.
@@ -0,0 +1,246 @@
+#include "meshlet.h"
+
+#include <cmath>
+#include <cassert>
+#include <algorithm>
+
+namespace gloo
+{
+
+namespace
+{
+  // Meshlets whose normals deviate more than acos(kMinConeCosine) from the average normal have
+  // no useful cone (they are never back-face culled).
+  const GLfloat kMinConeCosine = 0.1f;
+
+  // A meshlet is closed when a triangle deviates more than acos(kSplitConeCosine) from its
+  // average normal, so that cones stay narrow enough for back-face culling.
+  const GLfloat kSplitConeCosine = 0.7f;
+
+  // Unit normal of triangle (i0, i1, i2), or (0, 0, 0) if it's degenerate.
+  void ComputeTriangleNormal(const GLfloat* positions, GLuint positionStride, GLuint i0,
+                             GLuint i1, GLuint i2, GLfloat* n)
+  {
+    const GLfloat* p0 = &positions[positionStride * i0];
+    const GLfloat* p1 = &positions[positionStride * i1];
+    const GLfloat* p2 = &positions[positionStride * i2];
+
+    const GLfloat e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+    const GLfloat e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+    n[0] = e1[1]*e2[2] - e1[2]*e2[1];
+    n[1] = e1[2]*e2[0] - e1[0]*e2[2];
+    n[2] = e1[0]*e2[1] - e1[1]*e2[0];
+
+    const GLfloat length = std::sqrt(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+    for (int k = 0; k < 3; k++)
+      n[k] = (length > 0.0f) ? n[k] / length : 0.0f;
+  }
+
+  // Computes the bounding sphere and normal cone of the triangles in 'meshlet'.
+  void ComputeMeshletBounds(const GLuint* indices, const GLfloat* positions,
+                            GLuint positionStride, Meshlet & meshlet)
+  {
+    const GLuint* first = indices + meshlet.mFirstIndex;
+    const GLuint numTriangles = meshlet.mNumIndices / 3;
+
+    // Bounding sphere: center of the bounding box.
+    GLfloat minCorner[3] = { positions[positionStride * first[0] + 0],
+                             positions[positionStride * first[0] + 1],
+                             positions[positionStride * first[0] + 2] };
+    GLfloat maxCorner[3] = { minCorner[0], minCorner[1], minCorner[2] };
+
+    for (GLuint i = 0; i < meshlet.mNumIndices; i++)
+    {
+      const GLfloat* p = &positions[positionStride * first[i]];
+      for (int k = 0; k < 3; k++)
+      {
+        minCorner[k] = std::min(minCorner[k], p[k]);
+        maxCorner[k] = std::max(maxCorner[k], p[k]);
+      }
+    }
+
+    GLfloat radius2 = 0.0f;
+    for (int k = 0; k < 3; k++)
+      meshlet.mCenter[k] = 0.5f * (minCorner[k] + maxCorner[k]);
+
+    for (GLuint i = 0; i < meshlet.mNumIndices; i++)
+    {
+      const GLfloat* p = &positions[positionStride * first[i]];
+      const GLfloat d[3] = { p[0] - meshlet.mCenter[0], p[1] - meshlet.mCenter[1],
+                             p[2] - meshlet.mCenter[2] };
+      radius2 = std::max(radius2, d[0]*d[0] + d[1]*d[1] + d[2]*d[2]);
+    }
+
+    meshlet.mRadius = std::sqrt(radius2);
+
+    // Normal cone: average of the unit triangle normals and their largest deviation.
+    std::vector<GLfloat> normals;
+    normals.reserve(3 * numTriangles);
+
+    GLfloat axis[3] = { 0.0f, 0.0f, 0.0f };
+    for (GLuint t = 0; t < numTriangles; t++)
+    {
+      GLfloat n[3];
+      ComputeTriangleNormal(positions, positionStride, first[3*t], first[3*t+1], first[3*t+2], n);
+
+      if (n[0] == 0.0f && n[1] == 0.0f && n[2] == 0.0f)  // Degenerate triangles don't count.
+        continue;
+
+      for (int k = 0; k < 3; k++)
+      {
+        axis[k] += n[k];
+        normals.push_back(n[k]);
+      }
+    }
+
+    const GLfloat axisLength = std::sqrt(axis[0]*axis[0] + axis[1]*axis[1] + axis[2]*axis[2]);
+    GLfloat minCosine = 1.0f;
+
+    if (axisLength > 0.0f)
+    {
+      for (int k = 0; k < 3; k++)
+        axis[k] /= axisLength;
+
+      for (GLuint i = 0; i < normals.size(); i += 3)
+      {
+        const GLfloat cosine = axis[0]*normals[i] + axis[1]*normals[i+1] + axis[2]*normals[i+2];
+        minCosine = std::min(minCosine, cosine);
+      }
+    }
+
+    if (axisLength == 0.0f || minCosine <= kMinConeCosine)
+    {
+      // No cone: the visibility test always fails (0 >= |d| + r).
+      meshlet.mConeAxis[0] = meshlet.mConeAxis[1] = meshlet.mConeAxis[2] = 0.0f;
+      meshlet.mConeCutoff = 1.0f;
+    }
+    else
+    {
+      meshlet.mConeAxis[0] = axis[0];
+      meshlet.mConeAxis[1] = axis[1];
+      meshlet.mConeAxis[2] = axis[2];
+      meshlet.mConeCutoff = std::sqrt(1.0f - minCosine * minCosine);
+    }
+  }
+}  // namespace.
+
+void BuildMeshlets(const GLuint* indices, GLuint numIndices, const GLfloat* positions,
+                   GLuint positionStride, GLuint numVertices, std::vector<Meshlet> & meshlets,
+                   GLuint maxVertices, GLuint maxTriangles)
+{
+  assert(numIndices % 3 == 0);
+  assert(maxVertices >= 3 && maxTriangles >= 1);
+
+  // marker[v] == meshlet number if v was already referenced by the current meshlet.
+  std::vector<GLuint> marker(numVertices, ~0u);
+  GLuint meshletId = 0;
+
+  Meshlet meshlet = { 0, 0, 0, { 0.0f, 0.0f, 0.0f }, 0.0f, { 0.0f, 0.0f, 0.0f }, 0.0f };
+  GLfloat normalSum[3] = { 0.0f, 0.0f, 0.0f };
+
+  for (GLuint i = 0; i < numIndices; i += 3)
+  {
+    GLuint newVertices = 0;
+    for (GLuint k = 0; k < 3; k++)
+    {
+      if (marker[indices[i+k]] != meshletId)
+        newVertices++;
+    }
+
+    GLfloat n[3];
+    ComputeTriangleNormal(positions, positionStride, indices[i], indices[i+1], indices[i+2], n);
+
+    // Deviation from the average normal of the meshlet (|normalSum| * cosine).
+    // Degenerate triangles (n = 0) fit in any meshlet.
+    const GLfloat sumLength = std::sqrt(normalSum[0]*normalSum[0] + normalSum[1]*normalSum[1] 
+                                        + normalSum[2]*normalSum[2]);
+    const GLfloat deviation = n[0]*normalSum[0] + n[1]*normalSum[1] + n[2]*normalSum[2];
+    const bool degenerate = (n[0] == 0.0f && n[1] == 0.0f && n[2] == 0.0f);
+
+    // Start a new meshlet if the triangle doesn't fit.
+    if (meshlet.mNumVertices + newVertices > maxVertices || meshlet.mNumIndices/3 == maxTriangles
+        || (!degenerate && deviation < kSplitConeCosine * sumLength))
+    {
+      ComputeMeshletBounds(indices, positions, positionStride, meshlet);
+      meshlets.push_back(meshlet);
+
+      meshletId++;
+      meshlet.mFirstIndex = i;
+      meshlet.mNumIndices = 0;
+      meshlet.mNumVertices = 0;
+      normalSum[0] = normalSum[1] = normalSum[2] = 0.0f;
+    }
+
+    for (int k = 0; k < 3; k++)
+      normalSum[k] += n[k];
+
+    for (GLuint k = 0; k < 3; k++)
+    {
+      if (marker[indices[i+k]] != meshletId)
+      {
+        marker[indices[i+k]] = meshletId;
+        meshlet.mNumVertices++;
+      }
+    }
+
+    meshlet.mNumIndices += 3;
+  }
+
+  if (meshlet.mNumIndices > 0)
+  {
+    ComputeMeshletBounds(indices, positions, positionStride, meshlet);
+    meshlets.push_back(meshlet);
+  }
+}
+
+void ExtractFrustumPlanes(const GLfloat* modelViewProj, GLfloat planes[6][4])
+{
+  // Row r of the (column-major) matrix is m[r], m[4+r], m[8+r], m[12+r].
+  const GLfloat* m = modelViewProj;
+
+  for (int axis = 0; axis < 3; axis++)
+  {
+    for (int side = 0; side < 2; side++)
+    {
+      // -w <= x, y, z <= w  ->  (row3 + row_axis) and (row3 - row_axis).
+      const GLfloat sign = (side == 0) ? 1.0f : -1.0f;
+      GLfloat* plane = planes[2*axis + side];
+
+      for (int c = 0; c < 4; c++)
+        plane[c] = m[4*c + 3] + sign * m[4*c + axis];
+
+      const GLfloat length = std::sqrt(plane[0]*plane[0] + plane[1]*plane[1] + plane[2]*plane[2]);
+      if (length > 0.0f)
+      {
+        for (int c = 0; c < 4; c++)
+          plane[c] /= length;
+      }
+    }
+  }
+}
+
+bool IsMeshletVisible(const Meshlet & meshlet, const GLfloat planes[6][4], const GLfloat* eye)
+{
+  const GLfloat* c = meshlet.mCenter;
+
+  // Frustum culling: the sphere must not be completely behind any plane.
+  for (int i = 0; i < 6; i++)
+  {
+    const GLfloat distance = planes[i][0]*c[0] + planes[i][1]*c[1] + planes[i][2]*c[2] + planes[i][3];
+    if (distance < -meshlet.mRadius)
+      return false;
+  }
+
+  // Back-face culling: every triangle faces away if the view direction to the sphere lies
+  // inside the normal cone (widened by the sphere radius).
+  const GLfloat d[3] = { c[0] - eye[0], c[1] - eye[1], c[2] - eye[2] };
+  const GLfloat length = std::sqrt(d[0]*d[0] + d[1]*d[1] + d[2]*d[2]);
+  const GLfloat* axis = meshlet.mConeAxis;
+
+  if (d[0]*axis[0] + d[1]*axis[1] + d[2]*axis[2] >= meshlet.mConeCutoff * length + meshlet.mRadius)
+    return false;
+
+  return true;
+}
+
+}  // namespace gloo.
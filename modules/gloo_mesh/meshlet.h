@@ -0,0 +1,70 @@
+// + ======================================== +
+// |         gl-oo-interface library          |
+// |            Module: GLOO Mesh.            |
+// |        Author: Rodrigo Castiel, 2016.    |
+// + ======================================== +
+//
+// Meshlets (triangle clusters) for indexed triangle lists and per-meshlet culling.
+//
+// BuildMeshlets() splits a triangle list into runs of consecutive triangles referencing at
+// most kMaxMeshletVertices vertices and kMaxMeshletTriangles triangles, so every meshlet is
+// just a range of the existing index buffer. Triangles should be cache-optimized first
+// (see mesh_optimizer.h): neighboring triangles are then drawn together, which makes meshlets
+// compact.
+//
+// Each meshlet stores a bounding sphere and a normal cone (average normal and spread of its
+// triangle normals), both in object space. IsMeshletVisible() rejects a meshlet if its sphere
+// is outside the view frustum or if all of its triangles face away from the camera.
+// Meshlets whose normals spread over more than a hemisphere are never back-face culled.
+
+#pragma once
+
+#include "gloo/gl_header.h"
+
+#include <vector>
+
+namespace gloo
+{
+
+// Meshlet size limits (typical limits of mesh shading hardware).
+const GLuint kMaxMeshletVertices  = 64;
+const GLuint kMaxMeshletTriangles = 124;
+
+struct Meshlet
+{
+  GLuint mFirstIndex;   // Offset (in indices) in the element array.
+  GLuint mNumIndices;   // Number of indices (3 per triangle).
+  GLuint mNumVertices;  // Number of distinct vertices.
+
+  GLfloat mCenter[3];   // Bounding sphere (object space).
+  GLfloat mRadius;
+
+  GLfloat mConeAxis[3];  // Normal cone: average normal and sine of its spread.
+  GLfloat mConeCutoff;
+};
+
+// Visible meshlets of a group for one point of view (see MeshGroup::CullMeshlets()): ranges of
+// the element array, as counts and byte offsets for glMultiDrawElements(). Adjacent visible
+// meshlets are merged into one range.
+struct MeshletDrawList
+{
+  std::vector<GLsizei> mCounts;
+  std::vector<const GLvoid*> mOffsets;
+};
+
+// Splits the triangle list 'indices' into meshlets (appended to 'meshlets', with offsets
+// relative to 'indices'). Vertex v has position (x, y, z) at positions[positionStride * v].
+void BuildMeshlets(const GLuint* indices, GLuint numIndices, const GLfloat* positions,
+                   GLuint positionStride, GLuint numVertices, std::vector<Meshlet> & meshlets,
+                   GLuint maxVertices = kMaxMeshletVertices,
+                   GLuint maxTriangles = kMaxMeshletTriangles);
+
+// Extracts the 6 planes (a, b, c, d) of the view frustum from a model-view-projection matrix
+// (column-major). Planes are normalized and expressed in object space, facing inwards.
+void ExtractFrustumPlanes(const GLfloat* modelViewProj, GLfloat planes[6][4]);
+
+// Returns false if the meshlet is outside the frustum or back-facing as seen from 'eye'
+// (camera position in object space).
+bool IsMeshletVisible(const Meshlet & meshlet, const GLfloat planes[6][4], const GLfloat* eye);
+
+}  // namespace gloo.
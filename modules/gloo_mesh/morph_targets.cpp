@@ -0,0 +1,296 @@
+#include "morph_targets.h"
+
+#include <cmath>
+#include <cassert>
+#include <algorithm>
+
+namespace gloo
+{
+
+namespace
+{
+  const GLuint kNoSlot = ~0u;
+
+  // Formats of the buffer textures: ranges, entries and weights.
+  const GLenum kMorphTextureFormats[3] = { GL_RG32UI, GL_RGBA32F, GL_R32F };
+  const GLuint kMorphTextureUnits[3] = { kMorphRangeUnit, kMorphDeltaUnit, kMorphWeightUnit };
+  const char* const kMorphBufferNames[3] = { "MorphRanges", "MorphDeltas", "MorphWeights" };
+
+  // Normalizes 'v' in place (unless it has no length).
+  void Normalize(GLfloat* v)
+  {
+    const GLfloat length = std::sqrt(v[0]*v[0] + v[1]*v[1] + v[2]*v[2]);
+    if (length > 0.0f)
+    {
+      v[0] /= length;
+      v[1] /= length;
+      v[2] /= length;
+    }
+  }
+}  // namespace.
+
+MorphTargetSet::~MorphTargetSet()
+{
+  for (GLuint i = 0; i < 3; i++)
+    GpuMemory::ReleaseBuffer(mBuffers[i]);
+
+  glDeleteTextures(3, mTextures);
+  glDeleteBuffers(3, mBuffers);
+}
+
+GLuint MorphTargetSet::AddTarget(const std::vector<MorphDelta> & deltas)
+{
+  mTargets.push_back(deltas);
+  mWeights.push_back(0.0f);
+  mBlendedWeights.push_back(0.0f);
+  mWeightsDirty = true;
+
+  return mTargets.size() - 1;
+}
+
+GLuint MorphTargetSet::AddTarget(const GLfloat* basePositions, const GLfloat* baseNormals,
+                                 const GLfloat* targetPositions, const GLfloat* targetNormals,
+                                 GLuint numVertices, GLfloat threshold)
+{
+  std::vector<MorphDelta> deltas;
+  for (GLuint v = 0; v < numVertices; v++)
+  {
+    MorphDelta delta { v, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } };
+    bool moves = false;
+
+    for (GLuint k = 0; k < 3; k++)
+    {
+      delta.mPosition[k] = targetPositions[3*v + k] - basePositions[3*v + k];
+      if (targetNormals)
+        delta.mNormal[k] = targetNormals[3*v + k] - baseNormals[3*v + k];
+
+      moves = moves || std::fabs(delta.mPosition[k]) > threshold
+                    || std::fabs(delta.mNormal[k]) > threshold;
+    }
+
+    if (moves)
+      deltas.push_back(delta);
+  }
+
+  return MorphTargetSet::AddTarget(deltas);
+}
+
+void MorphTargetSet::Build(GLuint numVertices, const GLfloat* basePositions,
+                           const GLfloat* baseNormals)
+{
+  mNumVertices = numVertices;
+  mVertexRemap.clear();
+
+  // Count the entries of every vertex, then place them (ordered by target).
+  mRanges.assign(2 * numVertices, 0);
+  for (const std::vector<MorphDelta> & deltas : mTargets)
+  {
+    for (const MorphDelta & delta : deltas)
+    {
+      assert(delta.mVertex < numVertices);
+      mRanges[2*delta.mVertex + 1]++;
+    }
+  }
+
+  GLuint numEntries = 0;
+  std::vector<GLuint> slots(numVertices, kNoSlot);
+  mMorphedVertices.clear();
+  for (GLuint v = 0; v < numVertices; v++)
+  {
+    mRanges[2*v] = numEntries;
+    numEntries += mRanges[2*v + 1];
+
+    if (mRanges[2*v + 1] > 0)
+    {
+      slots[v] = mMorphedVertices.size();
+      mMorphedVertices.push_back(v);
+    }
+  }
+
+  std::vector<GLuint> next(numVertices);
+  for (GLuint v = 0; v < numVertices; v++)
+    next[v] = mRanges[2*v];
+
+  mEntries.assign(kEntrySize * numEntries, 0.0f);
+  mTargetSlots.assign(mTargets.size(), std::vector<GLuint>());
+  for (GLuint t = 0; t < mTargets.size(); t++)
+  {
+    for (const MorphDelta & delta : mTargets[t])
+    {
+      GLfloat* entry = &mEntries[kEntrySize * next[delta.mVertex]++];
+      std::copy(delta.mPosition, delta.mPosition + 3, entry);
+      entry[3] = static_cast<GLfloat>(t);
+      std::copy(delta.mNormal, delta.mNormal + 3, entry + 4);
+
+      mTargetSlots[t].push_back(slots[delta.mVertex]);
+    }
+  }
+
+  // Base attributes of the morphed vertices (CPU path).
+  const GLuint numMorphed = mMorphedVertices.size();
+  mBasePositions.clear();
+  mBaseNormals.clear();
+  for (GLuint s = 0; s < numMorphed; s++)
+  {
+    const GLuint v = mMorphedVertices[s];
+    if (basePositions)
+      mBasePositions.insert(mBasePositions.end(), &basePositions[3*v], &basePositions[3*v + 3]);
+    if (baseNormals)
+      mBaseNormals.insert(mBaseNormals.end(), &baseNormals[3*v], &baseNormals[3*v + 3]);
+  }
+
+  mBlendedPositions.resize(mBasePositions.size());
+  mBlendedNormals.resize(mBaseNormals.size());
+
+  // The group holds the base mesh: every nonzero weight has to be applied.
+  std::fill(mBlendedWeights.begin(), mBlendedWeights.end(), 0.0f);
+}
+
+void MorphTargetSet::Upload()
+{
+  // Shaders look up the ranges by stored vertex (gl_VertexID).
+  std::vector<GLuint> ranges(mRanges);
+  if (!mVertexRemap.empty())
+  {
+    for (GLuint v = 0; v < mNumVertices; v++)
+    {
+      ranges[2*mVertexRemap[v]]     = mRanges[2*v];
+      ranges[2*mVertexRemap[v] + 1] = mRanges[2*v + 1];
+    }
+  }
+
+  // Buffer textures can't be empty: pad the tables to one texel.
+  std::vector<GLfloat> entries(mEntries);
+  std::vector<GLfloat> weights(mWeights);
+  ranges.resize(std::max<size_t>(ranges.size(), 2), 0);
+  entries.resize(std::max<size_t>(entries.size(), kEntrySize), 0.0f);
+  weights.resize(std::max<size_t>(weights.size(), 1), 0.0f);
+
+  const GLsizeiptr sizes[3] = { GLsizeiptr(ranges.size() * sizeof(GLuint)),
+                                GLsizeiptr(entries.size() * sizeof(GLfloat)),
+                                GLsizeiptr(weights.size() * sizeof(GLfloat)) };
+  const void* data[3] = { ranges.data(), entries.data(), weights.data() };
+  const GLenum usages[3] = { GL_STATIC_DRAW, GL_STATIC_DRAW, GL_DYNAMIC_DRAW };
+
+  if (!mBuffers[0])
+  {
+    glGenBuffers(3, mBuffers);
+    glGenTextures(3, mTextures);
+  }
+
+  for (GLuint i = 0; i < 3; i++)
+  {
+    glBindBuffer(GL_TEXTURE_BUFFER, mBuffers[i]);
+    glBufferData(GL_TEXTURE_BUFFER, sizes[i], data[i], usages[i]);
+    GpuMemory::TrackBuffer(mBuffers[i], sizes[i], kGpuTextureBuffer, kMorphBufferNames[i]);
+
+    glBindTexture(GL_TEXTURE_BUFFER, mTextures[i]);
+    glTexBuffer(GL_TEXTURE_BUFFER, kMorphTextureFormats[i], mBuffers[i]);
+  }
+
+  glBindBuffer(GL_TEXTURE_BUFFER, 0);
+  glBindTexture(GL_TEXTURE_BUFFER, 0);
+  mWeightsDirty = false;
+}
+
+void MorphTargetSet::Bind()
+{
+  assert(mBuffers[0]);
+
+  if (mWeightsDirty && !mWeights.empty())
+  {
+    glBindBuffer(GL_TEXTURE_BUFFER, mBuffers[2]);
+    glBufferSubData(GL_TEXTURE_BUFFER, 0, mWeights.size() * sizeof(GLfloat), mWeights.data());
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    mWeightsDirty = false;
+  }
+
+  for (GLuint i = 0; i < 3; i++)
+  {
+    glActiveTexture(GL_TEXTURE0 + kMorphTextureUnits[i]);
+    glBindTexture(GL_TEXTURE_BUFFER, mTextures[i]);
+  }
+
+  glActiveTexture(GL_TEXTURE0);
+}
+
+void MorphTargetSet::SetWeight(GLuint target, GLfloat weight)
+{
+  assert(target < mWeights.size());
+
+  if (mWeights[target] != weight)
+  {
+    mWeights[target] = weight;
+    mWeightsDirty = true;
+  }
+}
+
+GLuint MorphTargetSet::BlendChangedVertices(std::vector<std::pair<GLuint, GLuint>> & runs)
+{
+  assert(!mBasePositions.empty() || mMorphedVertices.empty());
+
+  // Morphed vertices of the targets whose weight changed.
+  std::vector<bool> changed(mMorphedVertices.size(), false);
+  std::vector<GLuint> slots;
+  for (GLuint t = 0; t < mTargetSlots.size(); t++)
+  {
+    if (mWeights[t] == mBlendedWeights[t])
+      continue;
+
+    for (GLuint s : mTargetSlots[t])
+    {
+      if (!changed[s])
+      {
+        changed[s] = true;
+        slots.push_back(s);
+      }
+    }
+
+    mBlendedWeights[t] = mWeights[t];
+  }
+
+  std::sort(slots.begin(), slots.end());
+
+  // Blend them from their base attributes (so that errors don't accumulate).
+  runs.clear();
+  for (GLuint s : slots)
+  {
+    const GLuint v = mMorphedVertices[s];
+    GLfloat* position = &mBlendedPositions[3*s];
+    GLfloat* normal = mBlendedNormals.empty() ? nullptr : &mBlendedNormals[3*s];
+
+    std::copy(&mBasePositions[3*s], &mBasePositions[3*s + 3], position);
+    if (normal)
+      std::copy(&mBaseNormals[3*s], &mBaseNormals[3*s + 3], normal);
+
+    const GLuint first = mRanges[2*v];
+    const GLuint last = first + mRanges[2*v + 1];
+    for (GLuint e = first; e < last; e++)
+    {
+      const GLfloat* entry = &mEntries[kEntrySize * e];
+      const GLfloat weight = mWeights[static_cast<GLuint>(entry[3])];
+      if (weight == 0.0f)
+        continue;
+
+      for (GLuint k = 0; k < 3; k++)
+      {
+        position[k] += weight * entry[k];
+        if (normal)
+          normal[k] += weight * entry[4 + k];
+      }
+    }
+
+    if (normal)
+      Normalize(normal);
+
+    // Consecutive vertices extend the last run.
+    if (!runs.empty() && runs.back().second == s && mMorphedVertices[s - 1] + 1 == v)
+      runs.back().second++;
+    else
+      runs.push_back({s, s + 1});
+  }
+
+  return slots.size();
+}
+
+}  // namespace gloo.
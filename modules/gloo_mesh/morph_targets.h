@@ -0,0 +1,202 @@
+// + ======================================== +
+// |         gl-oo-interface library          |
+// |            Module: GLOO Mesh.            |
+// |        Author: Rodrigo Castiel, 2016.    |
+// + ======================================== +
+//
+// Morph targets (blend shapes) of a MeshGroup, stored as sparse deltas.
+//
+// A morph target (a facial expression, a corrective shape, ...) moves a few hundred vertices of a
+// mesh of many thousands, so only the vertices it moves are stored: (vertex, position delta,
+// normal delta). The blended mesh is base + sum of weight * delta over the targets, and normals
+// are renormalized.
+//
+// Build() gathers the deltas of all targets per vertex: vertex v has the entries
+// [first, first + count) of a single table, ordered by target. Blending can then run:
+//  -> On the GPU: Upload() stores the tables in buffer textures (GL_TEXTURE_BUFFER), which
+//     Bind() binds to kMorphRangeUnit, kMorphDeltaUnit and kMorphWeightUnit (uploading the
+//     weights first, if they changed). Morphing shaders (e.g. shaders/morph_phong) look up their
+//     vertex with gl_VertexID (modulo the number of vertices, so that streaming frames work), so
+//     the vertex buffer is never touched. Not for groups stored in a MeshArena.
+//  -> On the CPU: Apply() blends only the vertices of the targets whose weight changed since
+//     the last call, and writes them with partial updates (MeshGroup::Update(attrib, first,
+//     count, data)), one per run of consecutive vertices, instead of updating whole arrays.
+//
+// Vertex indices refer to the vertices of the group as loaded (after welding, see group.h).
+// The vertex cache optimization may store them in another order: Build(group, ...) keeps the
+// vertex remap of the group, so that Upload() places the ranges at the stored vertices and the
+// GPU path works on reordered groups. The CPU path needs partial updates, which reordered
+// groups don't allow (Apply() asserts it). Buffer textures of at least 64K texels are
+// guaranteed: larger meshes need a context with a larger GL_MAX_TEXTURE_BUFFER_SIZE (all
+// desktop GPUs have it).
+//
+// [USAGE]
+/*
+    MorphTargetSet morphs;
+    GLuint smile = morphs.AddTarget(positions, normals, smilePositions, smileNormals, numVertices);
+    GLuint blink = morphs.AddTarget(blinkDeltas);
+    morphs.Build(group, positions, normals);  // MeshGroup<Interleave>* group (already loaded).
+
+    Transform model;
+    Camera* camera = new Camera();
+
+    // GPU blending (shaders/morph_phong).
+    morphs.Upload();
+    ...
+    morphs.SetWeight(smile, 0.7f);
+    morphs.Bind();
+    renderer->Render(group, model, camera, 0);  // Rendering pass 0.
+
+    // Or CPU blending (shaders/phong).
+    morphs.SetWeight(blink, 1.0f);
+    morphs.Apply(group);  // Positions: attribute 0, normals: attribute 1.
+    renderer->Render(group, model, camera, 0);
+*/
+
+#pragma once
+
+#include "gloo/gl_header.h"
+#include "group.h"
+
+#include <vector>
+#include <utility>
+#include <cassert>
+
+namespace gloo
+{
+
+// Texture units of the morph tables (see Bind()). Morphing shaders must use the same units.
+const GLuint kMorphRangeUnit  = 8;
+const GLuint kMorphDeltaUnit  = 9;
+const GLuint kMorphWeightUnit = 10;
+
+// Dense targets keep the vertices whose position or normal moves more than this (any component).
+const GLfloat kDefaultMorphThreshold = 1e-6f;
+
+// Displacement of a single vertex by a morph target.
+struct MorphDelta
+{
+  GLuint mVertex;
+  GLfloat mPosition[3];
+  GLfloat mNormal[3];
+};
+
+class MorphTargetSet
+{
+public:
+  MorphTargetSet() { }
+  ~MorphTargetSet();
+
+  // The set owns its buffers and textures.
+  MorphTargetSet(const MorphTargetSet &) = delete;
+  MorphTargetSet & operator=(const MorphTargetSet &) = delete;
+
+  // Adds a target from its deltas and returns its index. Its weight starts at 0.
+  GLuint AddTarget(const std::vector<MorphDelta> & deltas);
+
+  // Adds a target from full arrays (3 floats per vertex), keeping the vertices it moves.
+  // Normals may be nullptr (both of them).
+  GLuint AddTarget(const GLfloat* basePositions, const GLfloat* baseNormals,
+                   const GLfloat* targetPositions, const GLfloat* targetNormals,
+                   GLuint numVertices, GLfloat threshold = kDefaultMorphThreshold);
+
+  // Builds the per-vertex tables of a group of 'numVertices' vertices, whose unmorphed positions
+  // and normals (3 floats per vertex, as loaded) are given for the CPU path (they may be nullptr
+  // if only the GPU path is used). Must be called again if targets are added afterwards.
+  void Build(GLuint numVertices, const GLfloat* basePositions, const GLfloat* baseNormals);
+
+  // Same as above for the vertices of a loaded group, keeping its vertex remap for Upload().
+  template <StorageFormat F>
+  void Build(const MeshGroup<F>* group, const GLfloat* basePositions, const GLfloat* baseNormals);
+
+  // GPU path: uploads the tables built by Build() into buffer textures (ranges in the order of
+  // the stored vertices).
+  void Upload();
+
+  // GPU path: uploads the weights (if they changed) and binds the tables to their units.
+  void Bind();
+
+  // CPU path: blends the vertices of the targets whose weight changed since the last call and
+  // updates them in 'group' (normals are skipped if 'normalAttrib' is -1). Returns the number
+  // of vertices written.
+  template <StorageFormat F>
+  GLuint Apply(MeshGroup<F>* group, GLuint positionAttrib = 0, GLint normalAttrib = 1);
+
+  // Weights.
+  void SetWeight(GLuint target, GLfloat weight);
+  GLfloat GetWeight(GLuint target) const { return mWeights[target]; }
+
+  // Getters.
+  GLuint GetNumTargets() const { return mTargets.size(); }
+  GLuint GetNumMorphedVertices() const { return mMorphedVertices.size(); }
+  GLuint GetNumEntries() const { return mEntries.size() / kEntrySize; }
+
+private:
+  // Floats per table entry: position delta and target index, normal delta and padding.
+  static const GLuint kEntrySize = 8;
+
+  // Blends the morphed vertices affected by weight changes into mBlendedPositions/Normals and
+  // lists them as runs [first, end) of consecutive vertices (indices into mMorphedVertices).
+  GLuint BlendChangedVertices(std::vector<std::pair<GLuint, GLuint>> & runs);
+
+  // Targets (as added) and their morphed vertices (indices into mMorphedVertices).
+  std::vector<std::vector<MorphDelta>> mTargets;
+  std::vector<std::vector<GLuint>> mTargetSlots;
+  std::vector<GLfloat> mWeights;
+  std::vector<GLfloat> mBlendedWeights;  // Weights of the last Apply().
+  bool mWeightsDirty { false };          // Weights changed since the last Bind().
+
+  // Per-vertex tables: (first entry, number of entries) of every vertex, and the entries.
+  GLuint mNumVertices { 0 };
+  std::vector<GLuint> mRanges;
+  std::vector<GLuint> mVertexRemap;  // Loaded -> stored vertex (empty: same order).
+  std::vector<GLfloat> mEntries;
+
+  // CPU path: vertices moved by any target (increasing), their base and blended attributes.
+  std::vector<GLuint> mMorphedVertices;
+  std::vector<GLfloat> mBasePositions;
+  std::vector<GLfloat> mBaseNormals;
+  std::vector<GLfloat> mBlendedPositions;
+  std::vector<GLfloat> mBlendedNormals;
+
+  // GPU path: buffers and buffer textures (ranges, entries, weights).
+  GLuint mBuffers[3] { 0, 0, 0 };
+  GLuint mTextures[3] { 0, 0, 0 };
+};
+
+// ============================================================================================ //
+// Implementation of template functions.
+
+template <StorageFormat F>
+void MorphTargetSet::Build(const MeshGroup<F>* group, const GLfloat* basePositions,
+                           const GLfloat* baseNormals)
+{
+  MorphTargetSet::Build(group->GetNumVertices(), basePositions, baseNormals);
+  mVertexRemap = group->GetVertexRemap();
+}
+
+template <StorageFormat F>
+GLuint MorphTargetSet::Apply(MeshGroup<F>* group, GLuint positionAttrib, GLint normalAttrib)
+{
+  assert(group->GetVertexRemap().empty());  // Runs of loaded vertices must be stored in order.
+
+  std::vector<std::pair<GLuint, GLuint>> runs;
+  const GLuint numBlended = MorphTargetSet::BlendChangedVertices(runs);
+
+  for (const std::pair<GLuint, GLuint> & run : runs)
+  {
+    const GLuint firstVertex = mMorphedVertices[run.first];
+    const GLuint count = run.second - run.first;
+
+    group->Update(positionAttrib, firstVertex, count, &mBlendedPositions[3 * run.first]);
+    if (normalAttrib >= 0 && !mBlendedNormals.empty())
+      group->Update(normalAttrib, firstVertex, count, &mBlendedNormals[3 * run.first]);
+  }
+
+  if (!runs.empty())
+    group->FlushUpdates();
+
+  return numBlended;
+}
+
+}  // namespace gloo.
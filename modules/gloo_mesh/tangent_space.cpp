@@ -0,0 +1,281 @@
+#include "tangent_space.h"
+#include "index_format.h"
+
+#include <cmath>
+#include <thread>
+#include <vector>
+#include <cassert>
+#include <algorithm>
+
+namespace gloo
+{
+
+namespace
+{
+  // Runs 'kernel(first, last)' over [0, count), split across threads if it's large enough.
+  template <class Kernel>
+  void RunRanges(GLuint count, const Kernel & kernel)
+  {
+    const GLuint maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    const GLuint numThreads = std::min(maxThreads, count / kParallelTangentTriangles);
+
+    if (numThreads <= 1)
+    {
+      kernel(0, count);
+      return;
+    }
+
+    const GLuint rangeSize = (count + numThreads - 1) / numThreads;
+
+    std::vector<std::thread> threads;
+    for (GLuint first = rangeSize; first < count; first += rangeSize)
+      threads.emplace_back(kernel, first, std::min(first + rangeSize, count));
+
+    kernel(0, std::min(rangeSize, count));
+    for (std::thread & thread : threads)
+      thread.join();
+  }
+
+  void Subtract(const GLfloat* a, const GLfloat* b, GLfloat* d)
+  {
+    d[0] = a[0] - b[0];
+    d[1] = a[1] - b[1];
+    d[2] = a[2] - b[2];
+  }
+
+  GLfloat Dot(const GLfloat* a, const GLfloat* b)
+  {
+    return a[0]*b[0] + a[1]*b[1] + a[2]*b[2];
+  }
+
+  void Cross(const GLfloat* a, const GLfloat* b, GLfloat* c)
+  {
+    c[0] = a[1]*b[2] - a[2]*b[1];
+    c[1] = a[2]*b[0] - a[0]*b[2];
+    c[2] = a[0]*b[1] - a[1]*b[0];
+  }
+
+  // Normalizes 'v' in place. Returns false (and leaves it as it is) if it has no length.
+  bool Normalize(GLfloat* v)
+  {
+    const GLfloat length = std::sqrt(Dot(v, v));
+    if (length <= 0.0f)
+      return false;
+
+    v[0] /= length;
+    v[1] /= length;
+    v[2] /= length;
+    return true;
+  }
+
+  // Angle of triangle (i0, i1, i2) at vertex i0 (0 if an edge is degenerate).
+  GLfloat ComputeCornerAngle(const GLfloat* positions, GLuint i0, GLuint i1, GLuint i2)
+  {
+    GLfloat e1[3], e2[3];
+    Subtract(&positions[3*i1], &positions[3*i0], e1);
+    Subtract(&positions[3*i2], &positions[3*i0], e2);
+
+    if (!Normalize(e1) || !Normalize(e2))
+      return 0.0f;
+
+    return std::acos(std::max(-1.0f, std::min(1.0f, Dot(e1, e2))));
+  }
+
+  // Unit vector orthogonal to 'n' (used where the uvs don't define a tangent).
+  void ComputeOrthogonal(const GLfloat* n, GLfloat* t)
+  {
+    const GLfloat axis[3] = { std::fabs(n[0]) < 0.9f ? 1.0f : 0.0f,
+                              std::fabs(n[0]) < 0.9f ? 0.0f : 1.0f, 0.0f };
+    const GLfloat d = Dot(n, axis);
+    t[0] = axis[0] - d * n[0];
+    t[1] = axis[1] - d * n[1];
+    t[2] = axis[2] - d * n[2];
+
+    if (!Normalize(t))
+    {
+      t[0] = 1.0f;
+      t[1] = t[2] = 0.0f;
+    }
+  }
+
+  // Returns a triangle list for 'indices' (strips are triangulated into 'triangles').
+  const GLuint* GetTriangleList(const GLuint* indices, GLuint & numIndices, GLenum drawMode,
+                                std::vector<GLuint> & triangles)
+  {
+    assert(drawMode == GL_TRIANGLES || drawMode == GL_TRIANGLE_STRIP);
+    if (drawMode == GL_TRIANGLES)
+    {
+      numIndices -= numIndices % 3;
+      return indices;
+    }
+
+    triangles = TriangulateStrip(indices, numIndices);
+    numIndices = triangles.size();
+    return triangles.data();
+  }
+
+  // Lists the corners (positions in 'indices') of each vertex v in
+  // corners[offsets[v], offsets[v+1]), in increasing order.
+  void BuildVertexCorners(const GLuint* indices, GLuint numIndices, GLuint numVertices,
+                          std::vector<GLuint> & offsets, std::vector<GLuint> & corners)
+  {
+    offsets.assign(numVertices + 1, 0);
+    for (GLuint i = 0; i < numIndices; i++)
+      offsets[indices[i] + 1]++;
+
+    for (GLuint v = 0; v < numVertices; v++)
+      offsets[v + 1] += offsets[v];
+
+    std::vector<GLuint> next(offsets.begin(), offsets.end() - 1);
+    corners.resize(numIndices);
+    for (GLuint i = 0; i < numIndices; i++)
+      corners[next[indices[i]]++] = i;
+  }
+}  // namespace.
+
+void ComputeNormals(const GLfloat* positions, GLuint numVertices, const GLuint* indices,
+                    GLuint numIndices, GLenum drawMode, GLfloat* normals)
+{
+  std::vector<GLuint> triangles;
+  indices = GetTriangleList(indices, numIndices, drawMode, triangles);
+
+  // Pass 1: normal of each triangle, weighted by the angle of each corner.
+  std::vector<GLfloat> contributions(3 * numIndices);
+  RunRanges(numIndices / 3, [&](GLuint first, GLuint last)
+  {
+    for (GLuint t = first; t < last; t++)
+    {
+      const GLuint* tri = &indices[3*t];
+
+      GLfloat e1[3], e2[3], n[3];
+      Subtract(&positions[3*tri[1]], &positions[3*tri[0]], e1);
+      Subtract(&positions[3*tri[2]], &positions[3*tri[0]], e2);
+      Cross(e1, e2, n);
+
+      const bool degenerate = !Normalize(n);
+      for (GLuint c = 0; c < 3; c++)
+      {
+        const GLfloat angle = degenerate ? 0.0f : ComputeCornerAngle(positions, tri[c],
+                                                                     tri[(c+1) % 3],
+                                                                     tri[(c+2) % 3]);
+        for (GLuint k = 0; k < 3; k++)
+          contributions[3*(3*t + c) + k] = angle * n[k];
+      }
+    }
+  });
+
+  // Pass 2: each vertex sums the contributions of its corners.
+  std::vector<GLuint> offsets, corners;
+  BuildVertexCorners(indices, numIndices, numVertices, offsets, corners);
+
+  RunRanges(numVertices, [&](GLuint first, GLuint last)
+  {
+    for (GLuint v = first; v < last; v++)
+    {
+      GLfloat* n = &normals[3*v];
+      n[0] = n[1] = n[2] = 0.0f;
+
+      for (GLuint i = offsets[v]; i < offsets[v + 1]; i++)
+      {
+        for (GLuint k = 0; k < 3; k++)
+          n[k] += contributions[3*corners[i] + k];
+      }
+
+      Normalize(n);
+    }
+  });
+}
+
+void ComputeTangents(const GLfloat* positions, const GLfloat* normals, const GLfloat* uvs,
+                     GLuint numVertices, const GLuint* indices, GLuint numIndices,
+                     GLenum drawMode, GLfloat* tangents, GLuint tangentSize)
+{
+  assert(tangentSize == 3 || tangentSize == 4);
+
+  std::vector<GLuint> triangles;
+  indices = GetTriangleList(indices, numIndices, drawMode, triangles);
+
+  // Pass 1: tangent of each triangle, projected onto the plane of each corner normal and
+  // weighted by the corner angle, and the orientation of the uvs (handedness).
+  std::vector<GLfloat> contributions(3 * numIndices);
+  std::vector<GLfloat> orientations(numIndices);
+  RunRanges(numIndices / 3, [&](GLuint first, GLuint last)
+  {
+    for (GLuint t = first; t < last; t++)
+    {
+      const GLuint* tri = &indices[3*t];
+
+      GLfloat e1[3], e2[3];
+      Subtract(&positions[3*tri[1]], &positions[3*tri[0]], e1);
+      Subtract(&positions[3*tri[2]], &positions[3*tri[0]], e2);
+
+      const GLfloat s1 = uvs[2*tri[1]]     - uvs[2*tri[0]];
+      const GLfloat t1 = uvs[2*tri[1] + 1] - uvs[2*tri[0] + 1];
+      const GLfloat s2 = uvs[2*tri[2]]     - uvs[2*tri[0]];
+      const GLfloat t2 = uvs[2*tri[2] + 1] - uvs[2*tri[0] + 1];
+
+      // dP/du, up to the (positive) factor 1/|r|.
+      const GLfloat r = s1*t2 - s2*t1;
+      const GLfloat sign = (r < 0.0f) ? -1.0f : 1.0f;
+      GLfloat tangent[3] = { sign * (e1[0]*t2 - e2[0]*t1),
+                             sign * (e1[1]*t2 - e2[1]*t1),
+                             sign * (e1[2]*t2 - e2[2]*t1) };
+
+      const bool degenerate = (r == 0.0f) || !Normalize(tangent);
+      for (GLuint c = 0; c < 3; c++)
+      {
+        GLfloat* out = &contributions[3*(3*t + c)];
+        out[0] = out[1] = out[2] = 0.0f;
+        orientations[3*t + c] = 0.0f;
+        if (degenerate)
+          continue;
+
+        const GLfloat* n = &normals[3*tri[c]];
+        const GLfloat d = Dot(n, tangent);
+        GLfloat projected[3] = { tangent[0] - d*n[0], tangent[1] - d*n[1], tangent[2] - d*n[2] };
+        if (!Normalize(projected))
+          continue;
+
+        const GLfloat angle = ComputeCornerAngle(positions, tri[c], tri[(c+1) % 3],
+                                                 tri[(c+2) % 3]);
+        for (GLuint k = 0; k < 3; k++)
+          out[k] = angle * projected[k];
+
+        orientations[3*t + c] = angle * sign;
+      }
+    }
+  });
+
+  // Pass 2: each vertex sums the contributions of its corners.
+  std::vector<GLuint> offsets, corners;
+  BuildVertexCorners(indices, numIndices, numVertices, offsets, corners);
+
+  RunRanges(numVertices, [&](GLuint first, GLuint last)
+  {
+    for (GLuint v = first; v < last; v++)
+    {
+      GLfloat t[3] = { 0.0f, 0.0f, 0.0f };
+      GLfloat orientation = 0.0f;
+
+      for (GLuint i = offsets[v]; i < offsets[v + 1]; i++)
+      {
+        for (GLuint k = 0; k < 3; k++)
+          t[k] += contributions[3*corners[i] + k];
+
+        orientation += orientations[corners[i]];
+      }
+
+      if (!Normalize(t))
+        ComputeOrthogonal(&normals[3*v], t);
+
+      GLfloat* out = &tangents[tangentSize * v];
+      out[0] = t[0];
+      out[1] = t[1];
+      out[2] = t[2];
+      if (tangentSize == 4)
+        out[3] = (orientation < 0.0f) ? -1.0f : 1.0f;
+    }
+  });
+}
+
+}  // namespace gloo.
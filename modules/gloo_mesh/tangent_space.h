@@ -0,0 +1,56 @@
+// + ======================================== +
+// |         gl-oo-interface library          |
+// |            Module: GLOO Mesh.            |
+// |        Author: Rodrigo Castiel, 2016.    |
+// + ======================================== +
+//
+// Vertex normals and tangent frames for indexed triangle meshes.
+//
+// ComputeNormals() averages the normals of the triangles around each vertex, weighted by the
+// angle of the triangle at that vertex (so that the result doesn't depend on how the surface is
+// triangulated). ComputeTangents() follows MikkTSpace (Mikkelsen, "Simulation of Wrinkled
+// Surfaces Revisited", 2008), which is what baking tools assume for normal maps: the tangent of
+// each triangle (the direction of increasing u) is projected onto the plane of the vertex
+// normal, weighted by the angle and averaged. With tangentSize = 4, w holds the handedness of
+// the frame (bitangent = w * cross(normal, tangent)); the normal_mapping_phong shaders take
+// 3 components and assume +1. Unlike MikkTSpace, vertices aren't split where the handedness
+// flips (mirrored UVs): such seams must already have separate vertices.
+//
+// Both run in two passes: triangles (in chunks of kParallelTangentTriangles, across threads)
+// compute one contribution per corner, then vertices (across threads as well) gather the
+// contributions of their corners. No two threads write the same value, so there are no locks or
+// atomics, and the results are the same for any number of threads.
+//
+// Positions and normals have 3 floats per vertex, uvs have 2 (as passed to MeshGroup::Load()).
+// 'drawMode' is GL_TRIANGLES or GL_TRIANGLE_STRIP (with primitive restart, see index_format.h).
+//
+// [USAGE]
+/*
+    std::vector<GLfloat> normals(3 * numVertices), tangents(3 * numVertices);
+    ComputeNormals(positions.data(), numVertices, indices.data(), indices.size(), GL_TRIANGLES,
+                   normals.data());
+    ComputeTangents(positions.data(), normals.data(), uvs.data(), numVertices, indices.data(),
+                    indices.size(), GL_TRIANGLES, tangents.data());
+    group->Load({positions.data(), normals.data(), uvs.data(), tangents.data()}, indices.data());
+*/
+
+#pragma once
+
+#include "gloo/gl_header.h"
+
+namespace gloo
+{
+
+const GLuint kParallelTangentTriangles = 1 << 15;  // Minimum triangles per thread.
+
+// Writes a unit normal per vertex into 'normals' (vertices without triangles get (0, 0, 0)).
+void ComputeNormals(const GLfloat* positions, GLuint numVertices, const GLuint* indices,
+                    GLuint numIndices, GLenum drawMode, GLfloat* normals);
+
+// Writes a unit tangent per vertex into 'tangents' ('tangentSize' floats per vertex: 3, or 4
+// with the handedness). Vertices whose uvs are degenerate get a tangent orthogonal to the normal.
+void ComputeTangents(const GLfloat* positions, const GLfloat* normals, const GLfloat* uvs,
+                     GLuint numVertices, const GLuint* indices, GLuint numIndices,
+                     GLenum drawMode, GLfloat* tangents, GLuint tangentSize = 3);
+
+}  // namespace gloo.
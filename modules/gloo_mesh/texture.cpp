@@ -1,5 +1,8 @@
 #include "texture.h"
+#include "gloo/gl_capabilities.h"
 
+#include <vector>
+#include <utility>
 #include <iostream>
 
 #define LOG_OUTPUT_ON 1
@@ -7,58 +10,171 @@
 namespace gloo
 {
 
+namespace
+{
+  // Number of channels of an input format.
+  int GetFormatChannels(GLenum format)
+  {
+    switch (format)
+    {
+      case GL_RG:   return 2;
+      case GL_RGB:
+      case GL_BGR:  return 3;
+      case GL_RGBA:
+      case GL_BGRA: return 4;
+      default:      return 1;  // GL_RED, GL_DEPTH_COMPONENT, ...
+    }
+  }
+
+  // Input format of an image with 'channels' channels.
+  GLenum GetChannelsFormat(int channels)
+  {
+    switch (channels)
+    {
+      case 1:  return GL_RED;
+      case 2:  return GL_RG;
+      case 3:  return GL_RGB;
+      default: return GL_RGBA;
+    }
+  }
+
+  // Sized internal format that keeps the channels and precision of the input.
+  GLenum GetSizedFormat(GLenum format, GLenum type)
+  {
+    if (format == GL_DEPTH_COMPONENT)
+      return (type == GL_FLOAT) ? GL_DEPTH_COMPONENT32F : GL_DEPTH_COMPONENT24;
+
+    const int channels = GetFormatChannels(format);
+    if (type == GL_FLOAT)
+    {
+      const GLenum formats[] = { GL_R32F, GL_RG32F, GL_RGB32F, GL_RGBA32F };
+      return formats[channels - 1];
+    }
+    if (type == GL_HALF_FLOAT)
+    {
+      const GLenum formats[] = { GL_R16F, GL_RG16F, GL_RGB16F, GL_RGBA16F };
+      return formats[channels - 1];
+    }
+
+    const GLenum formats[] = { GL_R8, GL_RG8, GL_RGB8, GL_RGBA8 };
+    return formats[channels - 1];
+  }
+
+  // Expands 'count' luminance (1 channel) or luminance-alpha (2 channels) pixels into RGB/RGBA.
+  std::vector<GLubyte> ExpandLuminance(const GLubyte* pixels, int count, int channels)
+  {
+    std::vector<GLubyte> expanded;
+    expanded.reserve(count * (channels + 2));
+    for (int i = 0; i < count; i++)
+    {
+      const GLubyte* pixel = pixels + i * channels;
+      expanded.insert(expanded.end(), 3, pixel[0]);
+      if (channels == 2)
+        expanded.push_back(pixel[1]);
+    }
+
+    return expanded;
+  }
+
+  // Bytes per texel of the internal formats above.
+  GLuint GetTexelBytes(GLenum internalFormat)
+  {
+    switch (internalFormat)
+    {
+      case GL_R8:                  return 1;
+      case GL_RG8:
+      case GL_R16F:                return 2;
+      case GL_RGB8:                return 3;
+      case GL_RGBA8:
+      case GL_RG16F:
+      case GL_R32F:
+      case GL_DEPTH_COMPONENT24:
+      case GL_DEPTH_COMPONENT32F:  return 4;
+      case GL_RGB16F:              return 6;
+      case GL_RGBA16F:
+      case GL_RG32F:               return 8;
+      case GL_RGB32F:              return 12;
+      default:                     return 16;  // GL_RGBA32F.
+    }
+  }
+}  // namespace.
+
 Texture2d::~Texture2d()
 {
+  GpuMemory::Release(kGpuTextureObject, mBuffer);
   glDeleteTextures(1, &mBuffer);
 }
 
+Texture2d::Texture2d(Texture2d && other)
+{
+  Texture2d::Swap(other);
+}
+
+Texture2d & Texture2d::operator=(Texture2d && other)
+{
+  Texture2d moved(std::move(other));  // Leaves 'other' empty.
+  Texture2d::Swap(moved);             // The previous texture is deleted with 'moved'.
+  return *this;
+}
+
+void Texture2d::Swap(Texture2d & other)
+{
+  std::swap(mBuffer, other.mBuffer);
+  std::swap(mWidth, other.mWidth);
+  std::swap(mHeight, other.mHeight);
+  std::swap(mInternalFormat, other.mInternalFormat);
+  std::swap(mDebugName, other.mDebugName);
+}
+
 bool Texture2d::Load(ImageIO* source, GLenum format, GLenum type)
 {
-  glGenTextures(1, &mBuffer);
-  glBindTexture(GL_TEXTURE_2D, mBuffer);
+  // The pixels hold as many channels as the source has bytes per pixel.
+  const int bytesPerPixel = source->getBytesPerPixel();
+  if (type == GL_UNSIGNED_BYTE && GetFormatChannels(format) != bytesPerPixel)
+    format = GetChannelsFormat(bytesPerPixel);
+
+  // 1 and 2-channel images are luminance (and alpha): they are stored as GL_R8/GL_RG8 and
+  // sampled as (L, L, L, 1)/(L, L, L, A) through a swizzle, or expanded into RGB/RGBA if the
+  // context can't swizzle.
+  const int channels = GetFormatChannels(format);
+  const bool luminance = type == GL_UNSIGNED_BYTE && format != GL_DEPTH_COMPONENT && channels <= 2;
+  const bool swizzle = IsGLVersionSupported(3, 3)
+                    || IsGLExtensionSupported("GL_ARB_texture_swizzle");
+
+  const void* pixels = source->getPixels();
+  std::vector<GLubyte> expanded;
+  if (luminance && !swizzle)
+  {
+    expanded = ExpandLuminance(source->getPixels(), source->getWidth() * source->getHeight(),
+                               channels);
+    pixels = expanded.data();
+    format = (channels == 1) ? GL_RGB : GL_RGBA;
+  }
 
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  // Rows of 1 and 3-channel images aren't always aligned to 4 bytes.
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  Texture2d::Allocate(source->getWidth(), source->getHeight(), format, type, pixels, kGpuTexture);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 
-  int bytesPerPixel = source->getBytesPerPixel();
-  // TODO: use bytesPerPixel to use a different input internal format.
+  // Reloading reuses the texture object: the swizzle is always set.
+  if (swizzle)
+  {
+    const GLint identity[]  = { GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA };
+    const GLint gray[]      = { GL_RED, GL_RED, GL_RED, GL_ONE };
+    const GLint grayAlpha[] = { GL_RED, GL_RED, GL_RED, GL_GREEN };
+    glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA,
+                     !luminance ? identity : (channels == 1) ? gray : grayAlpha);
+  }
 
-  glTexImage2D( GL_TEXTURE_2D,  // Target.
-                0,              // Detail level - original.
-                GL_RGBA,        // How the colors are stored.
-                source->getWidth(),   // Width.
-                source->getHeight(),  // Height.
-                0,                    // Border must be 0. 
-                format,               // Input format.  
-                type,                 // Input data type.
-                source->getPixels()   // Buffer address.
-  );
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 
   return true;
 }
 
 bool Texture2d::Load(int width, int height, GLenum format, GLenum type)
 {
-  glGenTextures(1, &mBuffer);
-  glBindTexture(GL_TEXTURE_2D, mBuffer);
-
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  Texture2d::Allocate(width, height, format, type, nullptr, kGpuRenderTarget);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-  glTexImage2D( GL_TEXTURE_2D,  // Target.
-                0,              // Detail level - original.
-                GL_RGBA,        // How many channels the texture will have.
-                width,   // Width.
-                height,  // Height.
-                0,        // Border must be 0. 
-                format,   // Format (RGB, RGBA, GRBA, and so on).  
-                type,     // Data type (unsigned byte, ...).
-                nullptr   // Buffer address.
-              );
 
   return true;
 }
@@ -70,6 +186,7 @@ bool Texture2d::Load(const std::string & filename, GLenum format, GLenum type)
   if (source->loadJPEG(filename.c_str()) == ImageIO::OK)
   {
     Texture2d::Load(source, format, type);
+    Texture2d::SetDebugName(filename);
     successful = true;
   }
   else
@@ -83,5 +200,42 @@ bool Texture2d::Load(const std::string & filename, GLenum format, GLenum type)
   return successful;
 }
 
+void Texture2d::SetDebugName(const std::string & name)
+{
+  mDebugName = name;
+  GpuMemory::Rename(kGpuTextureObject, mBuffer, name);
+}
+
+void Texture2d::Allocate(int width, int height, GLenum format, GLenum type, const void* pixels,
+                         GpuMemoryCategory category)
+{
+  // Reloading reuses the texture object.
+  if (!mBuffer)
+    glGenTextures(1, &mBuffer);
+
+  glBindTexture(GL_TEXTURE_2D, mBuffer);
+
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+  mWidth  = width;
+  mHeight = height;
+  mInternalFormat = GetSizedFormat(format, type);
+
+  glTexImage2D( GL_TEXTURE_2D,    // Target.
+                0,                // Detail level - original.
+                mInternalFormat,  // How the texels are stored (channels and precision).
+                width,    // Width.
+                height,   // Height.
+                0,        // Border must be 0.
+                format,   // Input format (RGB, RGBA, GRBA, and so on).
+                type,     // Input data type (unsigned byte, ...).
+                pixels    // Buffer address (nullptr = uninitialized).
+              );
+
+  GpuMemory::Track(kGpuTextureObject, mBuffer, GetTexelBytes(mInternalFormat) * width * height,
+                   category, mDebugName);
+}
 
-}  // namespace gloo.
\ No newline at end of file
+}  // namespace gloo.
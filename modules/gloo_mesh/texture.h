@@ -3,12 +3,20 @@
 // |            Module: GLOO Mesh.            |
 // |        Author: Rodrigo Castiel, 2016.    |
 // + ======================================== +
+//
+// Texture2d stores an image (or an uninitialized render target) in a 2d texture. The internal
+// format follows the number of channels of the source (GL_R8, GL_RG8, GL_RGB8 or GL_RGBA8 for
+// 8-bit images, the 16F/32F variants for half/float data), so single-channel images don't take
+// four times their size. 1 and 2-channel images are luminance (and alpha), swizzled to sample as
+// (L, L, L, 1) and (L, L, L, A). Storage is reported to GpuMemory (see gpu_memory.h).
 
 #pragma once
 
 #include <string>
 #include "../../dependencies/imageIO/imageIO.h"
 #include "gloo/gl_header.h"
+#include "gloo/gpu_memory.h"
+#include "gloo/resource_pool.h"
 
 namespace gloo
 {
@@ -19,6 +27,12 @@ public:
   Texture2d()  { }
   ~Texture2d();
 
+  // Textures own their OpenGL object: they can be moved, but not copied.
+  Texture2d(const Texture2d &) = delete;
+  Texture2d & operator=(const Texture2d &) = delete;
+  Texture2d(Texture2d && other);
+  Texture2d & operator=(Texture2d && other);
+
   void Bind(GLenum unit=GL_TEXTURE0) const;
 
   // Loads image source from buffer on memory.
@@ -30,10 +44,35 @@ public:
   // Loads a non-initialized buffer.
   bool Load(int width, int height, GLenum format=GL_RGB, GLenum type=GL_UNSIGNED_BYTE);
 
+  // Name of this texture in GPU memory reports (the file name, if loaded from a file).
+  void SetDebugName(const std::string & name);
+  const std::string & GetDebugName() const { return mDebugName; }
+
+  // Getters.
+  GLuint GetHandle() const { return mBuffer; }
+  int GetWidth()  const { return mWidth;  }
+  int GetHeight() const { return mHeight; }
+  GLenum GetInternalFormat() const { return mInternalFormat; }
+
 private:
+  // Exchanges every member (and so the OpenGL texture) with 'other'.
+  void Swap(Texture2d & other);
+
+  // Allocates the texture storage (and uploads 'pixels', if not null).
+  void Allocate(int width, int height, GLenum format, GLenum type, const void* pixels,
+                GpuMemoryCategory category);
+
   GLuint mBuffer { 0 };  // Texture buffer object.
+
+  int mWidth  { 0 };
+  int mHeight { 0 };
+  GLenum mInternalFormat { GL_NONE };
+
+  std::string mDebugName { "Texture2d" };
 };
 
+typedef Handle<Texture2d> TextureHandle;
+
 inline
 void Texture2d::Bind(GLenum unit) const
 {
@@ -0,0 +1,110 @@
+// + ======================================== +
+// |         gl-oo-interface library          |
+// |            Module: GLOO Mesh.            |
+// |        Author: Rodrigo Castiel, 2016.    |
+// + ======================================== +
+//
+// TypedMeshGroup is an interleaved MeshGroup whose vertex layout is part of its type
+// (see vertex_layout.h).
+//
+// The attribute list is set on construction from the layout, so it can't disagree with the
+// vertex data. Arrays of vertex structs are uploaded with a single copy (no per-attribute
+// conversion), and their size is checked against the layout stride at compile time. Rendering
+// passes must list exactly one location per layout attribute, which is also checked at compile
+// time (MeshGroup::AddRenderingPass() asserts it at runtime).
+//
+// A TypedMeshGroup is a MeshGroup<Interleave>, so it's rendered (and optimized, streamed, stored
+// in arenas, ...) as any other interleaved group.
+//
+// [USAGE]
+/*
+    typedef Layout<Pos3f, Nrm3f, Uv2f> PhongLayout;
+
+    struct PhongVertex
+    {
+      GLfloat mPosition[3];
+      GLfloat mNormal[3];
+      GLfloat mUv[2];
+    };
+
+    TypedMeshGroup<PhongLayout>* mesh = new TypedMeshGroup<PhongLayout>(numVertices, numIndices,
+                                                                        GL_TRIANGLES);
+    mesh->AddRenderingPass({{posLoc, true}, {normalLoc, true}, {uvLoc, true}});
+    mesh->Load(vertices, indices);  // const PhongVertex* vertices.
+*/
+
+#pragma once
+
+#include "group.h"
+#include "vertex_layout.h"
+
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+
+namespace gloo
+{
+
+template <class L>
+class TypedMeshGroup : public MeshGroup<Interleave>
+{
+public:
+  typedef L VertexLayout;
+
+  TypedMeshGroup(int numVertices, int numElements, GLenum drawMode = GL_TRIANGLE_STRIP,
+                 GLenum dataUsage = GL_STATIC_DRAW)
+  : MeshGroup<Interleave>(numVertices, numElements, drawMode, dataUsage)
+  {
+    MeshGroup<Interleave>::SetVertexAttribList(L::GetAttribList());
+  }
+
+  // One (location, active) pair per layout attribute.
+  template <std::size_t N>
+  int AddRenderingPass(const std::pair<GLint, bool> (&attribList)[N])
+  {
+    static_assert(N == L::kNumAttribs, "Rendering pass must list every attribute of the layout.");
+    return MeshGroup<Interleave>::AddRenderingPass({ attribList, attribList + N });
+  }
+
+  template <std::size_t N>
+  int AddInstancedRenderingPass(const std::pair<GLint, bool> (&attribList)[N],
+                                GLint instanceAttribLoc)
+  {
+    static_assert(N == L::kNumAttribs, "Rendering pass must list every attribute of the layout.");
+    return MeshGroup<Interleave>::AddInstancedRenderingPass({ attribList, attribList + N },
+                                                            instanceAttribLoc);
+  }
+
+  // Loads/updates an array of vertex structs (one per vertex, matching the layout).
+  // Float buffers (see MeshGroup::Load()) are still accepted.
+  using MeshGroup<Interleave>::Load;
+  using MeshGroup<Interleave>::Update;
+
+  template <class V>
+  bool Load(const V* vertices, const GLuint* indices)
+  {
+    TypedMeshGroup<L>::CheckVertexType<V>();
+    return MeshGroup<Interleave>::LoadPacked(vertices, indices);
+  }
+
+  template <class V>
+  bool Update(const V* vertices)
+  {
+    TypedMeshGroup<L>::CheckVertexType<V>();
+    return MeshGroup<Interleave>::UpdatePacked(vertices);
+  }
+
+private:
+  template <class V>
+  static void CheckVertexType()
+  {
+    static_assert(std::is_standard_layout<V>::value && std::is_trivially_copyable<V>::value,
+                  "Vertex type must be a plain struct.");
+    static_assert(sizeof(V) == L::kStride, "Vertex type size doesn't match the layout stride.");
+  }
+
+  // The attribute list is fixed by the layout.
+  using MeshGroup<Interleave>::SetVertexAttribList;
+};
+
+}  // namespace gloo.
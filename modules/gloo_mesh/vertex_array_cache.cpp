@@ -0,0 +1,78 @@
+#include "vertex_array_cache.h"
+#include "gloo/gl_capabilities.h"
+
+#include <cassert>
+
+namespace gloo
+{
+
+std::map<VertexArrayCache::FormatKey, VertexArrayCache::Entry> VertexArrayCache::sVaos;
+std::map<GLuint, VertexArrayCache::FormatKey> VertexArrayCache::sKeys;
+
+bool VertexArrayCache::IsSupported()
+{
+#if defined(GL_VERTEX_ATTRIB_BINDING)
+  return IsGLVersionSupported(4, 3) || IsGLExtensionSupported("GL_ARB_vertex_attrib_binding");
+#else
+  return false;
+#endif
+}
+
+GLuint VertexArrayCache::Acquire(const std::vector<SharedVertexAttrib> & attribs)
+{
+  FormatKey key;
+  for (const SharedVertexAttrib & attrib : attribs)
+  {
+    key.push_back(attrib.mLocation);
+    key.push_back(attrib.mBinding);
+    key.push_back(attrib.mRelativeOffset);
+    key.push_back(attrib.mAttrib.mSize);
+    key.push_back(attrib.mAttrib.mFormat);
+  }
+
+  auto it = sVaos.find(key);
+  if (it != sVaos.end())
+  {
+    it->second.mNumRefs++;
+    return it->second.mVao;
+  }
+
+  GLuint vao = 0;
+#if defined(GL_VERTEX_ATTRIB_BINDING)
+  glGenVertexArrays(1, &vao);
+  glBindVertexArray(vao);
+
+  for (const SharedVertexAttrib & attrib : attribs)
+  {
+    assert(attrib.mLocation >= 0);
+
+    glVertexAttribFormat(attrib.mLocation, GetAttribComponents(attrib.mAttrib),
+                         GetAttribType(attrib.mAttrib.mFormat),
+                         IsAttribNormalized(attrib.mAttrib.mFormat), attrib.mRelativeOffset);
+    glVertexAttribBinding(attrib.mLocation, attrib.mBinding);
+    glEnableVertexAttribArray(attrib.mLocation);
+  }
+#endif
+
+  sVaos[key] = { vao, 1 };
+  sKeys[vao] = key;
+
+  return vao;
+}
+
+void VertexArrayCache::Release(GLuint vao)
+{
+  auto keyIt = sKeys.find(vao);
+  if (keyIt == sKeys.end())
+    return;
+
+  auto it = sVaos.find(keyIt->second);
+  if (--it->second.mNumRefs > 0)
+    return;
+
+  glDeleteVertexArrays(1, &vao);
+  sVaos.erase(it);
+  sKeys.erase(keyIt);
+}
+
+}  // namespace gloo.
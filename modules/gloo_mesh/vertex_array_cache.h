@@ -0,0 +1,85 @@
+// + ======================================== +
+// |         gl-oo-interface library          |
+// |            Module: GLOO Mesh.            |
+// |        Author: Rodrigo Castiel, 2016.    |
+// + ======================================== +
+//
+// VertexArrayCache shares VAOs between MeshGroups with the same vertex format.
+//
+// With glVertexAttribPointer(), a VAO holds the buffer its attributes read from, so every group
+// needs a VAO of its own per rendering pass (thousands of meshes, thousands of VAOs). With
+// separate attribute format and binding (OpenGL 4.3 or GL_ARB_vertex_attrib_binding), the VAO
+// only holds the format: for each enabled attribute, its location, type, the binding point it
+// reads from and its offset within that binding (glVertexAttribFormat()/glVertexAttribBinding()).
+// Buffers are attached to the binding points at draw time with glBindVertexBuffer().
+//
+// MeshGroup::AddRenderingPass() then acquires the VAO of its (vertex format, pass) pair here,
+// so consecutive draws of groups with the same format bind the same VAO and only swap vertex
+// buffers. VAOs are reference counted and deleted with their last group.
+//
+// The cache is not synchronized: like any OpenGL call, use it from the GL thread.
+//
+// [USAGE]
+/*
+    if (VertexArrayCache::IsSupported())
+    {
+      GLuint vao = VertexArrayCache::Acquire({{posLoc, 0, 0, {3}}, {normalLoc, 0, 12, {3}}});
+      ...
+      glBindVertexArray(vao);
+      glBindVertexBuffer(0, vbo, 0, 24);
+      ...
+      VertexArrayCache::Release(vao);
+    }
+*/
+
+#pragma once
+
+#include "gloo/gl_header.h"
+#include "vertex_format.h"
+
+#include <map>
+#include <vector>
+
+namespace gloo
+{
+
+// An enabled attribute of a shared VAO.
+struct SharedVertexAttrib
+{
+  GLint mLocation;         // Shader location.
+  GLuint mBinding;         // Vertex buffer binding point.
+  GLuint mRelativeOffset;  // Offset (in bytes) of the attribute within its binding.
+  VertexAttrib mAttrib;    // Size and storage format.
+};
+
+class VertexArrayCache
+{
+public:
+  // Returns true if the current context supports separate attribute format and binding.
+  static bool IsSupported();
+
+  // Returns the VAO with the vertex format 'attribs' (created on first use) and adds a
+  // reference to it. Attributes that aren't listed are disabled.
+  static GLuint Acquire(const std::vector<SharedVertexAttrib> & attribs);
+
+  // Drops a reference to 'vao' (deleted with the last one). Unknown VAOs are ignored.
+  static void Release(GLuint vao);
+
+  // Number of distinct VAOs alive.
+  static GLuint GetNumVaos() { return sVaos.size(); }
+
+private:
+  // Flattened attribute list (location, binding, offset, size and format of each attribute).
+  typedef std::vector<GLint> FormatKey;
+
+  struct Entry
+  {
+    GLuint mVao;
+    GLuint mNumRefs;
+  };
+
+  static std::map<FormatKey, Entry> sVaos;
+  static std::map<GLuint, FormatKey> sKeys;  // VAO -> its format.
+};
+
+}  // namespace gloo.
@@ -0,0 +1,317 @@
+#include "vertex_format.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+namespace gloo
+{
+
+GLenum GetAttribType(AttribFormat format)
+{
+  switch (format)
+  {
+    case kHalfFloat16:     return GL_HALF_FLOAT;
+    case kSnorm2_10_10_10: return GL_INT_2_10_10_10_REV;
+    case kUnorm16:         return GL_UNSIGNED_SHORT;
+    case kSnorm16:         return GL_SHORT;
+    case kUnorm8:
+    case kUint8:           return GL_UNSIGNED_BYTE;
+    default:               return GL_FLOAT;
+  }
+}
+
+GLboolean IsAttribNormalized(AttribFormat format)
+{
+  return (format == kFloat32 || format == kHalfFloat16 || format == kUint8) ? GL_FALSE : GL_TRUE;
+}
+
+GLint GetAttribComponents(const VertexAttrib & attrib)
+{
+  // Packed formats always hold 4 components.
+  return (attrib.mFormat == kSnorm2_10_10_10) ? 4 : attrib.mSize;
+}
+
+GLuint GetAttribBytes(const VertexAttrib & attrib)
+{
+  GLuint bytes = 0;
+  switch (attrib.mFormat)
+  {
+    case kHalfFloat16:
+    case kUnorm16:
+    case kSnorm16:         bytes = 2 * attrib.mSize; break;
+    case kSnorm2_10_10_10: bytes = 4;                break;
+    case kUnorm8:
+    case kUint8:           bytes = attrib.mSize;     break;
+    default:               bytes = 4 * attrib.mSize; break;
+  }
+
+  // Keep every attribute aligned to 4 bytes.
+  return (bytes + 3) & ~3u;
+}
+
+GLushort FloatToHalf(GLfloat value)
+{
+  GLuint bits = 0;
+  memcpy(&bits, &value, sizeof(GLfloat));
+
+  const GLuint sign     = (bits >> 16) & 0x8000;
+  const GLint  exponent = static_cast<GLint>((bits >> 23) & 0xff) - 127 + 15;
+  GLuint mantissa       = bits & 0x7fffff;
+
+  if (((bits >> 23) & 0xff) == 0xff)  // Inf or NaN.
+  {
+    return sign | 0x7c00 | (mantissa ? 0x200 : 0);
+  }
+  if (exponent >= 31)  // Overflow: infinity.
+  {
+    return sign | 0x7c00;
+  }
+  if (exponent <= 0)  // Denormal (or zero).
+  {
+    if (exponent < -10)
+      return sign;
+
+    mantissa |= 0x800000;
+    const GLuint shift = 14 - exponent;
+    GLuint half = mantissa >> shift;
+
+    // Round to nearest, ties to even.
+    const GLuint remainder = mantissa & ((1u << shift) - 1);
+    const GLuint halfway   = 1u << (shift - 1);
+    if (remainder > halfway || (remainder == halfway && (half & 1)))
+      half++;
+
+    return sign | half;
+  }
+
+  GLuint half = (exponent << 10) | (mantissa >> 13);
+
+  // Round to nearest, ties to even (a carry into the exponent is still correct).
+  const GLuint remainder = mantissa & 0x1fff;
+  if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+    half++;
+
+  return sign | half;
+}
+
+GLfloat HalfToFloat(GLushort half)
+{
+  const GLuint sign     = static_cast<GLuint>(half & 0x8000) << 16;
+  GLint exponent        = (half >> 10) & 0x1f;
+  GLuint mantissa       = half & 0x3ff;
+
+  GLuint bits = 0;
+  if (exponent == 31)  // Inf or NaN.
+  {
+    bits = sign | 0x7f800000 | (mantissa << 13);
+  }
+  else if (exponent == 0)  // Denormal (or zero): normalize it.
+  {
+    if (mantissa != 0)
+    {
+      exponent = 1;
+      while (!(mantissa & 0x400))
+      {
+        mantissa <<= 1;
+        exponent--;
+      }
+
+      bits = sign | ((exponent - 15 + 127) << 23) | ((mantissa & 0x3ff) << 13);
+    }
+    else
+    {
+      bits = sign;
+    }
+  }
+  else
+  {
+    bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+  }
+
+  GLfloat value = 0.0f;
+  memcpy(&value, &bits, sizeof(GLfloat));
+  return value;
+}
+
+GLuint PackSnorm2_10_10_10(GLfloat x, GLfloat y, GLfloat z, GLfloat w)
+{
+  const GLint ix = static_cast<GLint>(std::round(std::max(-1.0f, std::min(1.0f, x)) * 511.0f));
+  const GLint iy = static_cast<GLint>(std::round(std::max(-1.0f, std::min(1.0f, y)) * 511.0f));
+  const GLint iz = static_cast<GLint>(std::round(std::max(-1.0f, std::min(1.0f, z)) * 511.0f));
+  const GLint iw = static_cast<GLint>(std::round(std::max(-1.0f, std::min(1.0f, w))));
+
+  return (static_cast<GLuint>(ix) & 0x3ff)
+       | ((static_cast<GLuint>(iy) & 0x3ff) << 10)
+       | ((static_cast<GLuint>(iz) & 0x3ff) << 20)
+       | ((static_cast<GLuint>(iw) & 0x3)   << 30);
+}
+
+void UnpackSnorm2_10_10_10(GLuint packed, GLfloat* xyzw)
+{
+  // Sign-extend each field, then map [-511, 511] to [-1, 1] (-512 clamps to -1).
+  const GLint fields[4] = { static_cast<GLint>(packed << 22) >> 22,
+                            static_cast<GLint>(packed << 12) >> 22,
+                            static_cast<GLint>(packed << 2)  >> 22,
+                            static_cast<GLint>(packed)       >> 30 };
+
+  for (GLuint k = 0; k < 3; k++)
+    xyzw[k] = std::max(-1.0f, fields[k] / 511.0f);
+  xyzw[3] = std::max(-1.0f, static_cast<GLfloat>(fields[3]));
+}
+
+void PackAttrib(const VertexAttrib & attrib, const GLfloat* src, GLuint srcStride, GLuint count,
+                GLubyte* dst, GLuint dstStride)
+{
+  const GLuint size = attrib.mSize;
+
+  switch (attrib.mFormat)
+  {
+    case kFloat32:
+      if (srcStride == size && dstStride == size * sizeof(GLfloat))  // Tightly packed: copy.
+      {
+        memcpy(dst, src, count * size * sizeof(GLfloat));
+      }
+      else
+      {
+        for (GLuint i = 0; i < count; i++)
+          memcpy(dst + dstStride*i, src + srcStride*i, size * sizeof(GLfloat));
+      }
+      break;
+
+    case kHalfFloat16:
+      for (GLuint i = 0; i < count; i++)
+      {
+        GLushort* out = reinterpret_cast<GLushort*>(dst + dstStride*i);
+        for (GLuint k = 0; k < size; k++)
+          out[k] = FloatToHalf(src[srcStride*i + k]);
+      }
+      break;
+
+    case kSnorm2_10_10_10:
+      for (GLuint i = 0; i < count; i++)
+      {
+        const GLfloat* in = src + srcStride*i;
+        const GLuint packed = PackSnorm2_10_10_10(size > 0 ? in[0] : 0.0f, size > 1 ? in[1] : 0.0f,
+                                                  size > 2 ? in[2] : 0.0f, size > 3 ? in[3] : 0.0f);
+        memcpy(dst + dstStride*i, &packed, sizeof(GLuint));
+      }
+      break;
+
+    case kUnorm16:
+      for (GLuint i = 0; i < count; i++)
+      {
+        GLushort* out = reinterpret_cast<GLushort*>(dst + dstStride*i);
+        for (GLuint k = 0; k < size; k++)
+        {
+          const GLfloat v = std::max(0.0f, std::min(1.0f, src[srcStride*i + k]));
+          out[k] = static_cast<GLushort>(v * 65535.0f + 0.5f);
+        }
+      }
+      break;
+
+    case kSnorm16:
+      for (GLuint i = 0; i < count; i++)
+      {
+        GLshort* out = reinterpret_cast<GLshort*>(dst + dstStride*i);
+        for (GLuint k = 0; k < size; k++)
+        {
+          const GLfloat v = std::max(-1.0f, std::min(1.0f, src[srcStride*i + k]));
+          out[k] = static_cast<GLshort>(std::round(v * 32767.0f));
+        }
+      }
+      break;
+
+    case kUnorm8:
+      for (GLuint i = 0; i < count; i++)
+      {
+        GLubyte* out = dst + dstStride*i;
+        for (GLuint k = 0; k < size; k++)
+        {
+          const GLfloat v = std::max(0.0f, std::min(1.0f, src[srcStride*i + k]));
+          out[k] = static_cast<GLubyte>(v * 255.0f + 0.5f);
+        }
+      }
+      break;
+
+    case kUint8:
+      for (GLuint i = 0; i < count; i++)
+      {
+        GLubyte* out = dst + dstStride*i;
+        for (GLuint k = 0; k < size; k++)
+        {
+          const GLfloat v = std::max(0.0f, std::min(255.0f, src[srcStride*i + k]));
+          out[k] = static_cast<GLubyte>(v + 0.5f);
+        }
+      }
+      break;
+  }
+}
+
+void UnpackAttrib(const VertexAttrib & attrib, const GLubyte* src, GLuint srcStride, GLuint count,
+                  GLfloat* dst, GLuint dstStride)
+{
+  const GLuint size = attrib.mSize;
+
+  for (GLuint i = 0; i < count; i++)
+  {
+    const GLubyte* in = src + srcStride*i;
+    GLfloat* out = dst + dstStride*i;
+
+    switch (attrib.mFormat)
+    {
+      case kFloat32:
+        memcpy(out, in, size * sizeof(GLfloat));
+        break;
+
+      case kHalfFloat16:
+        for (GLuint k = 0; k < size; k++)
+        {
+          GLushort half = 0;
+          memcpy(&half, in + 2*k, sizeof(GLushort));
+          out[k] = HalfToFloat(half);
+        }
+        break;
+
+      case kSnorm2_10_10_10:
+      {
+        GLuint packed = 0;
+        GLfloat xyzw[4];
+        memcpy(&packed, in, sizeof(GLuint));
+        UnpackSnorm2_10_10_10(packed, xyzw);
+        std::copy(xyzw, xyzw + std::min(size, 4u), out);
+        break;
+      }
+
+      case kUnorm16:
+        for (GLuint k = 0; k < size; k++)
+        {
+          GLushort v = 0;
+          memcpy(&v, in + 2*k, sizeof(GLushort));
+          out[k] = v / 65535.0f;
+        }
+        break;
+
+      case kSnorm16:
+        for (GLuint k = 0; k < size; k++)
+        {
+          GLshort v = 0;
+          memcpy(&v, in + 2*k, sizeof(GLshort));
+          out[k] = std::max(-1.0f, v / 32767.0f);
+        }
+        break;
+
+      case kUnorm8:
+        for (GLuint k = 0; k < size; k++)
+          out[k] = in[k] / 255.0f;
+        break;
+
+      case kUint8:
+        for (GLuint k = 0; k < size; k++)
+          out[k] = static_cast<GLfloat>(in[k]);
+        break;
+    }
+  }
+}
+
+}  // namespace gloo.
@@ -0,0 +1,81 @@
+// + ======================================== +
+// |         gl-oo-interface library          |
+// |            Module: GLOO Mesh.            |
+// |        Author: Rodrigo Castiel, 2016.    |
+// + ======================================== +
+//
+// Vertex attribute formats.
+//
+// Geometry is always handed to MeshGroup as arrays of floats, but it doesn't have to be stored
+// as floats on the GPU. A VertexAttrib describes both the number of components of an attribute
+// (floats provided by the caller) and the format of each component in the vertex buffer.
+// The conversion (packing) happens on the CPU when the group is loaded or updated.
+//
+// Recommended formats:
+//  -> Positions:          kFloat32 or kHalfFloat16 (if the extent of the mesh is small).
+//  -> Normals, tangents:  kSnorm2_10_10_10 (3 or 4 components packed into 4 bytes).
+//  -> Texture coords:     kUnorm16 (must be in [0, 1]) or kHalfFloat16.
+//  -> Colors:             kUnorm8.
+//  -> Bone indices:       kUint8 (up to kMaxBones = 128 bones, see bone_palette.h).
+//  -> Bone weights:       kUnorm8.
+//
+// For example, {{3, kHalfFloat16}, {3, kSnorm2_10_10_10}, {2, kUnorm16}, {3, kSnorm2_10_10_10}}
+// stores position + normal + uv + tangent in 20 bytes instead of 44.
+// Every attribute is padded to a multiple of 4 bytes.
+
+#pragma once
+
+#include "gloo/gl_header.h"
+
+namespace gloo
+{
+
+// Storage format of the components of a vertex attribute.
+enum AttribFormat
+{
+  kFloat32,          // GL_FLOAT (default).
+  kHalfFloat16,      // GL_HALF_FLOAT.
+  kSnorm2_10_10_10,  // GL_INT_2_10_10_10_REV, normalized. 3 or 4 components (w is -1, 0 or 1).
+  kUnorm16,          // GL_UNSIGNED_SHORT, normalized ([0, 1]).
+  kSnorm16,          // GL_SHORT, normalized ([-1, 1]).
+  kUnorm8,           // GL_UNSIGNED_BYTE, normalized ([0, 1]).
+  kUint8,            // GL_UNSIGNED_BYTE, not normalized (integers in [0, 255], e.g. bone indices).
+};
+
+struct VertexAttrib
+{
+  // Implicit, so that a plain size (e.g. {3, 3, 2}) still describes float attributes.
+  VertexAttrib(GLuint size, AttribFormat format = kFloat32)
+  : mSize(size)
+  , mFormat(format)
+  { }
+
+  GLuint mSize;          // Number of components (floats provided per vertex).
+  AttribFormat mFormat;  // Storage format of the components.
+};
+
+// OpenGL type, normalization flag and component count passed to glVertexAttribPointer().
+GLenum GetAttribType(AttribFormat format);
+GLboolean IsAttribNormalized(AttribFormat format);
+GLint GetAttribComponents(const VertexAttrib & attrib);
+
+// Number of bytes an attribute takes in the vertex buffer (padded to 4 bytes).
+GLuint GetAttribBytes(const VertexAttrib & attrib);
+
+// Converts 'count' attributes from 'src' (floats, consecutive ones 'srcStride' floats apart) into
+// the storage format of 'attrib', written to 'dst' (consecutive ones 'dstStride' bytes apart).
+void PackAttrib(const VertexAttrib & attrib, const GLfloat* src, GLuint srcStride, GLuint count,
+                GLubyte* dst, GLuint dstStride);
+
+// Inverse of PackAttrib(): converts 'count' attributes stored in the format of 'attrib' back
+// into floats (attrib.mSize per attribute). Used to process geometry read back from the GPU.
+void UnpackAttrib(const VertexAttrib & attrib, const GLubyte* src, GLuint srcStride, GLuint count,
+                  GLfloat* dst, GLuint dstStride);
+
+// Scalar conversion kernels.
+GLushort FloatToHalf(GLfloat value);
+GLfloat HalfToFloat(GLushort half);
+GLuint PackSnorm2_10_10_10(GLfloat x, GLfloat y, GLfloat z, GLfloat w = 0.0f);
+void UnpackSnorm2_10_10_10(GLuint packed, GLfloat* xyzw);
+
+}  // namespace gloo.
@@ -0,0 +1,134 @@
+// + ======================================== +
+// |         gl-oo-interface library          |
+// |            Module: GLOO Mesh.            |
+// |        Author: Rodrigo Castiel, 2016.    |
+// + ======================================== +
+//
+// Compile-time vertex layouts.
+//
+// A Layout lists the attributes of an interleaved vertex as types (e.g. Layout<Pos3f, Nrm3f,
+// Uv2f>), so that its stride, attribute offsets and attribute count are constants known by
+// the compiler. TypedMeshGroup (typed_group.h) uses them to upload arrays of vertex structs
+// directly and to check attribute lists at compile time.
+//
+// Attribute types describe the stored vertex (see vertex_format.h): a vertex struct must hold
+// each attribute in its storage format, with every attribute padded to 4 bytes. For example:
+//
+//   typedef Layout<Pos3f, Nrm3s10, Uv2u16> CompactLayout;  // 20 bytes per vertex.
+//
+//   struct CompactVertex
+//   {
+//     GLfloat mPosition[3];
+//     GLuint mNormal;     // PackSnorm2_10_10_10(x, y, z).
+//     GLushort mUv[2];    // [0, 1] -> [0, 65535].
+//   };
+//
+//   static_assert(sizeof(CompactVertex) == CompactLayout::kStride, "Layout mismatch.");
+//   static_assert(offsetof(CompactVertex, mUv) == CompactLayout::Offset<2>(), "Layout mismatch.");
+
+#pragma once
+
+#include "gloo/gl_header.h"
+#include "vertex_format.h"
+
+#include <vector>
+
+namespace gloo
+{
+
+// Bytes taken by 'size' components stored in 'format', padded to 4 bytes (see GetAttribBytes()).
+constexpr GLuint GetAttribBytes(GLuint size, AttribFormat format)
+{
+  return (format == kSnorm2_10_10_10) ? 4 :
+         (format == kFloat32) ? 4 * size :
+         (format == kUnorm8 || format == kUint8) ? (size + 3) / 4 * 4 :
+                                (2 * size + 3) / 4 * 4;  // 16-bit formats.
+}
+
+// Vertex attribute type: 'Size' components stored in 'Format'.
+template <GLuint Size, AttribFormat Format = kFloat32>
+struct Attrib
+{
+  static constexpr GLuint kSize = Size;
+  static constexpr AttribFormat kFormat = Format;
+  static constexpr GLuint kBytes = GetAttribBytes(Size, Format);
+
+  static VertexAttrib GetVertexAttrib() { return VertexAttrib(Size, Format); }
+};
+
+template <GLuint Size, AttribFormat Format>
+constexpr GLuint Attrib<Size, Format>::kSize;
+
+template <GLuint Size, AttribFormat Format>
+constexpr AttribFormat Attrib<Size, Format>::kFormat;
+
+template <GLuint Size, AttribFormat Format>
+constexpr GLuint Attrib<Size, Format>::kBytes;
+
+// Common attributes.
+typedef Attrib<3> Pos3f;                     // Position.
+typedef Attrib<3, kHalfFloat16> Pos3h;
+typedef Attrib<3> Nrm3f;                     // Normal.
+typedef Attrib<3, kSnorm2_10_10_10> Nrm3s10;
+typedef Attrib<2> Uv2f;                      // Texture coordinates.
+typedef Attrib<2, kUnorm16> Uv2u16;
+typedef Attrib<3> Tan3f;                     // Tangent.
+typedef Attrib<4, kSnorm2_10_10_10> Tan4s10;  // Tangent and handedness (w).
+typedef Attrib<4> Col4f;                     // Color.
+typedef Attrib<4, kUnorm8> Col4u8;
+typedef Attrib<4, kUint8> Bones4u8;          // Bone indices (skinning).
+typedef Attrib<4, kUnorm8> Weights4u8;       // Bone weights (skinning).
+
+namespace internal
+{
+  // Sum of the sizes (in bytes) of the first 'N' attributes.
+  template <GLuint N, class... A>
+  struct AttribBytesSum;
+
+  template <GLuint N>
+  struct AttribBytesSum<N>
+  {
+    static constexpr GLuint kValue = 0;
+  };
+
+  template <class First, class... Rest>
+  struct AttribBytesSum<0, First, Rest...>
+  {
+    static constexpr GLuint kValue = 0;
+  };
+
+  template <GLuint N, class First, class... Rest>
+  struct AttribBytesSum<N, First, Rest...>
+  {
+    static constexpr GLuint kValue = First::kBytes + AttribBytesSum<N-1, Rest...>::kValue;
+  };
+}  // namespace internal.
+
+// Interleaved vertex layout: (A0 B0 C0) (A1 B1 C1) ...
+template <class... A>
+struct Layout
+{
+  static_assert(sizeof...(A) > 0, "A vertex layout needs at least one attribute.");
+
+  static constexpr GLuint kNumAttribs = sizeof...(A);
+  static constexpr GLuint kStride = internal::AttribBytesSum<sizeof...(A), A...>::kValue;
+
+  // Offset (in bytes) of attribute 'I' within a vertex.
+  template <GLuint I>
+  static constexpr GLuint Offset()
+  {
+    static_assert(I < sizeof...(A), "Attribute index out of range.");
+    return internal::AttribBytesSum<I, A...>::kValue;
+  }
+
+  // Runtime attribute list (see MeshGroup::SetVertexAttribList()).
+  static std::vector<VertexAttrib> GetAttribList() { return { A::GetVertexAttrib()... }; }
+};
+
+template <class... A>
+constexpr GLuint Layout<A...>::kNumAttribs;
+
+template <class... A>
+constexpr GLuint Layout<A...>::kStride;
+
+}  // namespace gloo.
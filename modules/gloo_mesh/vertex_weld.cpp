@@ -0,0 +1,199 @@
+#include "vertex_weld.h"
+
+#include <cmath>
+#include <thread>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+namespace gloo
+{
+
+namespace
+{
+  const GLuint kNoVertex = ~0u;
+
+  // Hashes and compares vertices (positions snapped to the epsilon grid, if any).
+  class VertexComparer
+  {
+  public:
+    VertexComparer(const std::vector<WeldStream> & streams, GLuint positionStream, GLfloat epsilon)
+    : mStreams(streams)
+    , mPositionStream(positionStream)
+    , mInvEpsilon(epsilon > 0.0f ? 1.0 / epsilon : 0.0)
+    { }
+
+    uint64_t Hash(GLuint v) const
+    {
+      uint64_t h = 14695981039346656037ull;  // FNV-1a over 64-bit words.
+      for (GLuint j = 0; j < mStreams.size(); j++)
+      {
+        const GLfloat* x = mStreams[j].mData + size_t(mStreams[j].mStride) * v;
+        for (GLuint k = 0; k < mStreams[j].mSize; k++)
+        {
+          const uint64_t word = IsSnapped(j) ? uint64_t(Cell(x[k])) : FloatBits(x[k]);
+          h = (h ^ word) * 1099511628211ull;
+        }
+      }
+
+      // Final mix: the low bits index hash tables and the high bits select shards.
+      h ^= h >> 33;
+      h *= 0xff51afd7ed558ccdull;
+      h ^= h >> 33;
+      return h;
+    }
+
+    bool Equal(GLuint a, GLuint b) const
+    {
+      for (GLuint j = 0; j < mStreams.size(); j++)
+      {
+        const GLfloat* x = mStreams[j].mData + size_t(mStreams[j].mStride) * a;
+        const GLfloat* y = mStreams[j].mData + size_t(mStreams[j].mStride) * b;
+        for (GLuint k = 0; k < mStreams[j].mSize; k++)
+        {
+          if (IsSnapped(j) ? Cell(x[k]) != Cell(y[k]) : x[k] != y[k])
+            return false;
+        }
+      }
+
+      return true;
+    }
+
+  private:
+    bool IsSnapped(GLuint j) const { return j == mPositionStream && mInvEpsilon > 0.0; }
+    int64_t Cell(GLfloat x) const { return int64_t(std::floor(x * mInvEpsilon + 0.5)); }
+
+    // Bits of 'x', with -0 and +0 hashed alike (they compare equal).
+    static uint64_t FloatBits(GLfloat x)
+    {
+      x += 0.0f;
+      uint32_t bits = 0;
+      memcpy(&bits, &x, sizeof(bits));
+      return bits;
+    }
+
+    const std::vector<WeldStream> & mStreams;
+    const GLuint mPositionStream;
+    const double mInvEpsilon;
+  };
+
+  // Sets rep[v] to the first vertex of 'vertices' (in increasing order) equal to v.
+  void WeldShard(const VertexComparer & comparer, const std::vector<uint64_t> & hashes,
+                 const GLuint* vertices, GLuint count, GLuint* rep)
+  {
+    // Open addressing (linear probing), at most half full.
+    GLuint tableSize = 1;
+    while (tableSize < 2 * count)
+      tableSize <<= 1;
+
+    const GLuint mask = tableSize - 1;
+    std::vector<GLuint> table(tableSize, kNoVertex);
+
+    for (GLuint i = 0; i < count; i++)
+    {
+      const GLuint v = vertices[i];
+      GLuint slot = hashes[v] & mask;
+
+      while (table[slot] != kNoVertex)
+      {
+        const GLuint u = table[slot];
+        if (hashes[u] == hashes[v] && comparer.Equal(u, v))
+          break;
+
+        slot = (slot + 1) & mask;
+      }
+
+      if (table[slot] == kNoVertex)
+        table[slot] = v;
+
+      rep[v] = table[slot];
+    }
+  }
+
+  // Runs 'kernel(i)' for i in [0, numThreads), on separate threads.
+  template <class Kernel>
+  void RunThreads(GLuint numThreads, const Kernel & kernel)
+  {
+    std::vector<std::thread> threads;
+    for (GLuint i = 1; i < numThreads; i++)
+      threads.emplace_back(kernel, i);
+
+    kernel(0);
+    for (std::thread & thread : threads)
+      thread.join();
+  }
+}  // namespace.
+
+GLuint WeldVertices(const std::vector<WeldStream> & streams, GLuint numVertices,
+                    GLuint positionStream, GLfloat epsilon, std::vector<GLuint> & remap)
+{
+  assert(epsilon >= 0.0f);
+
+  const GLuint maxThreads = std::max(1u, std::thread::hardware_concurrency());
+  const GLuint numThreads = std::max(1u, std::min(maxThreads,
+                                                  numVertices / kParallelWeldVertices));
+
+  const VertexComparer comparer(streams, positionStream, epsilon);
+
+  // Hash every vertex (one range per thread).
+  std::vector<uint64_t> hashes(numVertices);
+  const GLuint rangeSize = (numVertices + numThreads - 1) / numThreads;
+  RunThreads(numThreads, [&](GLuint t)
+  {
+    const GLuint last = std::min(numVertices, (t + 1) * rangeSize);
+    for (GLuint v = t * rangeSize; v < last; v++)
+      hashes[v] = comparer.Hash(v);
+  });
+
+  // Equal vertices have equal hashes, so they fall into the same shard (one per thread).
+  // Vertices are sorted by shard, keeping their order within each shard.
+  std::vector<GLuint> shardBegin(numThreads + 1, 0);
+  for (GLuint v = 0; v < numVertices; v++)
+    shardBegin[(hashes[v] >> 32) % numThreads + 1]++;
+
+  for (GLuint s = 0; s < numThreads; s++)
+    shardBegin[s + 1] += shardBegin[s];
+
+  std::vector<GLuint> order(numVertices);
+  std::vector<GLuint> next(shardBegin.begin(), shardBegin.end() - 1);
+  for (GLuint v = 0; v < numVertices; v++)
+    order[next[(hashes[v] >> 32) % numThreads]++] = v;
+
+  std::vector<GLuint> rep(numVertices);
+  RunThreads(numThreads, [&](GLuint s)
+  {
+    WeldShard(comparer, hashes, &order[shardBegin[s]], shardBegin[s + 1] - shardBegin[s],
+              rep.data());
+  });
+
+  // Number unique vertices by first occurrence (rep[v] <= v is already numbered).
+  remap.resize(numVertices);
+  GLuint numUnique = 0;
+  for (GLuint v = 0; v < numVertices; v++)
+  {
+    remap[v] = (rep[v] == v) ? numUnique++ : remap[rep[v]];
+  }
+
+  return numUnique;
+}
+
+void CompactVertices(const WeldStream & stream, GLuint numVertices,
+                     const std::vector<GLuint> & remap, GLfloat* dst)
+{
+  assert(remap.size() == numVertices);
+
+  // Unique vertices are numbered by first occurrence.
+  GLuint numWritten = 0;
+  for (GLuint v = 0; v < numVertices; v++)
+  {
+    if (remap[v] == numWritten)
+    {
+      memcpy(dst + size_t(stream.mSize) * numWritten, stream.mData + size_t(stream.mStride) * v,
+             stream.mSize * sizeof(GLfloat));
+      numWritten++;
+    }
+  }
+}
+
+}  // namespace gloo.
@@ -0,0 +1,50 @@
+// + ======================================== +
+// |         gl-oo-interface library          |
+// |            Module: GLOO Mesh.            |
+// |        Author: Rodrigo Castiel, 2016.    |
+// + ======================================== +
+//
+// Vertex welding: merges duplicate vertices of unindexed (or poorly indexed) geometry.
+//
+// Triangle soups (STL files, scans, exports with per-face normals) repeat every shared vertex
+// once per triangle. WeldVertices() hashes the vertices and finds the unique ones: two vertices
+// are the same if all their attributes are equal. Positions can be compared on a grid of
+// 'epsilon' cells instead: positions that round to the same cell are merged, so vertices closer
+// than 'epsilon' usually are (two close vertices on different sides of a cell boundary aren't).
+//
+// The result is a remap table (vertex -> unique vertex, numbered by first occurrence), which is
+// also the index buffer of the welded geometry, and CompactVertices() copies the first
+// occurrence of each unique vertex. Large inputs (at least kParallelWeldVertices vertices per
+// thread) are hashed and welded across threads; the result doesn't depend on the thread count.
+//
+// MeshGroup::EnableVertexWelding() runs it on the input of Load() (see group.h).
+
+#pragma once
+
+#include "gloo/gl_header.h"
+
+#include <vector>
+
+namespace gloo
+{
+
+const GLuint kParallelWeldVertices = 1 << 16;  // Minimum vertices per thread.
+
+// An attribute array: 'mSize' floats per vertex, consecutive vertices 'mStride' floats apart.
+struct WeldStream
+{
+  const GLfloat* mData;
+  GLuint mSize;
+  GLuint mStride;
+};
+
+// Fills remap[v] with the unique vertex of v and returns the number of unique vertices.
+// Stream 'positionStream' is compared on a grid of 'epsilon' cells (exactly if epsilon is 0).
+GLuint WeldVertices(const std::vector<WeldStream> & streams, GLuint numVertices,
+                    GLuint positionStream, GLfloat epsilon, std::vector<GLuint> & remap);
+
+// Writes the first occurrence of every unique vertex of 'stream' at dst[mSize * remap[v]].
+void CompactVertices(const WeldStream & stream, GLuint numVertices,
+                     const std::vector<GLuint> & remap, GLfloat* dst);
+
+}  // namespace gloo.
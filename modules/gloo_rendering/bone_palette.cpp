@@ -0,0 +1,57 @@
+#include "bone_palette.h"
+
+#include "gloo/gpu_memory.h"
+
+#include <vector>
+#include <cassert>
+
+namespace gloo
+{
+
+BonePalette::BonePalette()
+{
+  glGenBuffers(1, &mBuffer);
+}
+
+BonePalette::~BonePalette()
+{
+  GpuMemory::ReleaseBuffer(mBuffer);
+  glDeleteBuffers(1, &mBuffer);
+}
+
+void BonePalette::Update(const glm::mat4* matrices, GLuint numBones)
+{
+  assert(numBones <= kMaxBones);
+
+  // Orphan the storage the GPU may still be reading (the previous frame) and fill the new one.
+  const GLsizeiptr size = kMaxBones * sizeof(glm::mat4);
+  glBindBuffer(GL_UNIFORM_BUFFER, mBuffer);
+  glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_STREAM_DRAW);
+  glBufferSubData(GL_UNIFORM_BUFFER, 0, numBones * sizeof(glm::mat4), matrices);
+  GpuMemory::TrackBuffer(mBuffer, size, kGpuUniformBuffer, "BonePalette");
+
+  mNumBones = numBones;
+  BonePalette::Bind();
+}
+
+void BonePalette::Bind() const
+{
+  glBindBufferBase(GL_UNIFORM_BUFFER, kBonePaletteBinding, mBuffer);
+}
+
+void BonePalette::ComputeSkinningMatrices(const GLint* parents, const glm::mat4* localPoses,
+                                          const glm::mat4* inverseBindPoses, GLuint numBones,
+                                          glm::mat4* matrices)
+{
+  // Parents come first, so their global poses are ready.
+  std::vector<glm::mat4> globalPoses(numBones);
+  for (GLuint b = 0; b < numBones; b++)
+  {
+    assert(parents[b] < static_cast<GLint>(b));
+
+    globalPoses[b] = (parents[b] < 0) ? localPoses[b] : globalPoses[parents[b]] * localPoses[b];
+    matrices[b] = globalPoses[b] * inverseBindPoses[b];
+  }
+}
+
+}  // namespace gloo.
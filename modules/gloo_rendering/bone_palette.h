@@ -0,0 +1,88 @@
+// + ======================================== +
+// |         gl-oo-interface library          |
+// |         Module: GLOO Rendering.          |
+// |        Author: Rodrigo Castiel, 2016.    |
+// + ======================================== +
+//
+// BonePalette holds the skinning matrices of an animated mesh in a uniform buffer, read by the
+// skinning shaders (shaders/skinned_phong and shaders/skinned_debug) to deform vertices on the
+// GPU (linear blend skinning), instead of updating every vertex on the CPU each frame.
+//
+// Skinned groups have two more attributes, whose locations are given by the renderers
+// (GetBoneIndexAttribLoc() and GetBoneWeightAttribLoc()):
+//  -> Bone indices: {4, kUint8}, up to 4 bones per vertex (unused bones: index 0, weight 0).
+//  -> Bone weights: {4, kUnorm8}, adding up to 1.
+//
+// The skinning matrix of a bone takes a vertex from the bind pose (in which the mesh was
+// modeled) to the current pose: globalPose * inverseBindPose (see ComputeSkinningMatrices()).
+// Update() uploads them once per frame (orphaning the previous storage) and binds the palette
+// to kBonePaletteBinding, to which the renderers bind the BonePalette block of their shaders.
+// Normals are transformed by the upper 3x3 of the blended matrix: bones can rotate, translate
+// and scale uniformly.
+//
+//  ---------------------------------------------------------------------------
+//  USAGE
+//
+//  PhongRenderer* renderer = new PhongRenderer("../../shaders/skinned_phong/vertex_shader.glsl",
+//                                              "../../shaders/skinned_phong/fragment_shader.glsl");
+//  MeshGroup<Interleave>* group = new MeshGroup<Interleave>(numVertices, numElements, GL_TRIANGLES);
+//  group->SetVertexAttribList({3, 3, 2, {4, kUint8}, {4, kUnorm8}});
+//  group->AddRenderingPass({{renderer->GetPositionAttribLoc(), true}, ...,
+//                           {renderer->GetBoneIndexAttribLoc(), true},
+//                           {renderer->GetBoneWeightAttribLoc(), true}});
+//  BonePalette palette;
+//  Transform model;
+//  Camera* camera = new Camera();
+//  ...
+//  // Every frame.
+//  BonePalette::ComputeSkinningMatrices(parents, localPoses, inverseBindPoses, numBones, matrices);
+//  palette.Update(matrices, numBones);
+//  renderer->Render(group, model, camera, 0);  // Rendering pass 0.
+//  ---------------------------------------------------------------------------
+
+#pragma once
+
+#include "gloo/gl_header.h"
+#include "gloo/transform.h"
+
+namespace gloo
+{
+
+// Uniform buffer binding point of the BonePalette block.
+const GLuint kBonePaletteBinding = 0;
+
+// Size of the bone array of the skinning shaders (64 bytes per bone).
+const GLuint kMaxBones = 128;
+
+class BonePalette
+{
+public:
+  BonePalette();
+  ~BonePalette();
+
+  // The palette owns its uniform buffer.
+  BonePalette(const BonePalette &) = delete;
+  BonePalette & operator=(const BonePalette &) = delete;
+
+  // Uploads 'numBones' (at most kMaxBones) skinning matrices and binds the palette.
+  void Update(const glm::mat4* matrices, GLuint numBones);
+
+  // Binds the palette to kBonePaletteBinding (e.g. when switching between palettes).
+  void Bind() const;
+
+  // Skinning matrices of a hierarchy: bone b has pose 'localPoses[b]' relative to its parent
+  // 'parents[b]' (-1 for roots, otherwise less than b).
+  static void ComputeSkinningMatrices(const GLint* parents, const glm::mat4* localPoses,
+                                      const glm::mat4* inverseBindPoses, GLuint numBones,
+                                      glm::mat4* matrices);
+
+  // Getters.
+  GLuint GetNumBones() const { return mNumBones; }
+  GLuint GetBuffer() const { return mBuffer; }
+
+private:
+  GLuint mBuffer { 0 };    // Uniform buffer (kMaxBones matrices).
+  GLuint mNumBones { 0 };  // Bones in the last update.
+};
+
+}  // namespace gloo.
@@ -37,8 +37,13 @@ bool DebugRenderer::Load()
     // Get main attribute/uniform locations in advance.
     mPositionAttribLoc = mDebugShader->GetAttribLocation("v_position");
     mColorAttribLoc    = mDebugShader->GetAttribLocation("v_color");
+    mBoneIndexAttribLoc  = mDebugShader->GetAttribLocation("v_bones");
+    mBoneWeightAttribLoc = mDebugShader->GetAttribLocation("v_weights");
     mModelViewProjMatrixLoc = mDebugShader->GetUniformLocation("MVP");
 
+    // Skinning shaders: bone matrices (see bone_palette.h).
+    mDebugShader->SetUniformBlockBinding("BonePalette", kBonePaletteBinding);
+
     return true;
   }
   else
@@ -57,6 +62,14 @@ GLint DebugRenderer::GetAttribLocation(const std::string & name, int renderingPa
   {
     return mColorAttribLoc;
   }
+  else if (name == "bones" || name == "v_bones")
+  {
+    return mBoneIndexAttribLoc;
+  }
+  else if (name == "weights" || name == "v_weights")
+  {
+    return mBoneWeightAttribLoc;
+  }
   else  // There is no other attributes.
   {
     return -1;
@@ -45,11 +45,15 @@
 // 6. (optionally) For rendering mesh groups:
 //  mDebugRenderer->Render(meshGroup, modelTransformation, camera);
 //
+// Skinned meshes can be drawn with shaders/skinned_debug, which also read bone indices and
+// weights (GetBoneIndexAttribLoc()/GetBoneWeightAttribLoc()) and a BonePalette.
+//
 // ------------------------------------------------------------------------------------------------
 
 #pragma once
 
 #include "renderer.h"
+#include "bone_palette.h"
 #include "gloo/group.h"
 #include "gloo/camera.h"
 
@@ -80,8 +84,10 @@ public:
   virtual void Bind(int renderingPass = 0);
 
   // Renders a specific object through a point of view.
+  // 'lod' keeps the level of detail of the object between frames (see Renderer::DrawMesh()).
   template <StorageFormat F>
-  void Render(const MeshGroup<F>* mesh, Transform & model, Camera* camera, int pass=0) const;
+  void Render(const MeshGroup<F>* mesh, Transform & model, Camera* camera, int pass=0,
+              GLuint* lod = nullptr) const;
 
   inline unsigned GetNumRenderingPasses() const { return 1; }
 
@@ -93,6 +99,8 @@ public:
   // Extra methods.
   GLint GetPositionAttribLoc() const { return mPositionAttribLoc; }
   GLint GetColorAttribLoc()    const { return mColorAttribLoc;    }
+  GLint GetBoneIndexAttribLoc()  const { return mBoneIndexAttribLoc;  }  // Skinning shaders.
+  GLint GetBoneWeightAttribLoc() const { return mBoneWeightAttribLoc; }
   GLint GetModelViewProjUniformLoc() const { return mModelViewProjMatrixLoc; }
 
 protected:
@@ -103,6 +111,8 @@ protected:
   // It works as fast access variables (without querying the GPU).
   GLint mPositionAttribLoc { -1 };
   GLint mColorAttribLoc    { -1 };
+  GLint mBoneIndexAttribLoc  { -1 };
+  GLint mBoneWeightAttribLoc { -1 };
   GLint mModelViewProjMatrixLoc { -1 };
 
   // Constant data (passed to constructor).
@@ -111,10 +121,11 @@ protected:
 };
 
 template <StorageFormat F>
-void DebugRenderer::Render(const MeshGroup<F>* mesh, Transform & model, Camera* camera, int pass) const
+void DebugRenderer::Render(const MeshGroup<F>* mesh, Transform & model, Camera* camera, int pass,
+                           GLuint* lod) const
 {
   camera->SetUniformModelViewProj(mModelViewProjMatrixLoc, model);  // Proj * View * Model.
-  mesh->Render(pass);
+  Renderer::DrawMesh(mesh, model, camera, pass, lod);
 }
 
 }  // namespace gloo.
@@ -0,0 +1,176 @@
+#include "draw_batch.h"
+
+#include "gloo/gl_capabilities.h"
+#include "gloo/gpu_memory.h"
+
+#include <cassert>
+#include <cstring>
+#include <numeric>
+#include <algorithm>
+
+namespace gloo
+{
+
+DrawBatch::DrawBatch()
+{
+  glGenBuffers(1, &mCommandBuffer);
+  glGenBuffers(1, &mDrawDataBuffer);
+  glGenBuffers(1, &mMaterialBuffer);
+}
+
+DrawBatch::~DrawBatch()
+{
+  GpuMemory::ReleaseBuffer(mCommandBuffer);
+  GpuMemory::ReleaseBuffer(mDrawDataBuffer);
+  GpuMemory::ReleaseBuffer(mMaterialBuffer);
+
+  glDeleteBuffers(1, &mCommandBuffer);
+  glDeleteBuffers(1, &mDrawDataBuffer);
+  glDeleteBuffers(1, &mMaterialBuffer);
+}
+
+bool DrawBatch::IsSupported()
+{
+  return IsGLVersionSupported(4, 3) && IsGLExtensionSupported("GL_ARB_shader_draw_parameters");
+}
+
+void DrawBatch::Add(const MeshGroup<Interleave>* mesh, const Transform & model,
+                    const Material & material, unsigned renderingPass, GLuint* lod)
+{
+  assert(mesh->GetArena() && mesh->IsIndexed());
+
+  Draw draw;
+  draw.mMesh = mesh;
+  draw.mVao  = mesh->GetVao(renderingPass);
+  draw.mLod  = lod;
+  draw.mData.mModel  = model.GetMatrix();
+  draw.mData.mNormal = glm::transpose(model.GetInverseMatrix());
+  draw.mData.mMaterial = DrawBatch::FindMaterial(material);
+
+  mDraws.push_back(draw);
+}
+
+void DrawBatch::Clear()
+{
+  mDraws.clear();
+  mMaterials.clear();
+}
+
+void DrawBatch::Submit(const Camera* camera, GLint drawOffsetLoc)
+{
+  mNumSubmissions = 0;
+  if (mDraws.empty())
+    return;
+
+  // Group draws that can go in the same call (same VAO and draw mode), keeping their order.
+  std::vector<GLuint> order(mDraws.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [this](GLuint a, GLuint b) {
+    const Draw & da = mDraws[a];
+    const Draw & db = mDraws[b];
+    if (da.mVao != db.mVao)
+      return da.mVao < db.mVao;
+    return da.mMesh->GetDrawMode() < db.mMesh->GetDrawMode();
+  });
+
+  std::vector<DrawElementsIndirectCommand> commands(mDraws.size());
+  std::vector<DrawData> drawData(mDraws.size());
+
+  for (GLuint i = 0; i < order.size(); i++)
+  {
+    const Draw & draw = mDraws[order[i]];
+    const MeshGroup<Interleave>* mesh = draw.mMesh;
+
+    // Each draw keeps its own level, so that a mesh can be drawn at several distances.
+    GLuint lod = draw.mLod ? *draw.mLod : 0;
+    if (camera && mesh->GetNumLods() > 1)
+    {
+      const GLfloat* center = mesh->GetBoundingCenter();
+      const glm::vec3 point(center[0], center[1], center[2]);
+      lod = mesh->SelectLod(camera->ComputePixelsPerUnit(draw.mData.mModel, point), lod);
+    }
+
+    if (draw.mLod)
+      *draw.mLod = lod;
+
+    // Range of the level of detail inside the arena element array.
+    GLuint count = mesh->GetNumElements();
+    GLuint firstIndex = mesh->GetFirstIndex();
+    if (mesh->GetNumLods() > 1)
+    {
+      const LodLevel & level = mesh->GetLodLevels()[lod];
+      count = level.mNumIndices;
+      firstIndex += level.mFirstIndex;
+    }
+
+    commands[i] = { count, 1, firstIndex, static_cast<GLint>(mesh->GetBaseVertex()), 0 };
+    drawData[i] = draw.mData;
+  }
+
+  // Upload (orphaning the previous frame's data).
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, mCommandBuffer);
+  glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawElementsIndirectCommand),
+               commands.data(), GL_STREAM_DRAW);
+
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, mDrawDataBuffer);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, drawData.size() * sizeof(DrawData), drawData.data(),
+               GL_STREAM_DRAW);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kDrawDataBinding, mDrawDataBuffer);
+
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, mMaterialBuffer);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, mMaterials.size() * sizeof(MaterialData),
+               mMaterials.data(), GL_STREAM_DRAW);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kMaterialBinding, mMaterialBuffer);
+
+  GpuMemory::TrackBuffer(mCommandBuffer, commands.size() * sizeof(DrawElementsIndirectCommand),
+                         kGpuDrawBuffer, "DrawBatch commands");
+  GpuMemory::TrackBuffer(mDrawDataBuffer, drawData.size() * sizeof(DrawData), kGpuDrawBuffer,
+                         "DrawBatch draw data");
+  GpuMemory::TrackBuffer(mMaterialBuffer, mMaterials.size() * sizeof(MaterialData),
+                         kGpuDrawBuffer, "DrawBatch materials");
+
+  // One call per run of compatible draws.
+  GLuint first = 0;
+  while (first < order.size())
+  {
+    const Draw & draw = mDraws[order[first]];
+    const GLenum drawMode = draw.mMesh->GetDrawMode();
+
+    GLuint end = first + 1;
+    while (end < order.size() && mDraws[order[end]].mVao == draw.mVao
+           && mDraws[order[end]].mMesh->GetDrawMode() == drawMode)
+    {
+      end++;
+    }
+
+    glBindVertexArray(draw.mVao);
+    glUniform1i(drawOffsetLoc, first);
+    glMultiDrawElementsIndirect(drawMode, draw.mMesh->GetIndexType(),
+                                (void*)(GLintptr)(first * sizeof(DrawElementsIndirectCommand)),
+                                end - first, 0);
+
+    mNumSubmissions++;
+    first = end;
+  }
+}
+
+GLuint DrawBatch::FindMaterial(const Material & material)
+{
+  const MaterialData data = {
+    { material.mKa[0], material.mKa[1], material.mKa[2], 0.0f },
+    { material.mKd[0], material.mKd[1], material.mKd[2], 0.0f },
+    { material.mKs[0], material.mKs[1], material.mKs[2], 0.0f }
+  };
+
+  // Few distinct materials are expected, so a linear search is fine.
+  for (GLuint i = 0; i < mMaterials.size(); i++)
+  {
+    if (memcmp(&data, &mMaterials[i], sizeof(MaterialData)) == 0)
+      return i;
+  }
+
+  mMaterials.push_back(data);
+  return mMaterials.size()-1;
+}
+
+}  // namespace gloo.
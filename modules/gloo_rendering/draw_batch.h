@@ -0,0 +1,138 @@
+// + ======================================== +
+// |         gl-oo-interface library          |
+// |         Module: GLOO Rendering.          |
+// |        Author: Rodrigo Castiel, 2016.    |
+// + ======================================== +
+//
+// DrawBatch collects (mesh, transform, material) draws and submits them with multi-draw
+// indirect, instead of one PhongRenderer::Render() -> SetModelNormalMatrix() ->
+// MeshGroup::Render() sequence per object.
+//
+// Meshes must be stored in a MeshArena (see gloo_mesh/mesh_arena.h): draws of meshes that
+// share a VAO (same arena and rendering pass) and draw mode become the commands of a single
+// glMultiDrawElementsIndirect() call. Per-draw data (model and normal matrices, material
+// index) and the material table are uploaded into shader storage buffers, bound to
+// kDrawDataBinding and kMaterialBinding. The vertex shader fetches its draw with
+// gl_DrawIDARB + draw_offset (first draw of the current call), see shaders/phong_mdi.
+//
+// The levels of detail of the meshes are selected when the batch is submitted, per draw: the
+// level of each object is kept by the caller between frames (see Add()).
+// Requires OpenGL 4.3 and GL_ARB_shader_draw_parameters (see IsSupported()).
+//
+//  ---------------------------------------------------------------------------
+//  USAGE
+//
+//  PhongRenderer* renderer = new PhongRenderer("../../shaders/phong_mdi/vertex_shader.glsl",
+//                                              "../../shaders/phong_mdi/fragment_shader.glsl");
+//  DrawBatch batch;
+//  ...
+//  // On rendering.
+//  batch.Clear();
+//  for (const Object & object : objects)
+//    batch.Add(object.mMesh, object.mTransform, object.mMaterial, 0, &object.mLod);
+//
+//  renderer->Bind();
+//  renderer->SetCamera(camera);
+//  renderer->Render(batch, camera);
+//  ---------------------------------------------------------------------------
+
+#pragma once
+
+#include <vector>
+
+#include "gloo/gl_header.h"
+#include "gloo/group.h"
+#include "gloo/camera.h"
+#include "gloo/material.h"
+#include "gloo/transform.h"
+
+namespace gloo
+{
+
+// Shader storage buffer binding points used by DrawBatch.
+const GLuint kDrawDataBinding = 0;
+const GLuint kMaterialBinding = 1;
+
+// Command read by glMultiDrawElementsIndirect().
+struct DrawElementsIndirectCommand
+{
+  GLuint mCount;
+  GLuint mInstanceCount;
+  GLuint mFirstIndex;
+  GLint  mBaseVertex;
+  GLuint mBaseInstance;
+};
+
+// Per-draw data (std430 layout).
+struct DrawData
+{
+  glm::mat4 mModel;   // Model matrix.
+  glm::mat4 mNormal;  // Normal matrix (inverse transpose of the model matrix).
+  GLuint mMaterial;   // Index in the material table.
+  GLuint mPadding[3];
+};
+
+// Material table entry (std430 layout: vec3 is aligned as vec4).
+struct MaterialData
+{
+  GLfloat mKa[4];
+  GLfloat mKd[4];
+  GLfloat mKs[4];
+};
+
+class DrawBatch
+{
+public:
+  DrawBatch();
+  ~DrawBatch();
+
+  // The batch owns its buffers.
+  DrawBatch(const DrawBatch &) = delete;
+  DrawBatch & operator=(const DrawBatch &) = delete;
+
+  // Returns true if the current context can submit batches.
+  static bool IsSupported();
+
+  // Adds a draw of 'mesh' (indexed, stored in a MeshArena). 'lod' holds the level of detail
+  // the object was drawn with last and receives the one selected by Submit() (it must stay
+  // valid until then); nullptr: the finest level (or no hysteresis, if there is a camera).
+  void Add(const MeshGroup<Interleave>* mesh, const Transform & model, const Material & material,
+           unsigned renderingPass = 0, GLuint* lod = nullptr);
+
+  // Removes all draws (call it every frame before adding the visible objects).
+  void Clear();
+
+  // Selects levels of detail for 'camera' (if not nullptr), uploads commands and per-draw data
+  // and issues one glMultiDrawElementsIndirect() per VAO/draw mode. The bound program must
+  // read per-draw data as in shaders/phong_mdi; 'drawOffsetLoc' is its draw_offset uniform.
+  void Submit(const Camera* camera, GLint drawOffsetLoc);
+
+  // Getters.
+  GLuint GetNumDraws() const { return mDraws.size(); }
+  GLuint GetNumMaterials() const { return mMaterials.size(); }
+  GLuint GetNumSubmissions() const { return mNumSubmissions; }  // Calls in the last Submit().
+
+private:
+  struct Draw
+  {
+    const MeshGroup<Interleave>* mMesh;
+    GLuint mVao;
+    GLuint* mLod;  // Level of detail kept by the caller (may be nullptr).
+    DrawData mData;
+  };
+
+  // Index of 'material' in the material table (added if new).
+  GLuint FindMaterial(const Material & material);
+
+  std::vector<Draw> mDraws;
+  std::vector<MaterialData> mMaterials;
+
+  // Indirect command buffer and shader storage buffers.
+  GLuint mCommandBuffer  { 0 };
+  GLuint mDrawDataBuffer { 0 };
+  GLuint mMaterialBuffer { 0 };
+
+  GLuint mNumSubmissions { 0 };
+};
+
+}  // namespace gloo.
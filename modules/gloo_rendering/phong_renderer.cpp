@@ -33,17 +33,39 @@ bool PhongRenderer::Load()
     mNormalAttribLoc   = mPhongShader->GetAttribLocation("v_normal");
     mTextureAttribLoc  = mPhongShader->GetAttribLocation("v_uv");
     mTangentAttribLoc  = mPhongShader->GetAttribLocation("v_tangent");
+    mInstanceAttribLoc = mPhongShader->GetAttribLocation("i_model");
+    mBoneIndexAttribLoc  = mPhongShader->GetAttribLocation("v_bones");
+    mBoneWeightAttribLoc = mPhongShader->GetAttribLocation("v_weights");
+
+    // Skinning shaders: bone matrices (see bone_palette.h).
+    mPhongShader->SetUniformBlockBinding("BonePalette", kBonePaletteBinding);
+
+    // Morphing shaders: sparse morph target tables (see morph_targets.h).
+    PhongRenderer::SetTextureUnit("morph_ranges",  kMorphRangeUnit);
+    PhongRenderer::SetTextureUnit("morph_deltas",  kMorphDeltaUnit);
+    PhongRenderer::SetTextureUnit("morph_weights", kMorphWeightUnit);
 
     mProjMatrixLoc   = mPhongShader->GetUniformLocation("P");
     mViewMatrixLoc   = mPhongShader->GetUniformLocation("V");
     mModelMatrixLoc  = mPhongShader->GetUniformLocation("M");
     mNormalMatrixLoc = mPhongShader->GetUniformLocation("N");
+    mDrawOffsetLoc   = mPhongShader->GetUniformLocation("draw_offset");
 
     // Pre-load material uniform pack.
     mMaterialUniform.mKaLoc = mPhongShader->GetUniformLocation("material.Ka");
     mMaterialUniform.mKdLoc = mPhongShader->GetUniformLocation("material.Kd");
     mMaterialUniform.mKsLoc = mPhongShader->GetUniformLocation("material.Ks");
 
+    // Instanced shaders: material array.
+    for (int i = 0; i < kMaxInstanceMaterials; i++)
+    {
+      std::string material_prefix = "materials[" + std::to_string(i) + "].";
+
+      mInstanceMaterialUniformArray[i].mKaLoc = mPhongShader->GetUniformLocation(material_prefix + "Ka");
+      mInstanceMaterialUniformArray[i].mKdLoc = mPhongShader->GetUniformLocation(material_prefix + "Kd");
+      mInstanceMaterialUniformArray[i].mKsLoc = mPhongShader->GetUniformLocation(material_prefix + "Ks");
+    }
+
     // Pre-load light uniform packs.
     mLightingLoc = mPhongShader->GetUniformLocation("lighting");
     mNumLightUniform = mPhongShader->GetUniformLocation("num_lights");
@@ -97,6 +119,14 @@ GLint PhongRenderer::GetAttribLocation(const std::string & name, int renderingPa
   {
     return mTangentAttribLoc;
   }
+  else if (name == "bones" || name == "v_bones")
+  {
+    return mBoneIndexAttribLoc;
+  }
+  else if (name == "weights" || name == "v_weights")
+  {
+    return mBoneWeightAttribLoc;
+  }
   else  // Search it up.
   {
     return mPhongShader->GetAttribLocation(name);
@@ -190,4 +220,13 @@ void PhongRenderer::SetMaterial(const Material & material) const
   SetUniform3f(mMaterialUniform.mKsLoc,  material.mKs);  // Specular component.
 }
 
+void PhongRenderer::SetMaterial(const Material & material, int slot) const
+{
+  const MaterialUniformPack & materialUniform = mInstanceMaterialUniformArray[slot];
+
+  SetUniform3f(materialUniform.mKaLoc,  material.mKa);  // Ambient component.
+  SetUniform3f(materialUniform.mKdLoc,  material.mKd);  // Diffuse component.
+  SetUniform3f(materialUniform.mKsLoc,  material.mKs);  // Specular component.
+}
+
 }  // namespace gloo.
\ No newline at end of file
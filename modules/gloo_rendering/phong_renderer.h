@@ -78,23 +78,50 @@
 //     And then bind your Texture* to this slot:
 //      myTexture->Bind(slot);
 //
+// 8. Instanced rendering (shaders/phong_instanced):
+//  (a) Add an instanced rendering pass to the mesh with GetInstanceAttribLoc().
+//  (b) SetMaterial(material, slot) for every material used by the instances.
+//  (c) RenderInstanced() with the transforms (and material slots) of all instances, and the
+//      camera that selects their level of detail.
+//
+// 9. Skinned meshes (shaders/skinned_phong):
+//  (a) Add the bone attributes to the rendering pass with GetBoneIndexAttribLoc() and
+//      GetBoneWeightAttribLoc().
+//  (b) Update a BonePalette with the pose of the mesh before rendering it (see bone_palette.h).
+//
+// 10. Morph targets (shaders/morph_phong):
+//  Bind() the MorphTargetSet of the mesh before rendering it (see morph_targets.h). The samplers
+//  of the morph tables are linked to their texture units by Load().
+//
+// 11. Static geometry (see static_batcher.h):
+//  Render() a StaticBatcher to rebuild its dirty batches, cull them and draw the visible ones
+//  (default shaders).
+//
 // ------------------------------------------------------------------------------------------------
 
 #pragma once 
 
 #include <string>
+#include <vector>
+#include <cstring>
+#include <algorithm>
 
 #include "light.h"
 #include "renderer.h"
+#include "draw_batch.h"
+#include "static_batcher.h"
+#include "bone_palette.h"
 
 #include "gloo/material.h"
 #include "gloo/group.h"
+#include "gloo/morph_targets.h"
 #include "gloo/camera.h"
 
 namespace gloo 
 {
 
 const int kMaxNumberLights = 8;
+const int kMaxInstanceMaterials = 16;  // Size of the material array of instanced shaders.
 
 class PhongRenderer : public Renderer
 {
@@ -122,14 +149,37 @@ public:
   // If you're lazy to manually set the camera and then render the mesh, just call this method.
   // Please notice that by setting the camera before every object rendering, you will be updating
   // both M and V matrices without really needing.
+  // 'lod' keeps the level of detail of the object between frames (see Renderer::DrawMesh()).
   template <StorageFormat F>
-  void Render(const MeshGroup<F>* mesh, const Transform & model, Camera* camera, int pass=0) const;
+  void Render(const MeshGroup<F>* mesh, const Transform & model, Camera* camera, int pass=0,
+              GLuint* lod = nullptr) const;
 
   // Call this method if you want to render a single object without setting the camera.
   // It will automatically set both model and normal matrices.
+  // It draws the finest level of detail: use the overload above to select levels of detail and
+  // cull meshlets for a camera.
   template <StorageFormat F>
   void Render(const MeshGroup<F>* mesh, const Transform & model, int pass=0) const;
 
+  // Submits all draws of 'batch' (see draw_batch.h). The renderer must have been loaded with
+  // batch shaders (e.g. shaders/phong_mdi) and the camera set with SetCamera().
+  void Render(DrawBatch & batch, const Camera* camera) const;
+
+  // Rebuilds the dirty batches of 'batcher' (see static_batcher.h), culls them against the view
+  // frustum of 'camera' (if not nullptr) and draws the visible ones with their materials.
+  void Render(StaticBatcher & batcher, const Camera* camera, int pass = 0) const;
+
+  // Draws 'numInstances' copies of 'mesh' in a single call, one per transform in 'models'.
+  // 'materials' holds the material slot of each instance (see SetMaterial(material, slot)), or
+  // nullptr to use slot 0. The renderer must have been loaded with instanced shaders
+  // (e.g. shaders/phong_instanced) and 'pass' must be an instanced rendering pass of 'mesh'.
+  // The level of detail is selected for the instance closest to 'camera' (if not nullptr);
+  // 'lod' keeps it between frames, as in Render().
+  template <StorageFormat F>
+  void RenderInstanced(MeshGroup<F>* mesh, const Transform* models, GLuint numInstances,
+                       const Camera* camera, const GLuint* materials = nullptr,
+                       int pass = 0, GLuint* lod = nullptr) const;
+
   // Call bind before using PhongRenderer. Internally, it calls glUseProgram().
   virtual void Bind(int renderingPass = 0);
 
@@ -144,6 +194,9 @@ public:
   GLint GetTextureAttribLoc()  const { return mTextureAttribLoc;  }
   GLint GetNormalAttribLoc()   const { return mNormalAttribLoc;   }
   GLint GetTangentAttribLoc()  const { return mTangentAttribLoc;  }
+  GLint GetInstanceAttribLoc() const { return mInstanceAttribLoc; }  // First InstanceData location.
+  GLint GetBoneIndexAttribLoc()  const { return mBoneIndexAttribLoc;  }  // Skinning shaders.
+  GLint GetBoneWeightAttribLoc() const { return mBoneWeightAttribLoc; }
 
   GLint GetViewUniformLoc()   const { return mViewMatrixLoc; }
   GLint GetProjUniformLoc()   const { return mProjMatrixLoc; }
@@ -178,6 +231,7 @@ public:
 
   // === Material configuration methods ===
   void SetMaterial(const Material & material) const;
+  void SetMaterial(const Material & material, int slot) const;  // Instanced shaders.
 
   // === Texture configuration methods ===
 
@@ -196,11 +250,15 @@ private:
   GLint mTextureAttribLoc  { -1 };
   GLint mNormalAttribLoc   { -1 };
   GLint mTangentAttribLoc  { -1 };
+  GLint mInstanceAttribLoc { -1 };
+  GLint mBoneIndexAttribLoc  { -1 };
+  GLint mBoneWeightAttribLoc { -1 };
 
   GLint mViewMatrixLoc   { -1 };
   GLint mProjMatrixLoc   { -1 };
   GLint mModelMatrixLoc  { -1 };
   GLint mNormalMatrixLoc { -1 };
+  GLint mDrawOffsetLoc   { -1 };  // Batch shaders: first draw of the current indirect call.
 
   // Lighting.  
   GLint mLightingLoc { -1 };
@@ -211,6 +269,7 @@ private:
 
   // Material.
   MaterialUniformPack mMaterialUniform;  // Set of material uniforms.
+  MaterialUniformPack mInstanceMaterialUniformArray[kMaxInstanceMaterials];
 
   // Constant data (passed to constructor).
   const std::string mVertexShaderPath;
@@ -221,11 +280,36 @@ private:
 
 template <StorageFormat F>
 void PhongRenderer::Render(const MeshGroup<F>* mesh, const Transform & model, Camera* camera, 
-                           int pass) const
+                           int pass, GLuint* lod) const
 {
   PhongRenderer::SetModelNormalMatrix(model);
   camera->SetUniformViewMatrix(mViewMatrixLoc);
-  mesh->Render(pass);
+  Renderer::DrawMesh(mesh, model, camera, pass, lod);
+}
+
+inline
+void PhongRenderer::Render(DrawBatch & batch, const Camera* camera) const
+{
+  batch.Submit(camera, mDrawOffsetLoc);
+}
+
+inline
+void PhongRenderer::Render(StaticBatcher & batcher, const Camera* camera, int pass) const
+{
+  batcher.Rebuild();
+  batcher.Cull(camera);
+
+  // Batches are stored in world coordinates.
+  PhongRenderer::SetModelNormalMatrix(Transform());
+
+  for (const StaticBatch & batch : batcher.GetBatches())
+  {
+    if (batch.mVisible)
+    {
+      PhongRenderer::SetMaterial(batch.mMaterial);
+      batch.mMesh->Render(pass);
+    }
+  }
 }
 
 template <StorageFormat F>
@@ -235,6 +319,42 @@ void PhongRenderer::Render(const MeshGroup<F>* mesh, const Transform & model, in
   mesh->Render(pass);
 }
 
+template <StorageFormat F>
+void PhongRenderer::RenderInstanced(MeshGroup<F>* mesh, const Transform* models, 
+                                    GLuint numInstances, const Camera* camera,
+                                    const GLuint* materials, int pass, GLuint* lod) const
+{
+  std::vector<InstanceData> instances(numInstances);
+  GLfloat pixelsPerUnit = 0.0f;
+
+  const GLfloat* center = mesh->GetBoundingCenter();
+  const glm::vec3 point(center[0], center[1], center[2]);
+
+  for (GLuint i = 0; i < numInstances; i++)
+  {
+    const glm::mat4 model  = models[i].GetMatrix();
+    const glm::mat3 normal = glm::transpose(glm::mat3(models[i].GetInverseMatrix()));
+
+    InstanceData & instance = instances[i];
+    memcpy(instance.mModel,  &model[0][0],  sizeof(instance.mModel));
+    memcpy(instance.mNormal, &normal[0][0], sizeof(instance.mNormal));
+    instance.mMaterial = materials ? materials[i] : 0;
+
+    if (camera && mesh->GetNumLods() > 1)
+      pixelsPerUnit = std::max(pixelsPerUnit, camera->ComputePixelsPerUnit(model, point));
+  }
+
+  GLuint level = 0;
+  if (camera && mesh->GetNumLods() > 1)
+    level = mesh->SelectLod(pixelsPerUnit, lod ? *lod : 0);
+
+  if (lod)
+    *lod = level;
+
+  mesh->UpdateInstances(instances.data(), numInstances);
+  mesh->RenderInstanced(pass, level);
+}
+
 // ----- Inline methods ---------------------------------------------------------------------------
 
 inline
@@ -32,6 +32,8 @@
 #include <string>
 
 #include "gloo/shader_program.h"
+#include "gloo/group.h"
+#include "gloo/camera.h"
 
 namespace gloo
 {
@@ -62,8 +64,54 @@ public:
   // Get attribute/uniform for the corresponding rendering pass.
   virtual GLint GetAttribLocation( const std::string & name, int renderingPass = 0) const = 0;
   virtual GLint GetUniformLocation(const std::string & name, int renderingPass = 0) const = 0;
+
+protected:
+  // Selects the level of detail of 'mesh' for the point of view of 'camera', culls its meshlets
+  // (if it has meshlets and the first level is drawn) and draws it. 'lod' holds the level the
+  // object was drawn with last and receives the new one (nullptr: no hysteresis, see
+  // MeshGroup::SelectLod()).
+  template <StorageFormat F>
+  void DrawMesh(const MeshGroup<F>* mesh, const Transform & model, const Camera* camera,
+                int pass, GLuint* lod) const;
+
+private:
+  // Visible meshlets of the last DrawMesh(), kept to reuse its storage between draws.
+  mutable MeshletDrawList mMeshletDrawList;
 };
 
+template <StorageFormat F>
+void Renderer::DrawMesh(const MeshGroup<F>* mesh, const Transform & model, const Camera* camera,
+                        int pass, GLuint* lod) const
+{
+  GLuint level = 0;
+  if (mesh->GetNumLods() > 1)
+  {
+    const GLfloat* center = mesh->GetBoundingCenter();
+    const glm::vec3 point(center[0], center[1], center[2]);
+    level = mesh->SelectLod(camera->ComputePixelsPerUnit(model, point), lod ? *lod : 0);
+  }
+
+  if (lod)
+    *lod = level;
+
+  // Meshlets only split the first level.
+  if (mesh->GetNumMeshlets() == 0 || level != 0)
+  {
+    mesh->Render(pass, level);
+    return;
+  }
+
+  const glm::mat4 modelView = camera->ViewTransform().GetMatrix() * model.GetMatrix();
+  const glm::mat4 modelViewProj = camera->ProjTransform().GetMatrix() * modelView;
+
+  // Camera center in object coordinates.
+  const glm::vec4 eye = glm::inverse(modelView) * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+  const GLfloat eyePosition[3] = { eye[0] / eye[3], eye[1] / eye[3], eye[2] / eye[3] };
+
+  mesh->CullMeshlets(&modelViewProj[0][0], eyePosition, mMeshletDrawList);
+  mesh->Render(mMeshletDrawList, pass, level);
+}
+
 }  // namespace gloo.
 
 
@@ -0,0 +1,516 @@
+#include "static_batcher.h"
+
+#include "gloo/meshlet.h"
+
+#include <cmath>
+#include <limits>
+#include <cstring>
+#include <iterator>
+#include <numeric>
+#include <cassert>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define GLOO_STATIC_BATCHER_SSE2 1
+#endif
+
+namespace gloo
+{
+
+namespace
+{
+  // Draw mode that items drawn with 'drawMode' are merged into (GL_NONE if they can't be).
+  GLenum GetMergedDrawMode(GLenum drawMode)
+  {
+    switch (drawMode)
+    {
+      case GL_TRIANGLES:
+      case GL_TRIANGLE_STRIP: return GL_TRIANGLES;
+      case GL_LINES:
+      case GL_LINE_STRIP:
+      case GL_LINE_LOOP:      return GL_LINES;
+      case GL_POINTS:         return GL_POINTS;
+      default:                return GL_NONE;
+    }
+  }
+
+  // Converts the index stream of a group drawn with 'drawMode' into a list of its merged draw
+  // mode (strips and loops may be separated by kPrimitiveRestartIndex).
+  std::vector<GLuint> ConvertToList(GLenum drawMode, const std::vector<GLuint> & indices)
+  {
+    if (drawMode == GL_TRIANGLE_STRIP)
+      return TriangulateStrip(indices.data(), indices.size());
+
+    std::vector<GLuint> list;
+    if (drawMode != GL_LINE_STRIP && drawMode != GL_LINE_LOOP)
+    {
+      std::copy_if(indices.begin(), indices.end(), std::back_inserter(list),
+                   [](GLuint index) { return index != kPrimitiveRestartIndex; });
+      return list;
+    }
+
+    // One segment per pair of consecutive indices (plus the closing one of each loop).
+    GLuint first = 0;
+    for (GLuint i = 0; i <= indices.size(); i++)
+    {
+      if (i < indices.size() && indices[i] != kPrimitiveRestartIndex)
+      {
+        if (i > first)
+        {
+          list.push_back(indices[i-1]);
+          list.push_back(indices[i]);
+        }
+        continue;
+      }
+
+      if (drawMode == GL_LINE_LOOP && i > first + 2)
+      {
+        list.push_back(indices[i-1]);
+        list.push_back(indices[first]);
+      }
+      first = i + 1;
+    }
+
+    return list;
+  }
+
+  bool HaveSameAttribs(const std::vector<VertexAttrib> & a, const std::vector<VertexAttrib> & b)
+  {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(),
+      [](const VertexAttrib & x, const VertexAttrib & y) {
+        return x.mSize == y.mSize && x.mFormat == y.mFormat;
+      });
+  }
+
+  // Transforms 'count' points (x, y, z, -) in place by the affine matrix 'm' (column-major) and
+  // grows the box (boundsMin, boundsMax) to contain them.
+  void TransformPoints(const GLfloat* m, GLfloat* points, GLuint count,
+                       GLfloat* boundsMin, GLfloat* boundsMax)
+  {
+#if GLOO_STATIC_BATCHER_SSE2 == 1
+    const __m128 c0 = _mm_loadu_ps(m);
+    const __m128 c1 = _mm_loadu_ps(m + 4);
+    const __m128 c2 = _mm_loadu_ps(m + 8);
+    const __m128 c3 = _mm_loadu_ps(m + 12);
+
+    __m128 lo = _mm_set_ps(0.0f, boundsMin[2], boundsMin[1], boundsMin[0]);
+    __m128 hi = _mm_set_ps(0.0f, boundsMax[2], boundsMax[1], boundsMax[0]);
+
+    for (GLuint i = 0; i < count; i++)
+    {
+      const __m128 p = _mm_loadu_ps(points + 4*i);
+      const __m128 x = _mm_shuffle_ps(p, p, _MM_SHUFFLE(0, 0, 0, 0));
+      const __m128 y = _mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 1, 1, 1));
+      const __m128 z = _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 2, 2));
+
+      const __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, x), _mm_mul_ps(c1, y)),
+                                  _mm_add_ps(_mm_mul_ps(c2, z), c3));
+      _mm_storeu_ps(points + 4*i, r);
+
+      lo = _mm_min_ps(lo, r);
+      hi = _mm_max_ps(hi, r);
+    }
+
+    GLfloat bounds[8];
+    _mm_storeu_ps(bounds, lo);
+    _mm_storeu_ps(bounds + 4, hi);
+    std::copy(bounds, bounds + 3, boundsMin);
+    std::copy(bounds + 4, bounds + 7, boundsMax);
+#else
+    for (GLuint i = 0; i < count; i++)
+    {
+      GLfloat* p = points + 4*i;
+      const GLfloat x = p[0], y = p[1], z = p[2];
+      for (GLuint k = 0; k < 3; k++)
+      {
+        p[k] = m[k]*x + m[4 + k]*y + m[8 + k]*z + m[12 + k];
+        boundsMin[k] = std::min(boundsMin[k], p[k]);
+        boundsMax[k] = std::max(boundsMax[k], p[k]);
+      }
+    }
+#endif
+  }
+
+  // Transforms 'count' directions (x, y, z, w) in place by the 3x3 matrix 'm' (column-major,
+  // columns 4 floats apart, their fourth component 0), normalizes them and scales w by 'wScale'.
+  void TransformDirections(const GLfloat* m, GLfloat* directions, GLuint count, GLfloat wScale)
+  {
+#if GLOO_STATIC_BATCHER_SSE2 == 1
+    const __m128 c0 = _mm_loadu_ps(m);
+    const __m128 c1 = _mm_loadu_ps(m + 4);
+    const __m128 c2 = _mm_loadu_ps(m + 8);
+    const __m128 wMask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+    const __m128 wScales = _mm_set1_ps(wScale);
+    const __m128 minLength = _mm_set1_ps(std::numeric_limits<GLfloat>::min());
+
+    for (GLuint i = 0; i < count; i++)
+    {
+      const __m128 d = _mm_loadu_ps(directions + 4*i);
+      const __m128 x = _mm_shuffle_ps(d, d, _MM_SHUFFLE(0, 0, 0, 0));
+      const __m128 y = _mm_shuffle_ps(d, d, _MM_SHUFFLE(1, 1, 1, 1));
+      const __m128 z = _mm_shuffle_ps(d, d, _MM_SHUFFLE(2, 2, 2, 2));
+
+      __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, x), _mm_mul_ps(c1, y)), _mm_mul_ps(c2, z));
+
+      // Length of (x, y, z) (w is 0 here), broadcast: zero vectors stay zero.
+      const __m128 squares = _mm_mul_ps(r, r);
+      __m128 length = _mm_add_ss(_mm_add_ss(squares, _mm_shuffle_ps(squares, squares, 1)),
+                                 _mm_shuffle_ps(squares, squares, 2));
+      length = _mm_sqrt_ss(length);
+      length = _mm_shuffle_ps(length, length, _MM_SHUFFLE(0, 0, 0, 0));
+      r = _mm_div_ps(r, _mm_max_ps(length, minLength));
+
+      const __m128 w = _mm_mul_ps(_mm_and_ps(d, wMask), wScales);
+      _mm_storeu_ps(directions + 4*i, _mm_add_ps(r, w));
+    }
+#else
+    for (GLuint i = 0; i < count; i++)
+    {
+      GLfloat* d = directions + 4*i;
+      const GLfloat x = d[0], y = d[1], z = d[2];
+      for (GLuint k = 0; k < 3; k++)
+        d[k] = m[k]*x + m[4 + k]*y + m[8 + k]*z;
+
+      const GLfloat length = std::sqrt(d[0]*d[0] + d[1]*d[1] + d[2]*d[2]);
+      if (length > 0.0f)
+      {
+        d[0] /= length;
+        d[1] /= length;
+        d[2] /= length;
+      }
+      d[3] *= wScale;
+    }
+#endif
+  }
+
+  // Columns of 'm', 4 floats apart (as read by TransformDirections()).
+  void GetColumns(const glm::mat3 & m, GLfloat columns[12])
+  {
+    for (GLuint c = 0; c < 3; c++)
+    {
+      for (GLuint k = 0; k < 3; k++)
+        columns[4*c + k] = m[c][k];
+      columns[4*c + 3] = 0.0f;
+    }
+  }
+
+  // Returns false if the box (boundsMin, boundsMax) is outside one of the frustum planes.
+  bool IsBoxVisible(const GLfloat planes[6][4], const GLfloat* boundsMin, const GLfloat* boundsMax)
+  {
+    for (GLuint i = 0; i < 6; i++)
+    {
+      const GLfloat* plane = planes[i];
+
+      // Corner of the box farthest along the plane normal.
+      GLfloat distance = plane[3];
+      for (GLuint k = 0; k < 3; k++)
+        distance += plane[k] * (plane[k] >= 0.0f ? boundsMax[k] : boundsMin[k]);
+
+      if (distance < 0.0f)
+        return false;
+    }
+
+    return true;
+  }
+}  // namespace.
+
+StaticBatcher::StaticBatcher(GLuint positionAttrib, GLint normalAttrib, GLint tangentAttrib)
+: mPositionAttrib(positionAttrib)
+, mNormalAttrib(normalAttrib)
+, mTangentAttrib(tangentAttrib)
+{ }
+
+GLuint StaticBatcher::AddItem(std::unique_ptr<const SourceMesh> mesh, const Transform & model,
+                              const Material & material)
+{
+  assert(!mesh->IsStreaming() && GetMergedDrawMode(mesh->GetDrawMode()) != GL_NONE);
+  assert(mPositionAttrib < mesh->GetVertexAttribList().size());
+
+  const GLuint bin = StaticBatcher::FindBin(*mesh, material);
+  mBins[bin].mDirty = true;
+  mItems.push_back({ std::move(mesh), model.GetMatrix(), bin });
+
+  return mItems.size() - 1;
+}
+
+void StaticBatcher::SetTransform(GLuint item, const Transform & model)
+{
+  assert(item < mItems.size());
+
+  mItems[item].mModel = model.GetMatrix();
+  mBins[mItems[item].mBin].mDirty = true;
+}
+
+void StaticBatcher::SetMaterial(GLuint item, const Material & material)
+{
+  assert(item < mItems.size());
+
+  // Both the old and the new bin change.
+  mBins[mItems[item].mBin].mDirty = true;
+  mItems[item].mBin = StaticBatcher::FindBin(*mItems[item].mMesh, material);
+  mBins[mItems[item].mBin].mDirty = true;
+}
+
+void StaticBatcher::MarkDirty(GLuint item)
+{
+  assert(item < mItems.size());
+  mBins[mItems[item].mBin].mDirty = true;
+}
+
+void StaticBatcher::Clear()
+{
+  mItems.clear();
+  mBins.clear();
+  mBatches.clear();
+}
+
+int StaticBatcher::AddRenderingPass(const std::vector<std::pair<GLint, bool>> & attribList)
+{
+  mRenderingPasses.push_back(attribList);
+
+  for (StaticBatch & batch : mBatches)
+  {
+    std::vector<std::pair<GLint, bool>> passList(attribList);
+    passList.resize(batch.mMesh->GetVertexAttribList().size(), {-1, false});
+    batch.mMesh->AddRenderingPass(passList);
+  }
+
+  return mRenderingPasses.size() - 1;
+}
+
+void StaticBatcher::SetMaxBatchVertices(GLuint maxVertices)
+{
+  mMaxBatchVertices = std::max(maxVertices, 1u);
+
+  for (Bin & bin : mBins)
+    bin.mDirty = true;
+}
+
+bool StaticBatcher::IsDirty() const
+{
+  return std::any_of(mBins.begin(), mBins.end(), [](const Bin & bin) { return bin.mDirty; });
+}
+
+bool StaticBatcher::Rebuild()
+{
+  if (!StaticBatcher::IsDirty())
+    return false;
+
+  mBatches.erase(std::remove_if(mBatches.begin(), mBatches.end(),
+                                [this](const StaticBatch & batch) {
+                                  return mBins[batch.mBin].mDirty;
+                                }),
+                 mBatches.end());
+
+  // Groups used by several items are read back once.
+  std::map<const void*, Source> sources;
+
+  for (GLuint bin = 0; bin < mBins.size(); bin++)
+  {
+    if (!mBins[bin].mDirty)
+      continue;
+
+    std::vector<GLuint> items;
+    for (GLuint i = 0; i < mItems.size(); i++)
+    {
+      if (mItems[i].mBin == bin)
+        items.push_back(i);
+    }
+
+    // Fill batches up to the vertex limit, keeping the order of the items.
+    GLuint first = 0;
+    GLuint numVertices = 0;
+    for (GLuint k = 0; k < items.size(); k++)
+    {
+      const GLuint itemVertices = mItems[items[k]].mMesh->GetNumVertices();
+      if (k > first && numVertices + itemVertices > mMaxBatchVertices)
+      {
+        StaticBatcher::BuildBatch(bin, items, first, k, sources);
+        first = k;
+        numVertices = 0;
+      }
+      numVertices += itemVertices;
+    }
+
+    if (first < items.size())
+      StaticBatcher::BuildBatch(bin, items, first, items.size(), sources);
+
+    mBins[bin].mDirty = false;
+  }
+
+  return true;
+}
+
+GLuint StaticBatcher::Cull(const Camera* camera)
+{
+  GLfloat planes[6][4];
+  if (camera)
+  {
+    const glm::mat4 viewProj = camera->ProjTransform().GetMatrix()
+                             * camera->ViewTransform().GetMatrix();
+    ExtractFrustumPlanes(&viewProj[0][0], planes);
+  }
+
+  GLuint numVisible = 0;
+  for (StaticBatch & batch : mBatches)
+  {
+    batch.mVisible = !camera || IsBoxVisible(planes, batch.mBoundsMin, batch.mBoundsMax);
+    numVisible += batch.mVisible ? 1 : 0;
+  }
+
+  return numVisible;
+}
+
+GLuint StaticBatcher::FindBin(const SourceMesh & mesh, const Material & material)
+{
+  const GLenum drawMode = GetMergedDrawMode(mesh.GetDrawMode());
+  const std::vector<VertexAttrib> & attribs = mesh.GetVertexAttribList();
+
+  // Few bins are expected (one per material), so a linear search is fine.
+  for (GLuint i = 0; i < mBins.size(); i++)
+  {
+    const Bin & bin = mBins[i];
+    if (bin.mDrawMode == drawMode && bin.mMaterial.mKa == material.mKa
+        && bin.mMaterial.mKd == material.mKd && bin.mMaterial.mKs == material.mKs
+        && HaveSameAttribs(bin.mAttribs, attribs))
+    {
+      return i;
+    }
+  }
+
+  mBins.push_back({ material, attribs, drawMode, true });
+  return mBins.size() - 1;
+}
+
+void StaticBatcher::BuildBatch(GLuint bin, const std::vector<GLuint> & items,
+                               GLuint first, GLuint last,
+                               std::map<const void*, Source> & sources)
+{
+  const Bin & batchBin = mBins[bin];
+  const std::vector<VertexAttrib> & attribs = batchBin.mAttribs;
+
+  // Interleaved layout of the bin.
+  std::vector<GLuint> offsets(attribs.size());
+  GLuint stride = 0;
+  for (GLuint j = 0; j < attribs.size(); j++)
+  {
+    offsets[j] = stride;
+    stride += GetAttribBytes(attribs[j]);
+  }
+
+  GLuint numVertices = 0;
+  GLuint numIndices = 0;
+  for (GLuint k = first; k < last; k++)
+  {
+    const SourceMesh* mesh = mItems[items[k]].mMesh.get();
+    Source & source = sources[mesh->GetKey()];
+    if (source.mVertices.empty())
+    {
+      std::vector<GLuint> indices;
+      mesh->ReadBack(source.mVertices, indices);
+      if (!mesh->IsIndexed())
+      {
+        indices.resize(mesh->GetNumVertices());
+        std::iota(indices.begin(), indices.end(), 0);
+      }
+      source.mIndices = ConvertToList(mesh->GetDrawMode(), indices);
+    }
+
+    numVertices += mesh->GetNumVertices();
+    numIndices += source.mIndices.size();
+  }
+
+  if (numIndices == 0)
+    return;
+
+  StaticBatch batch;
+  batch.mMaterial = batchBin.mMaterial;
+  batch.mBin = bin;
+  batch.mNumItems = last - first;
+  std::fill(batch.mBoundsMin, batch.mBoundsMin + 3, std::numeric_limits<GLfloat>::max());
+  std::fill(batch.mBoundsMax, batch.mBoundsMax + 3, -std::numeric_limits<GLfloat>::max());
+
+  std::vector<GLubyte> vertices(numVertices * stride);
+  std::vector<GLuint> indices;
+  indices.reserve(numIndices);
+
+  std::vector<GLfloat> scratch;  // (x, y, z, w) per vertex.
+  const bool hasNormals  = mNormalAttrib >= 0 && GLuint(mNormalAttrib) < attribs.size();
+  const bool hasTangents = mTangentAttrib >= 0 && GLuint(mTangentAttrib) < attribs.size();
+
+  GLuint baseVertex = 0;
+  for (GLuint k = first; k < last; k++)
+  {
+    const Item & item = mItems[items[k]];
+    const Source & source = sources[item.mMesh->GetKey()];
+    const GLuint count = item.mMesh->GetNumVertices();
+
+    // Attributes that aren't transformed are copied as they are (read back interleaved, still in
+    // their formats).
+    GLubyte* dst = &vertices[baseVertex * stride];
+    memcpy(dst, source.mVertices.data(), count * stride);
+
+    const glm::mat3 linear(item.mModel);
+    const bool mirrored = glm::determinant(linear) < 0.0f;
+
+    scratch.assign(4 * count, 0.0f);
+    const VertexAttrib & position = attribs[mPositionAttrib];
+    UnpackAttrib(position, dst + offsets[mPositionAttrib], stride, count, scratch.data(), 4);
+    TransformPoints(&item.mModel[0][0], scratch.data(), count, batch.mBoundsMin,
+                    batch.mBoundsMax);
+    PackAttrib(position, scratch.data(), 4, count, dst + offsets[mPositionAttrib], stride);
+
+    GLfloat columns[12];
+    if (hasNormals)
+    {
+      GetColumns(glm::transpose(glm::inverse(linear)), columns);
+
+      scratch.assign(4 * count, 0.0f);
+      const VertexAttrib & normal = attribs[mNormalAttrib];
+      UnpackAttrib(normal, dst + offsets[mNormalAttrib], stride, count, scratch.data(), 4);
+      TransformDirections(columns, scratch.data(), count, 1.0f);
+      PackAttrib(normal, scratch.data(), 4, count, dst + offsets[mNormalAttrib], stride);
+    }
+
+    if (hasTangents)
+    {
+      GetColumns(linear, columns);
+
+      scratch.assign(4 * count, 0.0f);
+      const VertexAttrib & tangent = attribs[mTangentAttrib];
+      UnpackAttrib(tangent, dst + offsets[mTangentAttrib], stride, count, scratch.data(), 4);
+      TransformDirections(columns, scratch.data(), count, mirrored ? -1.0f : 1.0f);
+      PackAttrib(tangent, scratch.data(), 4, count, dst + offsets[mTangentAttrib], stride);
+    }
+
+    const GLuint firstIndex = indices.size();
+    for (GLuint index : source.mIndices)
+      indices.push_back(baseVertex + index);
+
+    // Mirroring flips the winding: restore it.
+    if (mirrored && batchBin.mDrawMode == GL_TRIANGLES)
+    {
+      for (GLuint i = firstIndex; i + 2 < indices.size(); i += 3)
+        std::swap(indices[i + 1], indices[i + 2]);
+    }
+
+    baseVertex += count;
+  }
+
+  batch.mMesh.reset(new MeshGroup<Interleave>(numVertices, indices.size(), batchBin.mDrawMode));
+  batch.mMesh->SetVertexAttribList(attribs);
+  batch.mMesh->SetDebugName("StaticBatch");
+  batch.mMesh->LoadPacked(vertices.data(), indices.data());
+
+  for (const std::vector<std::pair<GLint, bool>> & attribList : mRenderingPasses)
+  {
+    std::vector<std::pair<GLint, bool>> passList(attribList);
+    passList.resize(attribs.size(), {-1, false});
+    batch.mMesh->AddRenderingPass(passList);
+  }
+
+  mBatches.push_back(std::move(batch));
+}
+
+}  // namespace gloo.
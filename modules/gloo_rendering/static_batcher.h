@@ -0,0 +1,213 @@
+// + ======================================== +
+// |         gl-oo-interface library          |
+// |         Module: GLOO Rendering.          |
+// |        Author: Rodrigo Castiel, 2016.    |
+// + ======================================== +
+//
+// StaticBatcher merges many small static (mesh, transform, material) items into a few large
+// groups, so that a scene made of hundreds of pieces (grids, polygons, props) is drawn with a
+// handful of calls instead of one PhongRenderer::Render() per piece.
+//
+// Items are sorted into bins by material, attribute list and draw mode. When a bin is rebuilt,
+// the geometry of its items is read back from their groups (MeshGroup::ReadBack()), transformed
+// into world space on the CPU (SSE2 kernels: positions by the model matrix, normals by the
+// normal matrix, tangents by the model matrix, both renormalized) and concatenated into
+// MeshGroup<Interleave> batches of up to GetMaxBatchVertices() vertices (by default, they fit
+// 16-bit indices). Strips and loops are converted into lists, so that items can be appended.
+// Mirroring transforms flip the winding of triangles (and the handedness of tangents) back.
+//
+// Batches are drawn with an identity model matrix. Each one keeps the world space bounding box
+// of its vertices, which Cull() tests against the view frustum. Items added in spatial order
+// (e.g. tile by tile) make smaller boxes, so that more batches are culled.
+//
+// Rebuilding is not cheap (it stalls on the read back of groups that don't keep a staging copy):
+// Rebuild() only rebuilds the bins marked dirty by Add(), SetTransform(), SetMaterial() or
+// MarkDirty(), and does nothing otherwise. Source groups can use any storage format (batched and
+// split ones are interleaved as they are read back), must be non-streaming and have to outlive
+// their items (they can be drawn on their own as well).
+//
+//  ---------------------------------------------------------------------------
+//  USAGE
+//
+//  StaticBatcher batcher;  // Position, normal: attributes 0 and 1.
+//  batcher.AddRenderingPass({{renderer->GetPositionAttribLoc(), true},
+//                            {renderer->GetNormalAttribLoc(),   true},
+//                            {renderer->GetTextureAttribLoc(),  true}});
+//  for (const Prop & prop : props)
+//    batcher.Add(prop.mMesh, prop.mTransform, prop.mMaterial);
+//  ...
+//  // On rendering (rebuilds the dirty bins, culls and draws the batches).
+//  renderer->Bind();
+//  renderer->SetCamera(camera);
+//  renderer->Render(batcher, camera);
+//  ---------------------------------------------------------------------------
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <vector>
+#include <utility>
+
+#include "gloo/gl_header.h"
+#include "gloo/group.h"
+#include "gloo/camera.h"
+#include "gloo/material.h"
+#include "gloo/transform.h"
+
+namespace gloo
+{
+
+// Largest batch (in vertices) addressable with GL_UNSIGNED_SHORT indices.
+const GLuint kDefaultMaxBatchVertices = 65536;
+
+// A merged group and its world space bounds.
+struct StaticBatch
+{
+  std::unique_ptr<MeshGroup<Interleave>> mMesh;
+  Material mMaterial;
+  GLuint mBin;             // Bin of the items merged into this batch.
+  GLuint mNumItems;
+  GLfloat mBoundsMin[3];   // World space bounding box.
+  GLfloat mBoundsMax[3];
+  bool mVisible { true };  // Result of the last Cull().
+};
+
+class StaticBatcher
+{
+public:
+  // 'positionAttrib' is transformed as a point, 'normalAttrib' as a normal and 'tangentAttrib'
+  // as a tangent (a fourth component holds its handedness). -1: the attribute doesn't exist.
+  StaticBatcher(GLuint positionAttrib = 0, GLint normalAttrib = 1, GLint tangentAttrib = -1);
+
+  // Adds an item (drawn with GL_TRIANGLES, GL_TRIANGLE_STRIP, GL_LINES, GL_LINE_STRIP,
+  // GL_LINE_LOOP or GL_POINTS) and returns its index. Its bin is marked dirty.
+  template <StorageFormat F>
+  GLuint Add(const MeshGroup<F>* mesh, const Transform & model, const Material & material);
+
+  // Moves an item/changes its material (its bins are marked dirty).
+  void SetTransform(GLuint item, const Transform & model);
+  void SetMaterial(GLuint item, const Material & material);
+
+  // Marks the bin of an item as dirty (e.g. after its group was updated).
+  void MarkDirty(GLuint item);
+
+  // Removes all items and batches (rendering passes are kept).
+  void Clear();
+
+  // Adds a rendering pass to every batch (see MeshGroup::AddRenderingPass()). Attributes that
+  // the items of a bin don't have are ignored.
+  int AddRenderingPass(const std::vector<std::pair<GLint, bool>> & attribList);
+
+  // Rebuilds the batches of the dirty bins. Returns false if there was nothing to rebuild.
+  bool Rebuild();
+
+  // Flags the batches whose bounds intersect the view frustum of 'camera' (all of them if
+  // nullptr) and returns how many are visible.
+  GLuint Cull(const Camera* camera);
+
+  // Splits bins into batches of at most 'maxVertices' vertices (items are never split).
+  void SetMaxBatchVertices(GLuint maxVertices);
+
+  // Getters.
+  GLuint GetNumItems() const { return mItems.size(); }
+  GLuint GetNumBins() const { return mBins.size(); }
+  GLuint GetNumBatches() const { return mBatches.size(); }
+  GLuint GetMaxBatchVertices() const { return mMaxBatchVertices; }
+  const std::vector<StaticBatch> & GetBatches() const { return mBatches; }
+  bool IsDirty() const;
+
+private:
+  // A source group, whatever its storage format.
+  class SourceMesh
+  {
+  public:
+    virtual ~SourceMesh() { }
+    virtual const void* GetKey() const = 0;
+    virtual bool IsStreaming() const = 0;
+    virtual bool IsIndexed() const = 0;
+    virtual GLenum GetDrawMode() const = 0;
+    virtual GLuint GetNumVertices() const = 0;
+    virtual const std::vector<VertexAttrib> & GetVertexAttribList() const = 0;
+    virtual void ReadBack(std::vector<GLubyte> & vertices,
+                          std::vector<GLuint> & indices) const = 0;
+  };
+
+  template <StorageFormat F>
+  class SourceMeshOf : public SourceMesh
+  {
+  public:
+    SourceMeshOf(const MeshGroup<F>* mesh) : mMesh(mesh) { }
+    const void* GetKey() const { return mMesh; }
+    bool IsStreaming() const { return mMesh->IsStreaming(); }
+    bool IsIndexed() const { return mMesh->IsIndexed(); }
+    GLenum GetDrawMode() const { return mMesh->GetDrawMode(); }
+    GLuint GetNumVertices() const { return mMesh->GetNumVertices(); }
+    const std::vector<VertexAttrib> & GetVertexAttribList() const
+    {
+      return mMesh->GetVertexAttribList();
+    }
+    void ReadBack(std::vector<GLubyte> & vertices, std::vector<GLuint> & indices) const
+    {
+      mMesh->ReadBack(vertices, indices);
+    }
+
+  private:
+    const MeshGroup<F>* mMesh;
+  };
+
+  struct Item
+  {
+    std::unique_ptr<const SourceMesh> mMesh;
+    glm::mat4 mModel;
+    GLuint mBin;
+  };
+
+  struct Bin
+  {
+    Material mMaterial;
+    std::vector<VertexAttrib> mAttribs;
+    GLenum mDrawMode;  // Merged draw mode: GL_TRIANGLES, GL_LINES or GL_POINTS.
+    bool mDirty;
+  };
+
+  // Geometry of a source group, read back once per Rebuild().
+  struct Source
+  {
+    std::vector<GLubyte> mVertices;
+    std::vector<GLuint> mIndices;  // Converted to the draw mode of its bin.
+  };
+
+  // Adds an item of any storage format (see Add()).
+  GLuint AddItem(std::unique_ptr<const SourceMesh> mesh, const Transform & model,
+                 const Material & material);
+
+  // Index of the bin of (material, attributes, draw mode of 'mesh'), added if new.
+  GLuint FindBin(const SourceMesh & mesh, const Material & material);
+
+  // Merges items [first, last) of 'items' (all in bin 'bin') into a new batch. Source groups are
+  // keyed by their address.
+  void BuildBatch(GLuint bin, const std::vector<GLuint> & items, GLuint first, GLuint last,
+                  std::map<const void*, Source> & sources);
+
+  const GLuint mPositionAttrib;
+  const GLint mNormalAttrib;
+  const GLint mTangentAttrib;
+
+  std::vector<Item> mItems;
+  std::vector<Bin> mBins;
+  std::vector<StaticBatch> mBatches;
+  std::vector<std::vector<std::pair<GLint, bool>>> mRenderingPasses;
+
+  GLuint mMaxBatchVertices { kDefaultMaxBatchVertices };
+};
+
+template <StorageFormat F>
+GLuint StaticBatcher::Add(const MeshGroup<F>* mesh, const Transform & model,
+                          const Material & material)
+{
+  std::unique_ptr<const SourceMesh> source(new SourceMeshOf<F>(mesh));
+  return StaticBatcher::AddItem(std::move(source), model, material);
+}
+
+}  // namespace gloo.
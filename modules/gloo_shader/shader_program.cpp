@@ -1,4 +1,6 @@
 #include "shader_program.h"
+#include "../include/gloo/gl_capabilities.h"
+#include <utility>
 #include <iostream>
 
 #define LOG_OUTPUT_ON 0
@@ -49,6 +51,9 @@ bool ShaderProgram::BuildFromFiles(const char* vertexShaderPath,
       return false;
     }
   }
+  if (vertexShaderPath != NULL)
+    mDebugName = vertexShaderPath;
+
   bool exitCode = BuildFromStrings(shaderCodes[0], shaderCodes[1], shaderCodes[2], shaderCodes[3], shaderCodes[4]);
   for (int i = 0; i < 5; i++) 
   {
@@ -190,6 +195,13 @@ bool ShaderProgram::BuildFromStrings(const char* vertexShaderCode,
 
   mCompilationStatus = kSuccess;
 
+  // The driver doesn't tell how much memory a program takes: its binary size is close enough.
+  GLint binaryBytes = 0;
+  if (IsGLVersionSupported(4, 1))
+    glGetProgramiv(mHandle, GL_PROGRAM_BINARY_LENGTH, &binaryBytes);
+
+  GpuMemory::Track(kGpuProgramObject, mHandle, binaryBytes, kGpuShaderProgram, mDebugName);
+
 #if LOG_OUTPUT_ON == 1
     std::cout << "-- COMPILATION COMPLETE --" << std::endl;
 #endif
@@ -198,6 +210,32 @@ bool ShaderProgram::BuildFromStrings(const char* vertexShaderCode,
 }
 
 
+ShaderProgram::ShaderProgram(ShaderProgram && other)
+{
+  ShaderProgram::Swap(other);
+}
+
+ShaderProgram & ShaderProgram::operator=(ShaderProgram && other)
+{
+  ShaderProgram moved(std::move(other));  // Leaves 'other' empty.
+  ShaderProgram::Swap(moved);             // The previous program is deleted with 'moved'.
+  return *this;
+}
+
+void ShaderProgram::Swap(ShaderProgram & other)
+{
+  std::swap(mHandle, other.mHandle);
+  std::swap(mCompilationStatus, other.mCompilationStatus);
+  std::swap(mCompilationLog, other.mCompilationLog);
+  std::swap(mDebugName, other.mDebugName);
+}
+
+void ShaderProgram::SetDebugName(const std::string & name)
+{
+  mDebugName = name;
+  GpuMemory::Rename(kGpuProgramObject, mHandle, name);
+}
+
 int ShaderProgram::CompileShader(const char * shaderCode, GLenum shaderType, GLuint & shaderHandle)
 {
   shaderHandle = glCreateShader(shaderType);
@@ -299,6 +337,17 @@ GLint ShaderProgram::GetAttribLocation(const std::string & variableName) const
 }
 
 
+bool ShaderProgram::SetUniformBlockBinding(const char * blockName, GLuint binding) const
+{
+  const GLuint blockIndex = glGetUniformBlockIndex(mHandle, blockName);
+  if (blockIndex == GL_INVALID_INDEX)
+    return false;
+
+  glUniformBlockBinding(mHandle, blockIndex, binding);
+  return true;
+}
+
+
 void ShaderProgram::PrintCompilationLog() const
 {
   std::cout << "Compilation Log: " << std::endl;
@@ -37,6 +37,8 @@
 #pragma once
 
 #include "../include/gloo/gl_header.h"
+#include "../include/gloo/gpu_memory.h"
+#include "../include/gloo/resource_pool.h"
 
 #include <vector>
 #include <string>
@@ -53,9 +55,16 @@ public:
 
   ~ShaderProgram() 
   { 
+    GpuMemory::Release(kGpuProgramObject, mHandle);
     glDeleteProgram(mHandle);
   }
 
+  // Programs own their OpenGL object: they can be moved, but not copied.
+  ShaderProgram(const ShaderProgram &) = delete;
+  ShaderProgram & operator=(const ShaderProgram &) = delete;
+  ShaderProgram(ShaderProgram && other);
+  ShaderProgram & operator=(ShaderProgram && other);
+
   // Loads shaders from files specified by the corresponding paths.
   bool BuildFromFiles(const char* vertexShaderPath, 
                       const char* fragmentShaderPath,
@@ -82,6 +91,10 @@ public:
 
   // Returns shader program handle.
   inline GLuint GetHandle() const { return mHandle; }
+
+  // Name of this program in GPU memory reports (the vertex shader path, if built from files).
+  void SetDebugName(const std::string & name);
+  const std::string & GetDebugName() const { return mDebugName; }
   
   // Returns the location for a uniform stored in this shader program.
   // If the uniform couldn't be found, the return value is -1.
@@ -93,6 +106,10 @@ public:
   GLint GetAttribLocation(const char * variableName) const;
   GLint GetAttribLocation(const std::string & variableName) const;
 
+  // Binds the uniform block 'blockName' to the uniform buffer binding point 'binding'.
+  // Returns false if the program has no such block.
+  bool SetUniformBlockBinding(const char * blockName, GLuint binding) const;
+
   // Returns the vector of compilation messages (as a copy).
   std::vector<std::string> GetCompilationLog() const { return mCompilationLog; }
 
@@ -116,10 +133,17 @@ public:
   int LoadShader(const char* filename, char* code, int len);
 
 protected:
+  // Exchanges every member (and so the OpenGL program) with 'other'.
+  void Swap(ShaderProgram & other);
+
   GLuint mHandle { 0 };  // OpenGL handle for the entire shader program.
 
   CompilationStatus mCompilationStatus { kUnitialized };  // Tells the result of compilation (see enum).
   std::vector<std::string> mCompilationLog;               // Stores all error messages from compiler/linker.
+
+  std::string mDebugName { "ShaderProgram" };  // See gpu_memory.h.
 };
 
+typedef Handle<ShaderProgram> ShaderHandle;
+
 }  // namespace gloo.
\ No newline at end of file
@@ -1,11 +1,15 @@
 #include "camera.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace gloo
 {
 
 void Camera::SetOnReshape(int xo, int yo, int w, int h)
 {
   mProjParameters.mAspect = static_cast<float>(w - xo) / static_cast<float>(h - yo);
+  mProjParameters.mViewportHeight = static_cast<float>(h - yo);
   mProj.LoadIdentity();
 
   const float & mFovy = mProjParameters.mFovy;
@@ -79,4 +83,27 @@ glm::vec3 Camera::ComputeRayAt(float x_v, float y_v, float w, float h) const
   return glm::vec3(ray[0], ray[1], ray[2]);
 }
 
-}  // namespace gloo.
\ No newline at end of file
+float Camera::ComputePixelsPerUnit(const Transform & model, const glm::vec3 & point) const
+{
+  return Camera::ComputePixelsPerUnit(model.GetMatrix(), point);
+}
+
+float Camera::ComputePixelsPerUnit(const glm::mat4 & model, const glm::vec3 & point) const
+{
+  const glm::mat4 MV = mView.GetMatrix() * model;
+
+  // Distance to the camera along the view direction (clamped to the near plane).
+  const glm::vec4 p = MV * glm::vec4(point[0], point[1], point[2], 1.0f);
+  const float distance = std::max(-p[2], mProjParameters.mNearZ);
+
+  // Largest scale applied by the model-view transform.
+  float scale = 0.0f;
+  for (int i = 0; i < 3; i++)
+    scale = std::max(scale, glm::length(glm::vec3(MV[i][0], MV[i][1], MV[i][2])));
+
+  // Half of the viewport height covers tan(fovy/2) * distance units.
+  const float halfHeight = 0.5f * mProjParameters.mViewportHeight;
+  return scale * halfHeight / (std::tan(0.5f * mProjParameters.mFovy) * distance);
+}
+
+}  // namespace gloo.
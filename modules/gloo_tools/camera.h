@@ -46,6 +46,7 @@ struct ProjectionParameters
   float mFarZ   { 1000.0 };      // Maximum rendering distance.
   float mNearZ  {    0.1 };      // Minimum rendering distance.
   float mAspect {  4.0/3.0 } ;   // Ratio a = W / H  [width/height].
+  float mViewportHeight { 600 }; // Viewport height in pixels (set on reshape).
 };
 
 class Camera
@@ -123,6 +124,13 @@ public:
   // Computes the vector which goes from camera center to mouse coordinates on projection plane.
   glm::vec3 ComputeRayAt(float x_v, float y_v, float w, float h) const;
 
+  // 5. Methods for level of detail selection.
+
+  // Number of pixels covered by one unit of the model space at 'point' (model coordinates),
+  // from the last rendering. Used to project geometric errors onto the screen.
+  float ComputePixelsPerUnit(const Transform & model, const glm::vec3 & point) const;
+  float ComputePixelsPerUnit(const glm::mat4 & model, const glm::vec3 & point) const;
+
 protected:
   glm::vec3 mPos   { 0, 0, 1 };  // Center coordinates.
   glm::vec3 mRot   { 0, 0, 0 };  // Rotation angles in x, y, z axis (orientation).
@@ -1,8 +1,80 @@
 #include "useful_meshes.h"
+#include "gloo/tangent_space.h"
 
 namespace gloo
 {
 
+namespace
+{
+
+// Wireframe element array of a w x h grid of vertices, using every 'step'-th row and column
+// ((w-1) and (h-1) must be multiples of 'step'): one GL_LINE_STRIP per row and per column,
+// separated by kPrimitiveRestartIndex (the group must enable primitive restart).
+std::vector<GLuint> GridWireframeIndices(int w, int h, int step)
+{
+  const int ws = (w-1)/step + 1;
+  const int hs = (h-1)/step + 1;
+
+  std::vector<GLuint> indices;
+  indices.reserve(2*ws*hs + ws + hs);
+
+  for (int y = 0; y < hs; y++)  // Horizontally.
+  {
+    for (int x = 0; x < ws; x++)
+      indices.push_back(w*(step*y) + step*x);  // INDEX(x, y).
+    indices.push_back(kPrimitiveRestartIndex);
+  }
+
+  for (int x = 0; x < ws; x++)  // Vertically.
+  {
+    for (int y = 0; y < hs; y++)
+      indices.push_back(w*(step*y) + step*x);  // INDEX(x, y).
+    indices.push_back(kPrimitiveRestartIndex);
+  }
+
+  indices.pop_back();  // No restart after the last strip.
+  return indices;
+}
+
+// Triangle strip element array of a w x h grid of vertices, using every 'step'-th row and
+// column ((w-1) and (h-1) must be multiples of 'step'): one strip per row, separated by
+// kPrimitiveRestartIndex (the group must enable primitive restart).
+std::vector<GLuint> GridStripIndices(int w, int h, int step)
+{
+  std::vector<GLuint> indices;
+  indices.reserve(((h-1)/step)*(2*((w-1)/step + 1) + 1));
+
+  for (int v = 0; v < h-1; v += step)
+  {
+    // Zig-zag pattern: alternate between top and bottom.
+    for (int u = 0; u < w; u += step)
+    {
+      indices.push_back((v+0)*w + u);
+      indices.push_back((v+step)*w + u);
+    }
+
+    // Next row: restart the strip (instead of connecting rows with degenerate triangles).
+    if (v < h-1-step)
+      indices.push_back(kPrimitiveRestartIndex);
+  }
+
+  return indices;
+}
+
+// Maximum distance between a unit sphere and its tessellation, when edges span 'angle' radians.
+GLfloat SphereTessellationError(GLfloat angle)
+{
+  return 1.0f - cos(0.5f * angle);
+}
+
+// Levels of detail of the sphere tessellations below: every 2nd, 4th, 8th row and column.
+const int kSphereLodSteps[] = { 2, 4, 8 };
+
+// Coarsest grid kept as a level of detail (segments along v).
+const int kSphereLodMinSegments = 4;
+
+}  // namespace.
+
 // ============================================================================================= //
 
 AxisMesh::AxisMesh(GLint positionAttribLoc, GLint colorAttribLoc)
@@ -26,6 +98,9 @@ AxisMesh::AxisMesh(GLint positionAttribLoc, GLint colorAttribLoc)
   // Specify its attributes.
   mMeshGroup->SetVertexAttribList({3, 3});
 
+  // Its geometry is updated often, so stream it without stalling.
+  mMeshGroup->EnableStreaming();
+
   // Add rendering pass.
   mMeshGroup->AddRenderingPass({{positionAttribLoc, true}, {colorAttribLoc, true}});
 
@@ -85,6 +160,9 @@ BoundingBoxMesh::BoundingBoxMesh(GLint positionAttribLoc, GLint colorAttribLoc,
   // Specify its attributes.
   mMeshGroup->SetVertexAttribList({3, 3});
 
+  // Its geometry is updated often, so stream it without stalling.
+  mMeshGroup->EnableStreaming();
+
   // Add rendering pass.
   mMeshGroup->AddRenderingPass({{positionAttribLoc, true}, {colorAttribLoc, true}});
 
@@ -121,7 +199,6 @@ GridMesh::GridMesh(GLint positionAttribLoc, GLint colorAttribLoc, int width, int
   const int h = std::max(height, 2);
 
   const int numVertices = w * h;
-  const int numElements = 2 * w * h;
   const GLenum drawMode = GL_LINE_STRIP;
 
   std::vector<GLfloat> vertices;
@@ -154,39 +231,15 @@ GridMesh::GridMesh(GLint positionAttribLoc, GLint colorAttribLoc, int width, int
     }
   }
 
-  indices.reserve(numElements);
-
-  // Wire frame Element array - indices are written in a zig-zag pattern,
-  // first horizontally and then vertically. It uses GL_LINE_STRIP. 
-  int index = 0;
-  int x = 0, y = 0;
-  int dx = 1, dy = -1;
-
-  for (y = 0; y < h; y++)  // Horizontally.
-  {
-    x = ((dx == 1) ? 0 : w-1);
-    for (int k = 0; k < w; k++, x += dx)
-      indices.push_back(w*x + y);
-    dx *= -1;
-  }
-
-  // Start from the last point to allow continuity in GL_LINE_STRIP.
-  x = ((dx == 1) ? 0 : w-1);
-  y = h-1;  
-  dy = -1;
-  for (int i = 0; i < w; i++, x += dx)  // Vertically.
-  {
-    y = ((dy == 1) ? 0 : h-1);
-    for (int j = 0; j < h; j++, y += dy)
-      indices.push_back(w*x + y);
-    dy *= -1;
-  }
+  // Wireframe Element array (see GridWireframeIndices()).
+  indices = GridWireframeIndices(w, h, 1);
 
   // Allocate mesh.
-  mMeshGroup = new MeshGroup<Interleave>(numVertices, numElements, drawMode);
+  mMeshGroup = new MeshGroup<Interleave>(numVertices, indices.size(), drawMode);
 
   // Specify its attributes.
   mMeshGroup->SetVertexAttribList({3, 3});
+  mMeshGroup->EnablePrimitiveRestart();
 
   // Add rendering pass.
   mMeshGroup->AddRenderingPass({{positionAttribLoc, true}, {colorAttribLoc, true}});
@@ -299,7 +352,6 @@ WireframeSphere::WireframeSphere(GLint positionAttribLoc, GLint colorAttribLoc,
   int h = detail+1;
 
   const int numVertices = (w * h);
-  const int numElements = (2 * w * h);
   const GLenum drawMode = GL_LINE_STRIP;
 
   std::vector<GLfloat> positions;
@@ -308,7 +360,6 @@ WireframeSphere::WireframeSphere(GLint positionAttribLoc, GLint colorAttribLoc,
 
   positions.reserve(numVertices * 3);
   colors.reserve(numVertices * 3);
-  indices.reserve(numElements);
 
   const GLfloat r = rgb[0];
   const GLfloat g = rgb[1];
@@ -339,43 +390,31 @@ WireframeSphere::WireframeSphere(GLint positionAttribLoc, GLint colorAttribLoc,
     }
   }
   
-  // Wireframe Element array - indices are written in a zig-zag pattern,
-  // first horizontally and then vertically. It uses GL_LINE_STRIP. 
-  int index = 0;
-  int x = 0, y = 0;
-  int dx = 1, dy = -1;
-
-  for (y = 0; y < h; y++)  // Horizontally.
-  {
-    x = ((dx == 1) ? 0 : w-1);
-    for (int k = 0; k < w; k++, x += dx)
-      indices.push_back(w*y + x);  // INDEX(x, y).
-    dx *= -1;
-  }
-
-  // Start from the last point to allow continuity in GL_LINE_STRIP.
-  x = ((dx == 1) ? 0 : w-1);
-  y = h-1;  
-  dy = -1;
-  for (int i = 0; i < w; i++, x += dx)  // Vertically.
-  {
-    y = ((dy == 1) ? 0 : h-1);
-    for (int j = 0; j < h; j++, y += dy)
-      indices.push_back(w*y + x);  // INDEX(x, y).
-    dy *= -1;
-  }
+  // Wireframe Element array (see GridWireframeIndices()).
+  indices = GridWireframeIndices(w, h, 1);
 
   // Allocate mesh.
-  mMeshGroup = new MeshGroup<Batch>(numVertices, numElements, drawMode);
+  mMeshGroup = new MeshGroup<Batch>(numVertices, indices.size(), drawMode);
 
   // Specify its attributes.
   mMeshGroup->SetVertexAttribList({3, 3});
+  mMeshGroup->EnablePrimitiveRestart();
 
   // Add rendering pass.
   mMeshGroup->AddRenderingPass({{positionAttribLoc, true}, {colorAttribLoc, true}});
 
   // Load data.
   mMeshGroup->Load({positions.data(), colors.data()}, indices.data());
+
+  // Levels of detail: coarser grids over the same vertices.
+  for (int step : kSphereLodSteps)
+  {
+    if (detail % step != 0 || detail / step < kSphereLodMinSegments)
+      break;
+
+    const GLfloat error = SphereTessellationError((2*M_PI * step) / detail);
+    mMeshGroup->AddLod(GridWireframeIndices(w, h, step), error);
+  }
 }
 
 WireframeSphere::~WireframeSphere() 
@@ -404,7 +443,6 @@ TexturedSphere::TexturedSphere(GLint positionAttribLoc, GLint normalAttribLoc, G
   int h = 65;
 
   const int numVertices = (w * h);
-  const int numElements = 2*(h-2)*w + 2*w + 2*(h-2);
   const GLenum drawMode = GL_TRIANGLE_STRIP;
 
   std::vector<GLfloat> positions;
@@ -416,8 +454,6 @@ TexturedSphere::TexturedSphere(GLint positionAttribLoc, GLint normalAttribLoc, G
   positions.reserve(numVertices * 3);
   normals.reserve(numVertices * 3);
   uvs.reserve(numVertices * 2);
-  tangents.reserve(numVertices * 3);
-  indices.reserve(numElements);
 
   // Initialize vertices.
   for (int v = 0; v < h; v++)
@@ -437,11 +473,8 @@ TexturedSphere::TexturedSphere(GLint positionAttribLoc, GLint normalAttribLoc, G
       positions.push_back(position[1]);
       positions.push_back(position[2]);
 
-      // TODO: generate better tangets.
       glm::vec3 n(2*position[0], 2*position[1], 2*position[2]);
       n = glm::normalize(n);
-      glm::vec3 t(-n[2], 0.0f, n[0]);
-      t = -glm::normalize(t);
 
       // Vertex normals.
       normals.push_back(n[0]);
@@ -451,37 +484,27 @@ TexturedSphere::TexturedSphere(GLint positionAttribLoc, GLint normalAttribLoc, G
       // Vertex uvs.
       uvs.push_back(1.0f - static_cast<float>(u)/(w-1));
       uvs.push_back(1.0f - static_cast<float>(v)/(h-1));
-
-      tangents.push_back(t[0]);
-      tangents.push_back(t[1]);
-      tangents.push_back(t[2]);
     }
   }
 
-  for (int v = 0; v < h-1; v++)
-  {
-    // Zig-zag pattern: alternate between top and bottom.
-    for (int u = 0; u < w; u++)
-    {
-      indices.push_back((v+0)*w + u);
-      indices.push_back((v+1)*w + u);
-    }
+  // Triangle strip element array (see GridStripIndices()).
+  indices = GridStripIndices(w, h, 1);
 
-    // Triangle row transition: handle discontinuity.
-    if (v < h-2)
-    {
-      // Repeat last vertex and the next row first vertex to generate 
-      // two invalid triangles and get continuity in the mesh.
-      indices.push_back((v+1)*w + (w-1)); //INDEX(this->width-1, y+1);
-      indices.push_back((v+1)*w + 0);     //INDEX(0, y+1);
-    }
-  }
+  // Tangents follow the uvs (see tangent_space.h).
+  tangents.resize(numVertices * 3);
+  ComputeTangents(positions.data(), normals.data(), uvs.data(), numVertices, indices.data(),
+                  indices.size(), drawMode, tangents.data());
 
   // Allocate mesh.
-  mMeshGroup = new MeshGroup<Batch>(numVertices, numElements, drawMode);
+  mMeshGroup = new MeshGroup<Batch>(numVertices, indices.size(), drawMode);
+  mMeshGroup->EnablePrimitiveRestart();
 
-  // Specify its attributes.
-  mMeshGroup->SetVertexAttribList({3, 3, 2, 3});
+  // Specify its attributes (packed: 20 bytes per vertex instead of 44).
+  // Positions lie on the unit sphere, uvs in [0, 1] and normals/tangents are unit vectors.
+  mMeshGroup->SetVertexAttribList({{3, kHalfFloat16},        // Position.
+                                   {3, kSnorm2_10_10_10},    // Normal.
+                                   {2, kUnorm16},            // UV.
+                                   {3, kSnorm2_10_10_10}});  // Tangent.
 
   // Add rendering pass.
   mMeshGroup->AddRenderingPass({{positionAttribLoc, true},
@@ -492,6 +515,16 @@ TexturedSphere::TexturedSphere(GLint positionAttribLoc, GLint normalAttribLoc, G
 
   // Load data.
   mMeshGroup->Load({positions.data(), normals.data(), uvs.data(), tangents.data()}, indices.data());
+
+  // Levels of detail: coarser grids over the same vertices.
+  for (int step : kSphereLodSteps)
+  {
+    if ((h-1) % step != 0 || (h-1) / step < kSphereLodMinSegments)
+      break;
+
+    const GLfloat error = SphereTessellationError((2*M_PI * step) / (w-1));
+    mMeshGroup->AddLod(GridStripIndices(w, h, step), error);
+  }
 }
 
 TexturedSphere::~TexturedSphere() 
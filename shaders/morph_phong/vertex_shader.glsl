@@ -0,0 +1,53 @@
+#version 330
+
+// Phong shading with sparse morph targets (gloo::MorphTargetSet).
+// Each vertex adds the weighted deltas of the targets that move it, read from buffer textures.
+
+layout (location = 0) in vec3 v_position;
+layout (location = 1) in vec3 v_normal;
+layout (location = 2) in vec2 v_uv;
+
+out vec4 f_position;  // Fragment position in camera coordinates.
+out vec4 f_normal;    // Fragment normal in camera coordinates.
+out vec2 f_uv;        // Fragment uv coordinates.
+
+uniform usamplerBuffer morph_ranges;   // (first entry, number of entries) per vertex.
+uniform samplerBuffer  morph_deltas;   // Entries: (position delta, target), (normal delta, 0).
+uniform samplerBuffer  morph_weights;  // Weight per target.
+
+uniform mat4 M;  // Model matrix.
+uniform mat4 V;  // View  matrix.
+uniform mat4 P;  // Projection matrix.
+uniform mat4 N;  // Normal matrix N = (VM)^-t.
+
+void main()
+{
+  // Streaming groups draw frame regions with a base vertex: wrap around the vertex count.
+  int vertex = gl_VertexID % textureSize(morph_ranges);
+  uvec2 range = texelFetch(morph_ranges, vertex).xy;
+
+  vec3 position = v_position;
+  vec3 normal   = v_normal;
+  for (int i = int(range.x); i < int(range.x + range.y); i++)
+  {
+    vec4 positionDelta = texelFetch(morph_deltas, 2*i);
+    vec3 normalDelta   = texelFetch(morph_deltas, 2*i + 1).xyz;
+    float weight = texelFetch(morph_weights, int(positionDelta.w)).x;
+
+    position += weight * positionDelta.xyz;
+    normal   += weight * normalDelta;
+  }
+
+  // Compute vertex position in world coordinates.
+  f_position = V * (M * vec4(position, 1.0f));
+  f_position = f_position/f_position.w;
+
+  // Then project f_position onto screen and store into gl_Position.
+  gl_Position = P * f_position;
+
+  // Transform the vertex normal vector.
+  f_normal = normalize(V * N * vec4(normal, 0.0));
+
+  // Pass uv coordinates to be interpolated.
+  f_uv = v_uv;
+}
@@ -0,0 +1,37 @@
+#version 330
+
+// Phong shading for instanced rendering (MeshGroup::RenderInstanced()).
+// Model/normal matrices and material index are per-instance attributes (gloo::InstanceData).
+
+layout (location = 0) in vec3 v_position;
+layout (location = 1) in vec3 v_normal;
+layout (location = 2) in vec2 v_uv;
+
+layout (location = 4)  in mat4 i_model;     // Model matrix (locations 4-7).
+layout (location = 8)  in mat3 i_normal;    // Normal matrix (M)^-t (locations 8-10).
+layout (location = 11) in uint i_material;  // Index in the material array.
+
+out vec4 f_position;  // Fragment position in camera coordinates.
+out vec4 f_normal;    // Fragment normal in camera coordinates.
+out vec2 f_uv;        // Fragment uv coordinates.
+flat out uint f_material;  // Index in the material array.
+
+uniform mat4 V;  // View  matrix.
+uniform mat4 P;  // Projection matrix.
+
+void main()
+{
+  // Compute vertex position in world coordinates.
+  f_position = V * (i_model * vec4(v_position, 1.0f));
+  f_position = f_position/f_position.w;
+
+  // Then project f_position onto screen and store into gl_Position.
+  gl_Position = P * f_position;
+
+  // Transform the vertex normal vector.
+  f_normal = normalize(V * vec4(i_normal * v_normal, 0.0));
+
+  // Pass uv coordinates to be interpolated.
+  f_uv = v_uv;
+  f_material = i_material;
+}
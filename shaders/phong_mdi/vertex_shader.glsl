@@ -0,0 +1,50 @@
+#version 430
+#extension GL_ARB_shader_draw_parameters : require
+
+// Phong shading for gloo::DrawBatch (multi-draw indirect).
+// Model/normal matrices and material come from shader storage buffers, indexed by draw.
+
+layout (location = 0) in vec3 v_position;
+layout (location = 1) in vec3 v_normal;
+layout (location = 2) in vec2 v_uv;
+
+out vec4 f_position;  // Fragment position in camera coordinates.
+out vec4 f_normal;    // Fragment normal in camera coordinates.
+out vec2 f_uv;        // Fragment uv coordinates.
+flat out uint f_material;  // Index in the material table.
+
+struct DrawData
+{
+  mat4 M;  // Model matrix.
+  mat4 N;  // Normal matrix N = (M)^-t.
+  uint material;
+};
+
+layout (std430, binding = 0) readonly buffer DrawDataBuffer
+{
+  DrawData draws[];
+};
+
+uniform mat4 V;  // View  matrix.
+uniform mat4 P;  // Projection matrix.
+
+uniform int draw_offset = 0;  // First draw of the current indirect call.
+
+void main()
+{
+  DrawData draw = draws[draw_offset + gl_DrawIDARB];
+
+  // Compute vertex position in world coordinates.
+  f_position = V * (draw.M * vec4(v_position, 1.0f));
+  f_position = f_position/f_position.w;
+
+  // Then project f_position onto screen and store into gl_Position.
+  gl_Position = P * f_position;
+
+  // Transform the vertex normal vector.
+  f_normal = normalize(V * draw.N * vec4(v_normal, 0.0));
+
+  // Pass uv coordinates to be interpolated.
+  f_uv = v_uv;
+  f_material = draw.material;
+}
@@ -0,0 +1,35 @@
+#version 330
+
+// Debug shader with linear blend skinning (gloo::BonePalette).
+
+layout (location = 0) in vec3 v_position;
+layout (location = 1) in vec3 v_color;
+
+layout (location = 4) in vec4 v_bones;    // Bone indices.
+layout (location = 5) in vec4 v_weights;  // Bone weights (sum = 1).
+
+out vec4 f_color;
+
+const int max_bones = 128;  // gloo::kMaxBones.
+
+layout (std140) uniform BonePalette
+{
+  mat4 bones[max_bones];  // Skinning matrices (pose * inverse bind pose).
+};
+
+uniform mat4 MVP;
+
+void main()
+{
+  // Blend the matrices of the bones that influence this vertex.
+  mat4 B = v_weights.x * bones[int(v_bones.x)]
+         + v_weights.y * bones[int(v_bones.y)]
+         + v_weights.z * bones[int(v_bones.z)]
+         + v_weights.w * bones[int(v_bones.w)];
+
+  // Transform and project the deformed vertex.
+  gl_Position = MVP * (B * vec4(v_position, 1.0f));
+
+  // Compute the vertex color (into f_color) to be interpolated.
+  f_color = vec4(v_color, 1.0);
+}
@@ -0,0 +1,53 @@
+#version 330
+
+// Phong shading with linear blend skinning (gloo::BonePalette).
+// Vertices are deformed by up to 4 bones, whose matrices are read from the BonePalette block.
+
+layout (location = 0) in vec3 v_position;
+layout (location = 1) in vec3 v_normal;
+layout (location = 2) in vec2 v_uv;
+
+layout (location = 4) in vec4 v_bones;    // Bone indices.
+layout (location = 5) in vec4 v_weights;  // Bone weights (sum = 1).
+
+out vec4 f_position;  // Fragment position in camera coordinates.
+out vec4 f_normal;    // Fragment normal in camera coordinates.
+out vec2 f_uv;        // Fragment uv coordinates.
+
+const int max_bones = 128;  // gloo::kMaxBones.
+
+layout (std140) uniform BonePalette
+{
+  mat4 bones[max_bones];  // Skinning matrices (pose * inverse bind pose).
+};
+
+uniform mat4 M;  // Model matrix.
+uniform mat4 V;  // View  matrix.
+uniform mat4 P;  // Projection matrix.
+uniform mat4 N;  // Normal matrix N = (VM)^-t.
+
+void main()
+{
+  // Blend the matrices of the bones that influence this vertex.
+  mat4 B = v_weights.x * bones[int(v_bones.x)]
+         + v_weights.y * bones[int(v_bones.y)]
+         + v_weights.z * bones[int(v_bones.z)]
+         + v_weights.w * bones[int(v_bones.w)];
+
+  // Deform the vertex (bones don't scale non-uniformly, so B also transforms normals).
+  vec4 position = B * vec4(v_position, 1.0f);
+  vec3 normal   = mat3(B) * v_normal;
+
+  // Compute vertex position in world coordinates.
+  f_position = V * (M * position);
+  f_position = f_position/f_position.w;
+
+  // Then project f_position onto screen and store into gl_Position.
+  gl_Position = P * f_position;
+
+  // Transform the vertex normal vector.
+  f_normal = normalize(V * N * vec4(normal, 0.0));
+
+  // Pass uv coordinates to be interpolated.
+  f_uv = v_uv;
+}